@@ -2087,6 +2087,8 @@ ActionMkTerm::untrace(const std::vector<std::string>& tokens)
 
   std::vector<Term> args;
   std::vector<uint32_t> indices;
+  MURXLA_CHECK_TRACE(Op::Kind::find(tokens[0]))
+      << "unknown operator kind '" << tokens[0] << "'";
   size_t n_tokens    = tokens.size();
   Op::Kind op_kind   = tokens[0];
   SortKind sort_kind = get_sort_kind_from_str(tokens[1]);
@@ -2168,11 +2170,14 @@ ActionMkTerm::run(Op::Kind kind,
                   const std::vector<uint32_t>& indices)
 {
   std::stringstream trace_str;
-  trace_str << " " << kind << " " << sort_kind;
-  trace_str << " " << args.size() << args;
-  if (indices.size())
+  if (d_smgr.is_tracing())
   {
-    trace_str << " " << indices.size() << indices;
+    trace_str << " " << kind << " " << sort_kind;
+    trace_str << " " << args.size() << args;
+    if (indices.size())
+    {
+      trace_str << " " << indices.size() << indices;
+    }
   }
   MURXLA_TRACE << get_kind() << trace_str.str();
   reset_sat();
@@ -2195,7 +2200,9 @@ ActionMkTerm::run(Op::Kind kind,
     }
   }
 
+  uint64_t start = statistics::get_time_ns();
   Term res = d_solver.mk_term(kind, args, indices);
+  record_latency(kind, start);
   // MURXLA_TEST(res->get_sort() == nullptr
   //             || d_solver.get_sort(res, sort_kind)->equals(res->get_sort()));
 
@@ -2235,17 +2242,22 @@ ActionMkTerm::run(Op::Kind kind,
                   const std::vector<Term>& args)
 {
   std::stringstream trace_str;
-  trace_str << " " << kind << " " << sort_kind;
-  trace_str << " " << str_args.size();
-  for (const auto& s : str_args)
+  if (d_smgr.is_tracing())
   {
-    trace_str << " \"" << s << "\" ";
+    trace_str << " " << kind << " " << sort_kind;
+    trace_str << " " << str_args.size();
+    for (const auto& s : str_args)
+    {
+      trace_str << " \"" << s << "\" ";
+    }
+    trace_str << " " << args.size() << args;
   }
-  trace_str << " " << args.size() << args;
   MURXLA_TRACE << get_kind() << trace_str.str();
   reset_sat();
 
+  uint64_t start = statistics::get_time_ns();
   Term res = d_solver.mk_term(kind, str_args, args);
+  record_latency(kind, start);
   d_smgr.add_term(res, sort_kind, args);
   Sort res_sort = res->get_sort();
 
@@ -2262,13 +2274,16 @@ ActionMkTerm::run(Op::Kind kind,
                   std::vector<Term>& args)
 {
   std::stringstream trace_str;
-  trace_str << " " << kind << " " << sort_kind << " " << sort;
-  trace_str << " " << str_args.size();
-  for (const auto& s : str_args)
+  if (d_smgr.is_tracing())
   {
-    trace_str << " \"" << s << "\" ";
+    trace_str << " " << kind << " " << sort_kind << " " << sort;
+    trace_str << " " << str_args.size();
+    for (const auto& s : str_args)
+    {
+      trace_str << " \"" << s << "\" ";
+    }
+    trace_str << " " << args.size() << args;
   }
-  trace_str << " " << args.size() << args;
   MURXLA_TRACE << get_kind() << trace_str.str();
   reset_sat();
 
@@ -2282,7 +2297,9 @@ ActionMkTerm::run(Op::Kind kind,
     }
   }
 
+  uint64_t start = statistics::get_time_ns();
   Term res = d_solver.mk_term(kind, sort, str_args, args);
+  record_latency(kind, start);
   /* We do not add match case terms since they are specifically created for
    * creating a match term and should not be used in any other terms. */
   d_smgr.add_term(res, sort_kind, args);
@@ -2293,6 +2310,17 @@ ActionMkTerm::run(Op::Kind kind,
   return {res->get_id(), res_sort->get_id()};
 }
 
+void
+ActionMkTerm::record_latency(Op::Kind kind, uint64_t start)
+{
+  uint64_t ns  = statistics::get_time_ns() - start;
+  const Op& op = d_smgr.get_op(kind);
+  if (op.d_kind != Op::UNDEFINED)
+  {
+    d_smgr.d_mbt_stats->add_op_latency(op.d_id, ns);
+  }
+}
+
 void
 ActionMkTerm::check_term(Term term)
 {
@@ -15,6 +15,7 @@
 #include <string>
 #include <vector>
 
+#include "interned_kind.hpp"
 #include "solver/solver.hpp"
 
 /* -------------------------------------------------------------------------- */
@@ -27,13 +28,17 @@
  * ```
  * MURXLA_TRACE << <action>.get_kind() << " " << <args...>;
  * ```
+ * If tracing is disabled, the trace line contents are not evaluated, they
+ * must therefore not have side effects.
  */
 //! @internal [docs-murxla_trace start]
-#define MURXLA_TRACE                                                 \
-  d_solver.get_rng().reseed(d_sng.seed()),                           \
-      OstreamVoider()                                                \
-          & Action::TraceStream(d_smgr).stream()                     \
-                << std::setw(5) << d_sng.seed() << " "
+#define MURXLA_TRACE                                              \
+  d_solver.get_rng().reseed(d_sng.seed()),                        \
+      !d_smgr.is_tracing()                                        \
+          ? (void) 0                                              \
+          : OstreamVoider()                                       \
+                & Action::TraceStream(d_smgr).stream()            \
+                      << std::setw(5) << d_sng.seed() << " "
 //! @internal [docs-murxla_trace end]
 
 
@@ -63,10 +68,12 @@
  *      MURXLA_TRACE_RETURN << <created term> << " " << <sort of created term>;
  * \endverbatim
  */
-#define MURXLA_TRACE_RETURN                                         \
-  OstreamVoider()                                                   \
-      & Action::TraceStream(d_smgr).stream() << std::setw(6) << " " \
-                                             << "return "
+#define MURXLA_TRACE_RETURN                                               \
+  !d_smgr.is_tracing()                                                    \
+      ? (void) 0                                                          \
+      : OstreamVoider()                                                   \
+            & Action::TraceStream(d_smgr).stream() << std::setw(6) << " " \
+                                                   << "return "
 
 /* -------------------------------------------------------------------------- */
 
@@ -97,10 +104,11 @@ class Action
    * The kind of an action.
    *
    * This is used as action identifier when tracing.
-   * We further use strings here to make FSM::d_actions easily extensible
-   * with solver-specific actions.
+   * Kinds are identified by strings to make FSM::d_actions easily extensible
+   * with solver-specific actions, which are interned into integer ids (see
+   * InternedKind) to index FSM::d_actions.
    */
-  using Kind = std::string;
+  using Kind = InternedKind<Action>;
 
   /** The undefined action. */
   inline static const Kind UNDEFINED = "undefined";
@@ -293,7 +301,7 @@ class Action
 
  private:
   /* The kind of this action. */
-  const Kind& d_kind = UNDEFINED;
+  Kind d_kind = UNDEFINED;
   /* The id of this action, assigned in the order they have been created. */
   uint64_t d_id = 0u;
 };
@@ -590,6 +598,14 @@ class ActionMkTerm : public Action
   bool generate(SortKind sort_kind);
 
  private:
+  /**
+   * Record the latency of creating a term of given operator kind.
+   * @param kind   The operator kind.
+   * @param start  The time the solver was asked to create the term at, in
+   *               nanoseconds (see statistics::get_time_ns()).
+   */
+  void record_latency(Op::Kind kind, uint64_t start);
+
   std::vector<uint64_t> run(Op::Kind kind,
                             SortKind sort_kind,
                             std::vector<Term>& args,
@@ -0,0 +1,230 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#include "adaptive_weights.hpp"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "coverage.hpp"
+#include "except.hpp"
+#include "statistics.hpp"
+#include "util.hpp"
+
+namespace murxla {
+namespace adaptive {
+
+namespace {
+
+/**
+ * The number of tries that the per arm success rates are smoothed with,
+ * i.e., the success rate of arms that were tried only a few times is close to
+ * the average success rate.
+ */
+constexpr double PRIOR_TRIES = 2;
+
+/** The scale of the UCB1 exploration bonus relative to the reward. */
+constexpr double EXPLORATION = 0.5;
+
+/**
+ * Compute the weight factors of the arms of a bandit.
+ * @param kinds        The kinds of the arms, terminated by an empty kind if
+ *                     less than 'size'.
+ * @param tries        The number of tries of each arm.
+ * @param successes    The number of successful tries of each arm.
+ * @param size         The maximum number of arms.
+ * @param get_novelty  The function to get the novelty factor of an arm.
+ * @param res_kinds    The kinds of the arms with computed weight factors.
+ * @param res          The computed weight factors in percent.
+ */
+void
+compute_factors(const char kinds[][MURXLA_MAX_KIND_LEN],
+                const uint64_t* tries,
+                const uint64_t* successes,
+                size_t size,
+                const std::function<double(size_t)>& get_novelty,
+                char res_kinds[][MURXLA_MAX_KIND_LEN],
+                uint32_t* res)
+{
+  size_t n = 0;
+  uint64_t total_tries = 0, total_successes = 0;
+  for (; n < size && kinds[n][0]; ++n)
+  {
+    total_tries += tries[n];
+    total_successes += successes[n];
+  }
+  memcpy(res_kinds, kinds, n * MURXLA_MAX_KIND_LEN);
+  memset(res_kinds + n, 0, (size - n) * MURXLA_MAX_KIND_LEN);
+  std::fill(res, res + size, 100);
+  if (total_tries == 0) return;
+
+  double rate = static_cast<double>(total_successes)
+                / static_cast<double>(total_tries);
+  double log_tries = std::log(static_cast<double>(total_tries));
+
+  std::vector<double> scores(n, 0);
+  double sum        = 0;
+  size_t num_scored = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (tries[i] == 0) continue;
+    double t       = static_cast<double>(tries[i]);
+    double success = (static_cast<double>(successes[i]) + rate * PRIOR_TRIES)
+                     / (t + PRIOR_TRIES);
+    scores[i] =
+        success * get_novelty(i) + EXPLORATION * std::sqrt(log_tries / t);
+    sum += scores[i];
+    num_scored += 1;
+  }
+  double mean = sum / static_cast<double>(num_scored);
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    double factor = MURXLA_MAX_WEIGHT_FACTOR;
+    if (tries[i] > 0)
+    {
+      factor = mean > 0 ? std::clamp(scores[i] / mean,
+                                     MURXLA_MIN_WEIGHT_FACTOR,
+                                     MURXLA_MAX_WEIGHT_FACTOR)
+                        : 1;
+    }
+    res[i] = static_cast<uint32_t>(std::lround(factor * 100));
+  }
+}
+
+/**
+ * Add the weight factors of given table that are not 100% to given map.
+ * @param kinds    The kinds of the entries, terminated by an empty kind if
+ *                 less than 'size'.
+ * @param factors  The weight factors of the entries.
+ * @param size     The maximum number of entries.
+ * @param res      The map to add the weight factors to.
+ */
+void
+add_factors(const char kinds[][MURXLA_MAX_KIND_LEN],
+            const uint32_t* factors,
+            size_t size,
+            WeightMap& res)
+{
+  for (size_t i = 0; i < size && kinds[i][0]; ++i)
+  {
+    if (factors[i] == 100) continue;
+    res.emplace(std::string(kinds[i], strnlen(kinds[i], MURXLA_MAX_KIND_LEN)),
+                factors[i]);
+  }
+}
+
+}  // namespace
+
+/* -------------------------------------------------------------------------- */
+
+bool
+parse_weights(const std::string& str, WeightMap& weights)
+{
+  for (const auto& entry : split(str, ','))
+  {
+    if (entry.empty()) continue;
+    auto kv = split(entry, '=');
+    if (kv.size() != 2 || kv[0].empty() || !is_numeric(kv[1])) return false;
+    uint32_t factor = static_cast<uint32_t>(std::stoul(kv[1]));
+    if (factor == 0) return false;
+    weights[kv[0]] = factor;
+  }
+  return true;
+}
+
+std::string
+to_string(const WeightMap& weights)
+{
+  std::map<std::string, uint32_t> sorted(weights.begin(), weights.end());
+  std::stringstream ss;
+  for (const auto& [kind, factor] : sorted)
+  {
+    if (ss.tellp() > 0) ss << ",";
+    ss << kind << "=" << factor;
+  }
+  return ss.str();
+}
+
+/* -------------------------------------------------------------------------- */
+
+Weights*
+Weights::create()
+{
+  Weights* res = static_cast<Weights*>(mmap(0,
+                                            sizeof(Weights),
+                                            PROT_READ | PROT_WRITE,
+                                            MAP_ANONYMOUS | MAP_SHARED,
+                                            -1,
+                                            0));
+  MURXLA_EXIT_ERROR(res == MAP_FAILED)
+      << "failed to map shared memory for adaptive weights";
+  memset(static_cast<void*>(res), 0, sizeof(Weights));
+  return res;
+}
+
+void
+Weights::update(const statistics::Statistics& stats,
+                const coverage::Feedback* feedback)
+{
+  d_version.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  compute_factors(
+      stats.d_action_kinds,
+      stats.d_actions,
+      stats.d_actions_ok,
+      MURXLA_MAX_N_ACTIONS,
+      [feedback](size_t i) {
+        return feedback ? feedback->get_action_factor(i) : 1;
+      },
+      d_action_kinds,
+      d_actions);
+  compute_factors(
+      stats.d_op_kinds,
+      stats.d_ops,
+      stats.d_ops_ok,
+      MURXLA_MAX_N_OPS,
+      [feedback](size_t i) {
+        return feedback ? feedback->get_op_factor(i) : 1;
+      },
+      d_op_kinds,
+      d_ops);
+
+  d_version.fetch_add(1, std::memory_order_release);
+}
+
+void
+Weights::get(WeightMap& actions, WeightMap& ops) const
+{
+  uint64_t version;
+  do
+  {
+    actions.clear();
+    ops.clear();
+    version = d_version.load(std::memory_order_acquire);
+    if (version & 1) continue;
+    add_factors(d_action_kinds, d_actions, MURXLA_MAX_N_ACTIONS, actions);
+    add_factors(d_op_kinds, d_ops, MURXLA_MAX_N_OPS, ops);
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((version & 1)
+           || d_version.load(std::memory_order_relaxed) != version);
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace adaptive
+}  // namespace murxla
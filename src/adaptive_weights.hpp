@@ -0,0 +1,110 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__ADAPTIVE_WEIGHTS_H
+#define __MURXLA__ADAPTIVE_WEIGHTS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "config.hpp"
+
+namespace murxla {
+
+namespace coverage {
+struct Feedback;
+}
+namespace statistics {
+struct Statistics;
+}
+
+namespace adaptive {
+
+/** Map action or operator kind to the factor (in percent) for its weight. */
+using WeightMap = std::unordered_map<std::string, uint32_t>;
+
+/**
+ * Parse weight factors given as a comma-separated list of entries
+ * '<kind>=<percent>'.
+ * @param str      The string to parse.
+ * @param weights  The map to add the parsed weight factors to.
+ * @return  False if the string is malformed.
+ */
+bool parse_weights(const std::string& str, WeightMap& weights);
+
+/**
+ * Get the string representation of given weight factors in the format of
+ * parse_weights(). Entries are sorted by kind.
+ * @param weights  The weight factors.
+ * @return  The string representation.
+ */
+std::string to_string(const WeightMap& weights);
+
+/**
+ * Adaptive weights of actions and operators.
+ *
+ * In continuous mode, the parent process periodically recomputes the weights
+ * from the statistics of all previous test runs, and test run processes pick
+ * up the current weights when they start a test run. The weights are
+ * recorded in the set-murxla-options line of the trace of a test run, which
+ * thus can be reproduced with its seed.
+ *
+ * Each action and each operator is considered an arm of a multi-armed bandit.
+ * The reward of an arm is its success rate, i.e., the rate of calls to an
+ * action that succeeded and of operator picks that resulted in a term, scaled
+ * with its novelty rate if coverage feedback is available (see
+ * coverage::Feedback). Arms are weighted with their UCB1 score (reward plus
+ * exploration bonus) relative to the average score, arms that were never
+ * tried get the maximum weight.
+ *
+ * The weights object is located in shared memory. We thus only use base
+ * types here. Entries correspond to the entries of the statistics object
+ * they were computed from, weight factors are given in percent.
+ */
+struct Weights
+{
+  /**
+   * Create a weights object in shared memory.
+   * @return  The weights object.
+   */
+  static Weights* create();
+
+  /**
+   * Recompute the weights. Must only be called by the parent process.
+   * @param stats     The statistics of all previous test runs.
+   * @param feedback  The coverage feedback of all previous test runs, nullptr
+   *                  if not available.
+   */
+  void update(const statistics::Statistics& stats,
+              const coverage::Feedback* feedback);
+
+  /**
+   * Get the current weight factors that are not 100%.
+   * @param actions  The map to store the weight factors of actions into.
+   * @param ops      The map to store the weight factors of operators into.
+   */
+  void get(WeightMap& actions, WeightMap& ops) const;
+
+  /**
+   * Incremented before and after each update, i.e., odd while an update is in
+   * progress. Readers retry if this changed while reading.
+   */
+  std::atomic<uint64_t> d_version;
+  char d_action_kinds[MURXLA_MAX_N_ACTIONS][MURXLA_MAX_KIND_LEN];
+  uint32_t d_actions[MURXLA_MAX_N_ACTIONS];
+  char d_op_kinds[MURXLA_MAX_N_OPS][MURXLA_MAX_KIND_LEN];
+  uint32_t d_ops[MURXLA_MAX_N_OPS];
+};
+
+}  // namespace adaptive
+}  // namespace murxla
+
+#endif
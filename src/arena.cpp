@@ -0,0 +1,124 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#include "arena.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+
+namespace murxla {
+
+namespace {
+
+/** The alignment of allocations. */
+constexpr size_t ALIGN = alignof(std::max_align_t);
+
+/** Round given size up to the alignment of allocations. */
+constexpr size_t
+align(size_t size)
+{
+  return (size + ALIGN - 1) & ~(ALIGN - 1);
+}
+
+/** The header of a chunk. */
+struct Chunk
+{
+  /**
+   * The number of live allocations from this chunk, plus one while this
+   * chunk is the current chunk of its thread.
+   */
+  std::atomic<size_t> d_refs{1};
+};
+
+/** The offset of the first allocation in a chunk. */
+constexpr size_t CHUNK_HEADER_SIZE = align(sizeof(Chunk));
+
+/** Release a reference to given chunk, frees the chunk if it was the last. */
+void
+release(Chunk* chunk)
+{
+  if (chunk->d_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    chunk->~Chunk();
+    std::free(chunk);
+  }
+}
+
+/** The current chunk of a thread. */
+struct ThreadChunk
+{
+  ~ThreadChunk()
+  {
+    if (d_chunk) release(d_chunk);
+  }
+
+  /** The current chunk, nullptr if none has been allocated yet. */
+  Chunk* d_chunk = nullptr;
+  /** The offset of the next allocation in the current chunk. */
+  size_t d_offset = Arena::CHUNK_SIZE;
+};
+
+thread_local ThreadChunk s_thread_chunk;
+
+}  // namespace
+
+/* -------------------------------------------------------------------------- */
+
+void*
+Arena::allocate(size_t size)
+{
+  size = align(size);
+  if (size > MAX_SIZE)
+  {
+    return ::operator new(size);
+  }
+
+  ThreadChunk& tc = s_thread_chunk;
+  /* Reuse the current chunk if all of its objects have been deallocated. */
+  if (tc.d_chunk && tc.d_chunk->d_refs.load(std::memory_order_acquire) == 1)
+  {
+    tc.d_offset = CHUNK_HEADER_SIZE;
+  }
+  if (tc.d_offset + size > CHUNK_SIZE)
+  {
+    if (tc.d_chunk) release(tc.d_chunk);
+    void* mem = std::aligned_alloc(CHUNK_SIZE, CHUNK_SIZE);
+    if (mem == nullptr)
+    {
+      tc.d_chunk = nullptr;
+      throw std::bad_alloc();
+    }
+    tc.d_chunk  = new (mem) Chunk();
+    tc.d_offset = CHUNK_HEADER_SIZE;
+  }
+
+  void* res = reinterpret_cast<char*>(tc.d_chunk) + tc.d_offset;
+  tc.d_offset += size;
+  tc.d_chunk->d_refs.fetch_add(1, std::memory_order_relaxed);
+  return res;
+}
+
+void
+Arena::deallocate(void* ptr, size_t size)
+{
+  size = align(size);
+  if (size > MAX_SIZE)
+  {
+    ::operator delete(ptr);
+    return;
+  }
+  uintptr_t addr = reinterpret_cast<uintptr_t>(ptr) & ~(CHUNK_SIZE - 1);
+  release(reinterpret_cast<Chunk*>(addr));
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
@@ -0,0 +1,145 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__ARENA_H
+#define __MURXLA__ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Chunk-based bump allocator for the sort and term wrappers of the solvers.
+ *
+ * Each thread allocates from its current chunk of CHUNK_SIZE bytes front to
+ * back. A chunk counts the objects that are allocated from it and is released
+ * as a whole when all of them have been deallocated and it is not the current
+ * chunk of its thread anymore. The current chunk of a thread is reused from
+ * the start if all of its objects have been deallocated. Since the sorts and
+ * terms of a test run are released together when the solver manager is
+ * cleared, this replaces one heap allocation per wrapper (and one per
+ * reference count block) with one per chunk.
+ *
+ * Allocations larger than MAX_SIZE are served by operator new.
+ */
+class Arena
+{
+ public:
+  /** The size of a chunk, chunks are aligned to their size. */
+  static constexpr size_t CHUNK_SIZE = 1 << 16;
+  /** The maximum size of an allocation from a chunk. */
+  static constexpr size_t MAX_SIZE = CHUNK_SIZE / 16;
+
+  /**
+   * Allocate memory for an object.
+   * @param size  The size of the object.
+   * @return  The allocated memory, aligned to alignof(std::max_align_t).
+   */
+  static void* allocate(size_t size);
+
+  /**
+   * Deallocate memory allocated via allocate().
+   * @param ptr   The allocated memory.
+   * @param size  The size that was given to allocate().
+   */
+  static void deallocate(void* ptr, size_t size);
+};
+
+/** Standard allocator interface to Arena. */
+template <class T>
+struct ArenaAllocator
+{
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "over-aligned types are not supported");
+
+  using value_type = T;
+
+  ArenaAllocator() = default;
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U>&)
+  {
+  }
+
+  T* allocate(size_t n)
+  {
+    return static_cast<T*>(Arena::allocate(n * sizeof(T)));
+  }
+  void deallocate(T* ptr, size_t n) { Arena::deallocate(ptr, n * sizeof(T)); }
+
+  template <class U>
+  bool operator==(const ArenaAllocator<U>&) const
+  {
+    return true;
+  }
+  template <class U>
+  bool operator!=(const ArenaAllocator<U>&) const
+  {
+    return false;
+  }
+};
+
+/**
+ * Create a shared object in the arena. The object and its reference count
+ * block are allocated together.
+ * @param args  The arguments to the constructor of the object.
+ * @return  The shared object.
+ */
+template <class T, class... Args>
+std::shared_ptr<T>
+make_arena_shared(Args&&... args)
+{
+  return std::allocate_shared<T>(ArenaAllocator<T>(),
+                                 std::forward<Args>(args)...);
+}
+
+/**
+ * Create an object in the arena, to be destroyed via arena_delete().
+ * @param args  The arguments to the constructor of the object.
+ * @return  The object.
+ */
+template <class T, class... Args>
+T*
+arena_new(Args&&... args)
+{
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "over-aligned types are not supported");
+  void* mem = Arena::allocate(sizeof(T));
+  try
+  {
+    return new (mem) T(std::forward<Args>(args)...);
+  }
+  catch (...)
+  {
+    Arena::deallocate(mem, sizeof(T));
+    throw;
+  }
+}
+
+/**
+ * Destroy an object created via arena_new().
+ * @param ptr  The object.
+ */
+template <class T>
+void
+arena_delete(T* ptr)
+{
+  ptr->~T();
+  Arena::deallocate(ptr, sizeof(T));
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
+
+#endif
@@ -0,0 +1,488 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#include "binary_trace.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <fstream>
+
+#include "except.hpp"
+#include "util.hpp"
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** The maximum number of digits of numbers that are encoded as varints. */
+constexpr size_t MAX_UINT_DIGITS = 18;
+
+/**
+ * Determine if given string is an unsigned integer without leading zeros
+ * that can be encoded as varint piece.
+ * @param s      The string to check.
+ * @param value  The resulting value.
+ * @return  True if the string is an encodable unsigned integer.
+ */
+bool
+parse_uint(std::string_view s, uint64_t& value)
+{
+  if (s.empty() || s.size() > MAX_UINT_DIGITS) return false;
+  if (s.size() > 1 && s[0] == '0') return false;
+  value = 0;
+  for (char c : s)
+  {
+    if (c < '0' || c > '9') return false;
+    value = value * 10 + static_cast<uint64_t>(c - '0');
+  }
+  return true;
+}
+
+/** Text trace reader, see tokenize() in util.hpp. */
+class TextTraceReader : public TraceReader
+{
+ public:
+  TextTraceReader(std::ifstream&& trace) : d_trace(std::move(trace)) {}
+
+  bool next(TraceLine& line) override
+  {
+    bool newline;
+    if (!next_text(d_line, newline)) return false;
+    line.d_ignore = d_line.empty() || d_line[0] == '#'
+                    || d_line.rfind("set-murxla-options", 0) == 0;
+    if (line.d_ignore)
+    {
+      /* Not tokenized, tokenize() expects a seed or an action. */
+      line.d_seed = 0;
+      line.d_id.clear();
+      line.d_id_index = -1;
+      line.d_tokens.clear();
+      return true;
+    }
+    auto [seed, id, tokens] = tokenize(d_line);
+    line.d_seed             = seed;
+    line.d_id               = std::move(id);
+    line.d_id_index         = -1;
+    line.d_tokens           = std::move(tokens);
+    return true;
+  }
+
+  bool next_text(std::string& line, bool& newline) override
+  {
+    if (!std::getline(d_trace, line)) return false;
+    d_line_number += 1;
+    newline = !d_trace.eof();
+    return true;
+  }
+
+ private:
+  /** The trace file. */
+  std::ifstream d_trace;
+  /** The line that was read last. */
+  std::string d_line;
+};
+
+/** Binary trace reader that maps the trace file into memory. */
+class BinaryTraceReader : public TraceReader
+{
+ public:
+  BinaryTraceReader(const std::string& file_name);
+  ~BinaryTraceReader() override;
+
+  bool next(TraceLine& line) override;
+  bool next_text(std::string& line, bool& newline) override;
+
+ private:
+  /** A decoded piece of a line. */
+  struct Piece
+  {
+    BinaryTrace::Tag d_tag;
+    /** The value of UINT, TERM and SORT pieces, the string index else. */
+    uint64_t d_value;
+  };
+
+  /** Decode the next record into d_pieces. */
+  bool read_record(bool& newline);
+  /** Decode next varint. */
+  uint64_t read_varint();
+  /** Append the text of given piece to given string. */
+  void append_text(const Piece& piece, std::string& s) const;
+  /** Throw exception for corrupted traces. */
+  [[noreturn]] void corrupted() const;
+
+  /** The name of the trace file. */
+  std::string d_file_name;
+  /** The mapped trace file. */
+  const char* d_data = nullptr;
+  /** The size of the trace file. */
+  size_t d_size = 0;
+  /** The current read position. */
+  size_t d_pos = 0;
+  /** The string table, views into the mapped trace file. */
+  std::vector<std::string_view> d_strings;
+  /** The pieces of the record that was read last. */
+  std::vector<Piece> d_pieces;
+};
+
+BinaryTraceReader::BinaryTraceReader(const std::string& file_name)
+    : d_file_name(file_name)
+{
+  int32_t fd = ::open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+  MURXLA_CHECK_CONFIG(fd >= 0)
+      << "untrace: unable to open file '" << file_name << "'";
+  struct stat st;
+  MURXLA_EXIT_ERROR(fstat(fd, &st) < 0)
+      << "unable to query trace file '" << file_name << "'";
+  d_size = static_cast<size_t>(st.st_size);
+  if (d_size > 0)
+  {
+    void* data = mmap(nullptr, d_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    MURXLA_EXIT_ERROR(data == MAP_FAILED)
+        << "unable to map trace file '" << file_name << "'";
+    d_data = static_cast<const char*>(data);
+  }
+  close(fd);
+
+  const std::string& magic = BinaryTrace::MAGIC;
+  if (d_size < magic.size()
+      || magic.compare(0, magic.size(), d_data, magic.size()) != 0)
+  {
+    corrupted();
+  }
+  d_pos = magic.size();
+}
+
+BinaryTraceReader::~BinaryTraceReader()
+{
+  if (d_data)
+  {
+    munmap(const_cast<char*>(d_data), d_size);
+  }
+}
+
+bool
+BinaryTraceReader::next(TraceLine& line)
+{
+  bool newline;
+  if (!read_record(newline)) return false;
+
+  /* Mirror the behavior of tokenize() on the text of the line. */
+  bool has_seed  = false;
+  bool has_id    = false;
+  bool open_str  = false;
+  size_t ntokens = 0;
+  std::string text;
+
+  line.d_seed     = 0;
+  line.d_id_index = -1;
+  line.d_ignore =
+      d_pieces.size() == 1 && d_pieces[0].d_tag == BinaryTrace::EMPTY;
+  line.d_id.clear();
+
+  for (size_t i = 0, n = d_pieces.size(); i < n; ++i)
+  {
+    const Piece& piece = d_pieces[i];
+    if (piece.d_tag == BinaryTrace::EMPTY) continue;
+
+    if (!has_seed)
+    {
+      has_seed = true;
+      if (piece.d_tag == BinaryTrace::UINT)
+      {
+        line.d_seed = static_cast<uint32_t>(piece.d_value);
+        continue;
+      }
+      text.clear();
+      append_text(piece, text);
+      if (i == 0)
+      {
+        line.d_ignore =
+            text[0] == '#' || text.rfind("set-murxla-options", 0) == 0;
+      }
+      if (text[0] >= '0' && text[0] <= '9')
+      {
+        line.d_seed = static_cast<uint32_t>(std::stoul(text));
+        continue;
+      }
+    }
+
+    if (!has_id)
+    {
+      has_id = true;
+      append_text(piece, line.d_id);
+      if (piece.d_tag == BinaryTrace::STR)
+      {
+        line.d_id_index = static_cast<int64_t>(piece.d_value);
+      }
+      continue;
+    }
+
+    if (!open_str)
+    {
+      if (ntokens == line.d_tokens.size()) line.d_tokens.emplace_back();
+      line.d_tokens[ntokens].clear();
+      ntokens += 1;
+    }
+    std::string& token = line.d_tokens[ntokens - 1];
+    if (open_str) token.push_back(' ');
+    size_t start = token.size();
+    append_text(piece, token);
+
+    if (open_str)
+    {
+      open_str = token.back() != '"';
+    }
+    else
+    {
+      open_str = token[start] == '"' && token.back() != '"';
+    }
+  }
+  /* Unterminated strings are dropped, see tokenize(). */
+  if (open_str) ntokens -= 1;
+  line.d_tokens.resize(ntokens);
+  return true;
+}
+
+bool
+BinaryTraceReader::next_text(std::string& line, bool& newline)
+{
+  if (!read_record(newline)) return false;
+  line.clear();
+  for (size_t i = 0, n = d_pieces.size(); i < n; ++i)
+  {
+    if (i > 0) line.push_back(' ');
+    append_text(d_pieces[i], line);
+  }
+  return true;
+}
+
+bool
+BinaryTraceReader::read_record(bool& newline)
+{
+  if (d_pos >= d_size) return false;
+  d_line_number += 1;
+
+  uint64_t header = read_varint();
+  size_t npieces  = header >> 1;
+  newline         = header & 1;
+  if (npieces == 0) corrupted();
+
+  d_pieces.clear();
+  for (size_t i = 0; i < npieces; ++i)
+  {
+    uint64_t value = read_varint();
+    auto tag       = static_cast<BinaryTrace::Tag>(value & 7);
+    value >>= 3;
+    switch (tag)
+    {
+      case BinaryTrace::EMPTY:
+      case BinaryTrace::UINT:
+      case BinaryTrace::TERM:
+      case BinaryTrace::SORT: break;
+      case BinaryTrace::STR:
+        if (value >= d_strings.size()) corrupted();
+        break;
+      case BinaryTrace::STR_NEW:
+        if (value > d_size - d_pos) corrupted();
+        d_strings.emplace_back(d_data + d_pos, value);
+        d_pos += value;
+        value = d_strings.size() - 1;
+        tag   = BinaryTrace::STR;
+        break;
+      default: corrupted();
+    }
+    d_pieces.push_back({tag, value});
+  }
+  return true;
+}
+
+uint64_t
+BinaryTraceReader::read_varint()
+{
+  uint64_t res = 0;
+  for (uint32_t shift = 0; shift < 64; shift += 7)
+  {
+    if (d_pos >= d_size) break;
+    uint8_t byte = static_cast<uint8_t>(d_data[d_pos++]);
+    res |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return res;
+  }
+  corrupted();
+}
+
+void
+BinaryTraceReader::append_text(const Piece& piece, std::string& s) const
+{
+  switch (piece.d_tag)
+  {
+    case BinaryTrace::EMPTY: break;
+    case BinaryTrace::UINT: s.append(std::to_string(piece.d_value)); break;
+    case BinaryTrace::TERM:
+      s.push_back('t');
+      s.append(std::to_string(piece.d_value));
+      break;
+    case BinaryTrace::SORT:
+      s.push_back('s');
+      s.append(std::to_string(piece.d_value));
+      break;
+    default:
+      assert(piece.d_tag == BinaryTrace::STR);
+      s.append(d_strings[piece.d_value]);
+  }
+}
+
+void
+BinaryTraceReader::corrupted() const
+{
+  throw MurxlaUntraceException(
+      d_file_name, d_line_number, "corrupted binary trace");
+}
+
+}  // namespace
+
+/* -------------------------------------------------------------------------- */
+
+bool
+BinaryTrace::is_binary_trace(const std::string& file_name)
+{
+  std::ifstream file(file_name, std::ios::binary);
+  std::string header(MAGIC.size(), '\0');
+  return file.read(header.data(), header.size()) && header == MAGIC;
+}
+
+/* -------------------------------------------------------------------------- */
+
+BinaryTraceWriter::BinaryTraceWriter(std::ostream& out) : d_out(out)
+{
+  d_out.write(BinaryTrace::MAGIC.data(), BinaryTrace::MAGIC.size());
+}
+
+void
+BinaryTraceWriter::write_line(std::string_view line, bool newline)
+{
+  size_t npieces = 1;
+  for (char c : line)
+  {
+    if (c == ' ') npieces += 1;
+  }
+  write_varint(npieces << 1 | (newline ? 1 : 0));
+
+  size_t start = 0;
+  for (size_t end; (end = line.find(' ', start)) != std::string_view::npos;
+       start = end + 1)
+  {
+    write_piece(line.substr(start, end - start));
+  }
+  write_piece(line.substr(start));
+}
+
+void
+BinaryTraceWriter::write_varint(uint64_t value)
+{
+  char buf[10];
+  size_t size = 0;
+  do
+  {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    buf[size++] = static_cast<char>(value ? byte | 0x80 : byte);
+  } while (value);
+  d_out.write(buf, size);
+}
+
+void
+BinaryTraceWriter::write_piece(std::string_view piece)
+{
+  uint64_t value;
+  if (piece.empty())
+  {
+    write_varint(BinaryTrace::EMPTY);
+  }
+  else if (parse_uint(piece, value))
+  {
+    write_varint(value << 3 | BinaryTrace::UINT);
+  }
+  else if (piece[0] == 't' && parse_uint(piece.substr(1), value))
+  {
+    write_varint(value << 3 | BinaryTrace::TERM);
+  }
+  else if (piece[0] == 's' && parse_uint(piece.substr(1), value))
+  {
+    write_varint(value << 3 | BinaryTrace::SORT);
+  }
+  else
+  {
+    auto [it, inserted] = d_strings.emplace(piece, d_strings.size());
+    if (inserted)
+    {
+      write_varint(piece.size() << 3 | BinaryTrace::STR_NEW);
+      d_out.write(piece.data(), piece.size());
+    }
+    else
+    {
+      write_varint(it->second << 3 | BinaryTrace::STR);
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::unique_ptr<TraceReader>
+TraceReader::open(const std::string& file_name)
+{
+  if (BinaryTrace::is_binary_trace(file_name))
+  {
+    return std::make_unique<BinaryTraceReader>(file_name);
+  }
+  std::ifstream trace(file_name);
+  if (!trace.is_open()) return nullptr;
+  return std::make_unique<TextTraceReader>(std::move(trace));
+}
+
+void
+convert_trace(const std::string& in_file_name, const std::string& out_file_name)
+{
+  bool to_text = BinaryTrace::is_binary_trace(in_file_name);
+  std::unique_ptr<TraceReader> reader = TraceReader::open(in_file_name);
+  MURXLA_CHECK_CONFIG(reader != nullptr)
+      << "unable to open input file '" << in_file_name << "'";
+
+  std::ofstream out(out_file_name, std::ios::binary | std::ios::trunc);
+  MURXLA_CHECK_CONFIG(out.is_open())
+      << "unable to open output file '" << out_file_name << "'";
+
+  std::string line;
+  bool newline;
+  if (to_text)
+  {
+    while (reader->next_text(line, newline))
+    {
+      out << line;
+      if (newline) out << '\n';
+    }
+  }
+  else
+  {
+    BinaryTraceWriter writer(out);
+    while (reader->next_text(line, newline))
+    {
+      writer.write_line(line, newline);
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
@@ -0,0 +1,178 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__BINARY_TRACE_H
+#define __MURXLA__BINARY_TRACE_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Binary API trace format.
+ *
+ * A binary trace is a lossless, compact encoding of a text API trace. It
+ * starts with a header (BinaryTrace::MAGIC), followed by one record per line
+ * of the text trace. A line is split at every single space into pieces, and
+ * a record consists of
+ *
+ *   varint (number of pieces << 1 | 1 if line is terminated by newline)
+ *   piece*
+ *
+ * Each piece is encoded as a varint (value << 3 | tag), where tag is one of
+ * BinaryTrace::Tag. Term ids, sort ids and numbers are stored as varints,
+ * all other pieces (action kinds, symbols, ...) are interned into a string
+ * table. A string is stored inline on its first occurrence, which implicitly
+ * assigns it the next index in the string table, and referenced by index
+ * afterwards.
+ */
+struct BinaryTrace
+{
+  /** The header of a binary trace file. */
+  inline static const std::string MAGIC = "MURXLABT\x01";
+
+  /** The tags of encoded pieces. */
+  enum Tag
+  {
+    /** The empty string (consecutive spaces, indentation). */
+    EMPTY,
+    /** An unsigned integer without leading zeros. */
+    UINT,
+    /** A term id 't<uint>'. */
+    TERM,
+    /** A sort id 's<uint>'. */
+    SORT,
+    /** A reference to a string in the string table. */
+    STR,
+    /** A new string with given length, added to the string table. */
+    STR_NEW,
+  };
+
+  /** @return  True if given file is a binary trace. */
+  static bool is_binary_trace(const std::string& file_name);
+};
+
+/* -------------------------------------------------------------------------- */
+
+/** Encodes lines of a text API trace into the binary trace format. */
+class BinaryTraceWriter
+{
+ public:
+  /**
+   * Constructor.
+   * @param out  The output stream to write the binary trace to.
+   */
+  BinaryTraceWriter(std::ostream& out);
+
+  /**
+   * Encode given line.
+   * @param line     The line of a text trace, without line terminator.
+   * @param newline  True if the line is terminated by a newline.
+   */
+  void write_line(std::string_view line, bool newline = true);
+
+ private:
+  /** Write given value as varint. */
+  void write_varint(uint64_t value);
+  /** Write given piece of a line. */
+  void write_piece(std::string_view piece);
+
+  /** The output stream. */
+  std::ostream& d_out;
+  /** The string table, maps strings to their index. */
+  std::unordered_map<std::string, uint64_t> d_strings;
+};
+
+/* -------------------------------------------------------------------------- */
+
+/** A line of an API trace, as required for untracing. */
+struct TraceLine
+{
+  /** The seed of the line, 0 if it has no seed. */
+  uint32_t d_seed = 0;
+  /** The action kind, or "return" for return statements. */
+  std::string d_id;
+  /**
+   * The index of the action kind in the string table of a binary trace, or -1
+   * if the line was not read from a binary trace.
+   */
+  int64_t d_id_index = -1;
+  /** The tokens (arguments) of the line. */
+  std::vector<std::string> d_tokens;
+  /**
+   * True if the line does not contain a statement (empty lines, comments and
+   * the set-murxla-options line).
+   */
+  bool d_ignore = false;
+};
+
+/**
+ * Reader for API traces in text or binary format.
+ *
+ * Binary traces are mapped into memory and decoded without going through
+ * streams.
+ */
+class TraceReader
+{
+ public:
+  /**
+   * Open given trace file.
+   * @param file_name  The trace file, binary or text.
+   * @return  The reader for given trace file, nullptr if the file could not be
+   *          opened.
+   */
+  static std::unique_ptr<TraceReader> open(const std::string& file_name);
+
+  virtual ~TraceReader() = default;
+
+  /**
+   * Read and tokenize the next line, see tokenize() in util.hpp.
+   * @param line  The line to store the result in.
+   * @return  False if the end of the trace has been reached.
+   */
+  virtual bool next(TraceLine& line) = 0;
+
+  /**
+   * Read the next line as text.
+   * @param line     The string to store the line in, without line terminator.
+   * @param newline  Set to true if the line is terminated by a newline.
+   * @return  False if the end of the trace has been reached.
+   */
+  virtual bool next_text(std::string& line, bool& newline) = 0;
+
+  /** @return  The number of the line that was read last. */
+  uint32_t line_number() const { return d_line_number; }
+
+ protected:
+  /** The number of the line that was read last. */
+  uint32_t d_line_number = 0;
+};
+
+/**
+ * Convert given trace file into the other format, i.e., text traces are
+ * converted to binary traces and vice versa.
+ * @param in_file_name   The trace file to convert.
+ * @param out_file_name  The file to write the converted trace to.
+ */
+void convert_trace(const std::string& in_file_name,
+                   const std::string& out_file_name);
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
+
+#endif
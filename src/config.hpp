@@ -46,6 +46,37 @@
  * of a kind has been exceeded, increase this value.
  */
 #define MURXLA_MAX_KIND_LEN 100
+/**
+ * Number of buckets of the latency histograms of actions and operators.
+ *
+ * Bucket i counts latencies in [2^i, 2^(i+1)) nanoseconds, bucket 0 also
+ * counts latencies below 1ns and the last bucket all latencies that exceed
+ * the range of the previous buckets.
+ */
+#define MURXLA_N_LATENCY_BUCKETS 40
+
+/**
+ * Number of entries of the edge map for coverage feedback.
+ *
+ * The edges of the solver under test are hashed into the edge map, edges
+ * that collide are not distinguished.
+ */
+#define MURXLA_COVERAGE_MAP_SIZE (1 << 16)
+
+/**
+ * Number of test runs after which adaptive weights are recomputed in
+ * continuous mode (see adaptive::Weights).
+ */
+#define MURXLA_ADAPTIVE_WEIGHTS_INTERVAL 100
+
+/**
+ * Minimum factor applied to the weight of an action or operator by coverage
+ * feedback (see coverage::Feedback) and adaptive weights (see
+ * adaptive::Weights).
+ */
+#define MURXLA_MIN_WEIGHT_FACTOR 0.25
+/** Maximum factor applied to the weight of an action or operator. */
+#define MURXLA_MAX_WEIGHT_FACTOR 4.0
 
 /** Minimum bit-width for bit-vector terms. */
 #define MURXLA_BW_MIN 1
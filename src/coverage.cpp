@@ -0,0 +1,168 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#include "coverage.hpp"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "except.hpp"
+
+namespace murxla {
+namespace coverage {
+
+namespace {
+
+/** The edge map of the current feedback object, nullptr if none. */
+uint8_t* s_edges = nullptr;
+
+/**
+ * The number of runs that the per action and per operator hit rates are
+ * smoothed with, i.e., the rate of actions and operators that were used in
+ * only a few runs is close to the average rate.
+ */
+constexpr double PRIOR_RUNS = 2;
+
+}  // namespace
+
+/* -------------------------------------------------------------------------- */
+
+Feedback*
+Feedback::create()
+{
+  Feedback* res = static_cast<Feedback*>(mmap(0,
+                                              sizeof(Feedback),
+                                              PROT_READ | PROT_WRITE,
+                                              MAP_ANONYMOUS | MAP_SHARED,
+                                              -1,
+                                              0));
+  MURXLA_EXIT_ERROR(res == MAP_FAILED)
+      << "failed to map shared memory for coverage feedback";
+  memset(res, 0, sizeof(Feedback));
+  s_edges = res->d_edges;
+  return res;
+}
+
+bool
+Feedback::is_supported()
+{
+#ifdef MURXLA_SANCOV
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+Feedback::start_run()
+{
+  memset(d_edges, 0, sizeof(d_edges));
+}
+
+uint64_t
+Feedback::finish_run(const uint64_t* actions, const uint64_t* ops)
+{
+  uint64_t num_new = 0;
+  for (size_t i = 0; i < MURXLA_COVERAGE_MAP_SIZE; ++i)
+  {
+    if (d_edges[i] && !d_seen[i])
+    {
+      d_seen[i] = 1;
+      num_new += 1;
+    }
+  }
+  d_num_seen += num_new;
+
+  bool hit_new = num_new > 0;
+  d_runs += 1;
+  d_runs_new += hit_new;
+  for (size_t i = 0; i < MURXLA_MAX_N_ACTIONS; ++i)
+  {
+    if (actions[i] == 0) continue;
+    d_action_runs[i] += 1;
+    d_action_runs_new[i] += hit_new;
+  }
+  for (size_t i = 0; i < MURXLA_MAX_N_OPS; ++i)
+  {
+    if (ops[i] == 0) continue;
+    d_op_runs[i] += 1;
+    d_op_runs_new[i] += hit_new;
+  }
+  return num_new;
+}
+
+double
+Feedback::get_action_factor(uint64_t id) const
+{
+  if (id >= MURXLA_MAX_N_ACTIONS) return 1;
+  return get_factor(d_action_runs[id], d_action_runs_new[id]);
+}
+
+double
+Feedback::get_op_factor(uint64_t id) const
+{
+  if (id >= MURXLA_MAX_N_OPS) return 1;
+  return get_factor(d_op_runs[id], d_op_runs_new[id]);
+}
+
+double
+Feedback::get_factor(uint64_t runs, uint64_t runs_new) const
+{
+  if (d_runs_new == 0) return 1;
+  double rate = static_cast<double>(d_runs_new) / static_cast<double>(d_runs);
+  double rate_used = (static_cast<double>(runs_new) + rate * PRIOR_RUNS)
+                     / (static_cast<double>(runs) + PRIOR_RUNS);
+  return std::clamp(
+      rate_used / rate, MURXLA_MIN_WEIGHT_FACTOR, MURXLA_MAX_WEIGHT_FACTOR);
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace coverage
+}  // namespace murxla
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef MURXLA_SANCOV
+/*
+ * The SanitizerCoverage callbacks called by the instrumented solver under
+ * test. With -fsanitize-coverage=trace-pc-guard (clang), each guard
+ * identifies an edge, the guards are numbered consecutively starting from 1.
+ * With -fsanitize-coverage=trace-pc (gcc), edges are approximated by the
+ * addresses of the instrumented basic blocks.
+ */
+
+extern "C" void
+__sanitizer_cov_trace_pc_guard_init(uint32_t* start, uint32_t* stop)
+{
+  static uint32_t num_guards = 0;
+  if (start == stop || *start) return;
+  for (uint32_t* guard = start; guard < stop; ++guard)
+  {
+    *guard = ++num_guards;
+  }
+}
+
+extern "C" void
+__sanitizer_cov_trace_pc_guard(uint32_t* guard)
+{
+  if (murxla::coverage::s_edges == nullptr || *guard == 0) return;
+  murxla::coverage::s_edges[*guard % MURXLA_COVERAGE_MAP_SIZE] = 1;
+}
+
+extern "C" void
+__sanitizer_cov_trace_pc()
+{
+  if (murxla::coverage::s_edges == nullptr) return;
+  uintptr_t pc = reinterpret_cast<uintptr_t>(__builtin_return_address(0));
+  murxla::coverage::s_edges[(pc ^ (pc >> 16)) % MURXLA_COVERAGE_MAP_SIZE] = 1;
+}
+#endif
@@ -0,0 +1,107 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__COVERAGE_H
+#define __MURXLA__COVERAGE_H
+
+#include <cstdint>
+
+#include "config.hpp"
+
+namespace murxla {
+namespace coverage {
+
+/**
+ * Coverage feedback for weighting actions and operators.
+ *
+ * The solver under test is expected to be compiled with
+ * -fsanitize-coverage=trace-pc-guard (or trace-pc with gcc), and Murxla with
+ * SANCOV=ON, which provides the SanitizerCoverage callbacks that record the
+ * edges hit by the solver in the edge map of the current feedback object.
+ * After each test run, the parent process determines whether the run hit
+ * edges that were not hit by any previous run, and which actions and
+ * operators were used in the run. Actions and operators that were used in
+ * runs that hit new edges more often than average get higher weights in
+ * subsequent test runs, and vice versa.
+ *
+ * The feedback object is located in shared memory. We thus only use base
+ * types here.
+ */
+struct Feedback
+{
+  /**
+   * Create a feedback object in shared memory and record the edges hit by
+   * the solver into it.
+   * @return  The feedback object.
+   */
+  static Feedback* create();
+
+  /** @return  True if Murxla was built with the SanitizerCoverage callbacks. */
+  static bool is_supported();
+
+  /** Reset the edges hit by the current test run. */
+  void start_run();
+
+  /**
+   * Update the feedback with the edges hit by the current test run.
+   * @param actions  The number of times each action (by id) was used in the
+   *                 test run.
+   * @param ops      The number of times each operator (by id) was used in the
+   *                 test run.
+   * @return  The number of edges that were hit for the first time.
+   */
+  uint64_t finish_run(const uint64_t* actions, const uint64_t* ops);
+
+  /**
+   * Get the factor to apply to the weight of the action with given id.
+   * @param id  The id of the action.
+   * @return  The weight factor, between MURXLA_MIN_WEIGHT_FACTOR and
+   *          MURXLA_MAX_WEIGHT_FACTOR.
+   */
+  double get_action_factor(uint64_t id) const;
+
+  /**
+   * Get the factor to apply to the weight of the operator with given id.
+   * @param id  The id of the operator.
+   * @return  The weight factor, between MURXLA_MIN_WEIGHT_FACTOR and
+   *          MURXLA_MAX_WEIGHT_FACTOR.
+   */
+  double get_op_factor(uint64_t id) const;
+
+  /** The edges hit by the current test run. */
+  uint8_t d_edges[MURXLA_COVERAGE_MAP_SIZE];
+  /** The edges hit by any previous test run. */
+  uint8_t d_seen[MURXLA_COVERAGE_MAP_SIZE];
+  /** The number of edges hit by any previous test run. */
+  uint64_t d_num_seen;
+  /** The number of test runs. */
+  uint64_t d_runs;
+  /** The number of test runs that hit new edges. */
+  uint64_t d_runs_new;
+  /** The number of test runs that used an action, by action id. */
+  uint64_t d_action_runs[MURXLA_MAX_N_ACTIONS];
+  /** The number of test runs that used an action and hit new edges. */
+  uint64_t d_action_runs_new[MURXLA_MAX_N_ACTIONS];
+  /** The number of test runs that used an operator, by operator id. */
+  uint64_t d_op_runs[MURXLA_MAX_N_OPS];
+  /** The number of test runs that used an operator and hit new edges. */
+  uint64_t d_op_runs_new[MURXLA_MAX_N_OPS];
+
+ private:
+  /**
+   * Compute the weight factor from the number of runs that used an action or
+   * operator, and the number of these runs that hit new edges.
+   */
+  double get_factor(uint64_t runs, uint64_t runs_new) const;
+};
+
+}  // namespace coverage
+}  // namespace murxla
+
+#endif
@@ -9,9 +9,14 @@
  */
 #include "dd.hpp"
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <thread>
 
 #include "except.hpp"
 #include "murxla.hpp"
@@ -85,6 +90,18 @@ DD::DD(Murxla* murxla, uint64_t seed)
       get_tmp_file_path("tmp-dd-gold.err", d_murxla->d_tmp_dir);
   d_tmp_trace_file_name =
       get_tmp_file_path("tmp-api-dd.trace", d_murxla->d_tmp_dir);
+  /* The time limit of a test is derived from the runtime of the golden run,
+   * which must not be distorted by running more jobs than available cores. */
+  d_jobs = std::min(d_murxla->d_options.jobs,
+                    std::max(std::thread::hardware_concurrency(), 1u));
+  /* Snapshots of the replay process share the state of the solver, which
+   * is not possible if the solver runs in another process (online SMT2
+   * solver) or uses threads (concurrent cross-check and check solvers). */
+  const Options& options = d_murxla->d_options;
+  d_checkpoint = options.dd_checkpoint > 0 && d_jobs <= 1
+                 && !options.check_concurrent
+                 && (options.solver != SOLVER_SMT2
+                     || options.solver_binary.empty());
 }
 
 void
@@ -157,6 +174,8 @@ DD::run(const std::string& input_trace_file_name,
                       << "' in stderr output";
   }
 
+  init_cache(gold_exit);
+
   /* Start delta debugging */
 
   /* Represent input trace as vector of lines.
@@ -228,6 +247,8 @@ DD::run(const std::string& input_trace_file_name,
     iterations += 1;
   } while (!fixed_point);
 
+  d_murxla->stop_replay();
+
   /* Write minimized trace file to path if given. */
   assert(!reduced_trace_file_name.empty());
   if (!d_murxla->d_options.out_dir.empty())
@@ -239,6 +260,11 @@ DD::run(const std::string& input_trace_file_name,
   MURXLA_MESSAGE_DD;
   MURXLA_MESSAGE_DD << d_ntests_success << " (of " << d_ntests
                     << ") tests reduced successfully";
+  if (d_ntests_cached)
+  {
+    MURXLA_MESSAGE_DD << d_ntests_cached << " (of " << d_ntests
+                      << ") test results retrieved from cache";
+  }
 
   if (std::filesystem::exists(d_tmp_trace_file_name))
   {
@@ -278,23 +304,22 @@ DD::minimize_lines(Result golden_exit,
     std::vector<size_t> superset_cur;
     std::unordered_set<size_t> excluded_sets;
     /* we skip the first subset (will always fail since it contains 'new') */
-    for (size_t i = 0, n = subsets.size() - 1; i < n; ++i)
-    {
-      /* remove subsets from last to first */
-      size_t idx = n - i - 1;
-
+    size_t n = subsets.size() - 1;
+    /* remove subsets from last to first */
+    auto write_candidate = [&](size_t i, const std::string& file_name) {
       std::unordered_set<size_t> ex(excluded_sets);
-      ex.insert(idx);
-
-      std::vector<size_t> tmp_superset = test(golden_exit,
-                                              lines,
-                                              remove_subsets(subsets, ex),
-                                              input_trace_file_name);
-      if (!tmp_superset.empty())
-      {
-        superset_cur = tmp_superset;
-        excluded_sets.insert(idx);
-      }
+      ex.insert(n - i - 1);
+      write_lines_to_file(lines, remove_subsets(subsets, ex), file_name);
+      return true;
+    };
+    for (size_t i = 0;
+         (i = test_first(
+              golden_exit, i, n, input_trace_file_name, write_candidate))
+         < n;
+         ++i)
+    {
+      excluded_sets.insert(n - i - 1);
+      superset_cur = remove_subsets(subsets, excluded_sets);
     }
     if (superset_cur.empty())
     {
@@ -697,37 +722,45 @@ DD::substitute_terms(Result golden_exit,
           std::vector<size_t> superset_cur;
           std::unordered_set<size_t> successful_sets;
 
-          /* We try for each subset if we can replace the term in all of
-           * its lines. */
-          for (size_t i = 0, n = subsets.size(); i < n; ++i)
-          {
-            /* Cache previous state of lines to update and update lines. */
+          /* Replace the term in all lines of given subset, returns the
+           * previous state of the updated lines. */
+          auto replace = [&](size_t i) {
             std::unordered_map<size_t, std::string> lines_cur;
-
             for (size_t line_idx : subsets[i])
             {
               lines_cur[line_idx] = lines[line_idx][0];
               str_replace_all(
                   lines[line_idx][0], term_id_to_substitute, term_id);
             }
-
-            std::vector<size_t> tmp_superset =
-                test(golden_exit, lines, included_lines, input_trace_file_name);
-
-            if (!tmp_superset.empty())
+            return lines_cur;
+          };
+          auto write_candidate = [&](size_t i, const std::string& file_name) {
+            auto lines_cur = replace(i);
+            write_lines_to_file(lines, included_lines, file_name);
+            for (auto l : lines_cur)
             {
-              /* success */
-              successful_sets.insert(i);
+              lines[l.first][0] = l.second;
             }
-            else
+            return true;
+          };
+
+          /* We try for each subset if we can replace the term in all of
+           * its lines. */
+          for (size_t i = 0, n = subsets.size(); i < n; ++i)
+          {
+            size_t next = test_first(
+                golden_exit, i, n, input_trace_file_name, write_candidate);
+            /* failure */
+            for (; i < next; ++i)
             {
-              /* failure */
               superset_cur.insert(
                   superset_cur.end(), subsets[i].begin(), subsets[i].end());
-              for (auto l : lines_cur)
-              {
-                lines[l.first][0] = l.second;
-              }
+            }
+            /* success */
+            if (next < n)
+            {
+              replace(next);
+              successful_sets.insert(next);
             }
           }
           if (successful_sets.empty())
@@ -793,39 +826,40 @@ DD::minimize_line_aux(Result golden_exit,
 
     std::vector<size_t> cur_line_superset;
     std::unordered_set<size_t> excluded_sets;
-    for (size_t i = 0, n = subsets.size(); i < n; ++i)
-    {
+    auto get_included_args = [&](size_t i) {
       std::unordered_set<size_t> ex(excluded_sets);
       ex.insert(i);
-      std::vector<size_t> included_args = remove_subsets(subsets, ex);
+      return remove_subsets(subsets, ex);
+    };
+    auto write_candidate = [&](size_t i, const std::string& file_name) {
+      std::vector<size_t> included_args = get_included_args(i);
       size_t n_included_args            = included_args.size();
-      if (n_included_args == 0) continue;
+      if (n_included_args == 0) return false;
       if (kind_first == ActionMkTerm::s_name && n_included_args < 2)
       {
-        continue;
+        return false;
       }
 
       /* Cache previous state of lines to update and update lines. */
       auto lines_cur = update_lines(lines, included_args, to_minimize);
-
-      /* test if minimization was successful */
-      std::vector<size_t> tmp_superset =
-          test(golden_exit, lines, included_lines, input_trace_file_name);
-
-      if (!tmp_superset.empty())
+      write_lines_to_file(lines, included_lines, file_name);
+      for (auto l : lines_cur)
       {
-        /* success */
-        cur_line_superset = included_args;
-        excluded_sets.insert(i);
-      }
-      else
-      {
-        /* failure */
-        for (auto l : lines_cur)
-        {
-          lines[l.first][0] = l.second;
-        }
+        lines[l.first][0] = l.second;
       }
+      return true;
+    };
+
+    for (size_t i = 0, n = subsets.size();
+         (i = test_first(
+              golden_exit, i, n, input_trace_file_name, write_candidate))
+         < n;
+         ++i)
+    {
+      /* success */
+      cur_line_superset = get_included_args(i);
+      update_lines(lines, cur_line_superset, to_minimize);
+      excluded_sets.insert(i);
     }
     if (cur_line_superset.empty())
     {
@@ -923,6 +957,8 @@ DD::minimize_line(Result golden_exit,
                         << (line_number - lines[line_idx].size() + 1) << " ...";
       if (action == ActionMkTerm::s_name)
       {
+        /* unknown op kind, skip */
+        if (!Op::Kind::find(tokens[0])) continue;
         Op::Kind op_kind = tokens[0];
         Op& op           = opmgr.get_op(op_kind);
         /* op kind not in op datatbase, skip */
@@ -971,46 +1007,235 @@ DD::minimize_line(Result golden_exit,
   return res;
 }
 
-std::vector<size_t>
-DD::test(Result golden_exit,
-         const std::vector<std::vector<std::string>>& lines,
-         const std::vector<size_t>& superset,
-         const std::string& untrace_file_name)
+size_t
+DD::test_first(
+    Result golden_exit,
+    size_t first,
+    size_t n,
+    const std::string& untrace_file_name,
+    const std::function<bool(size_t, const std::string&)>& write_candidate)
+{
+  if (d_jobs <= 1)
+  {
+    for (size_t i = first; i < n; ++i)
+    {
+      if (!write_candidate(i, untrace_file_name)) continue;
+      d_ntests += 1;
+      DDCache::Key key         = DDCache::get_file_key(untrace_file_name);
+      const TestResult* cached = d_cache.find(key);
+      bool match;
+      if (cached)
+      {
+        d_ntests_cached += 1;
+        match = cached->d_match;
+      }
+      else
+      {
+        TestResult res = test(golden_exit, untrace_file_name);
+        cache(key, res);
+        match = res.d_match;
+      }
+      if (match)
+      {
+        d_ntests_success += 1;
+        return i;
+      }
+    }
+    return n;
+  }
+
+  /* Make sure that buffered output is not duplicated in the jobs. */
+  std::cout << std::flush;
+
+  struct Job
+  {
+    size_t d_idx;
+    DDCache::Key d_key;
+    /* The pid of the forked job, 0 if the result is cached. */
+    pid_t d_pid;
+  };
+
+  for (size_t i = first; i < n;)
+  {
+    /* Fork a job for each candidate of the next batch that is not cached.
+     * A batch ends at the first cached successful candidate. */
+    std::vector<Job> batch;
+    size_t nforked = 0;
+    while (i < n && nforked < d_jobs)
+    {
+      const std::string& tmp_dir  = get_job_tmp_dir(nforked);
+      std::string trace_file_name = get_tmp_file_path(API_TRACE, tmp_dir);
+      size_t idx                  = i++;
+      if (!write_candidate(idx, trace_file_name)) continue;
+
+      DDCache::Key key         = DDCache::get_file_key(trace_file_name);
+      const TestResult* cached = d_cache.find(key);
+      if (cached)
+      {
+        batch.push_back({idx, key, 0});
+        if (cached->d_match) break;
+        continue;
+      }
+
+      pid_t pid = fork();
+      MURXLA_EXIT_ERROR(pid < 0) << "forking delta debugging job failed.";
+      if (pid == 0)
+      {
+        d_murxla->detach(tmp_dir);
+        TestResult res = test(golden_exit, trace_file_name);
+        _exit(res.d_exit << 1 | res.d_match);
+      }
+      batch.push_back({idx, key, pid});
+      nforked += 1;
+    }
+
+    /* Collect the results in order, the results of all candidates after the
+     * first successful candidate are discarded. */
+    size_t res = n;
+    for (const Job& job : batch)
+    {
+      bool match;
+      if (job.d_pid == 0)
+      {
+        if (res < n) continue;
+        d_ntests_cached += 1;
+        match = d_cache.find(job.d_key)->d_match;
+      }
+      else
+      {
+        int32_t status;
+        while (waitpid(job.d_pid, &status, 0) < 0)
+        {
+          MURXLA_EXIT_ERROR(errno != EINTR)
+              << "failed to collect delta debugging job";
+        }
+        if (res < n) continue;
+        match = false;
+        if (WIFEXITED(status))
+        {
+          int32_t code = WEXITSTATUS(status);
+          match        = code & 1;
+          cache(job.d_key, {static_cast<Result>(code >> 1), match});
+        }
+      }
+      d_ntests += 1;
+      if (match)
+      {
+        d_ntests_success += 1;
+        res = job.d_idx;
+      }
+    }
+    if (res < n) return res;
+  }
+  return n;
+}
+
+DD::TestResult
+DD::test(Result golden_exit, const std::string& untrace_file_name)
 {
-  std::vector<size_t> res_superset;
   std::string tmp_out_file_name =
       get_tmp_file_path("tmp-dd.out", d_murxla->d_tmp_dir);
   std::string tmp_err_file_name =
       get_tmp_file_path("tmp-dd.err", d_murxla->d_tmp_dir);
 
-  write_lines_to_file(lines, superset, untrace_file_name);
-  /* while delta debugging, do not trace to file or stdout */
-  Result exit = d_murxla->run(d_seed,
-                              d_time,
-                              tmp_out_file_name,
-                              tmp_err_file_name,
-                              "",
-                              untrace_file_name,
-                              true,
-                              false,
-                              Murxla::TraceMode::NONE);
-  d_ntests += 1;
-  if (exit == golden_exit
+  Result exit;
+  if (d_checkpoint)
+  {
+    exit = d_murxla->replay(d_seed,
+                            d_time,
+                            tmp_out_file_name,
+                            tmp_err_file_name,
+                            untrace_file_name);
+  }
+  else
+  {
+    /* while delta debugging, do not trace to file or stdout */
+    exit = d_murxla->run(d_seed,
+                         d_time,
+                         tmp_out_file_name,
+                         tmp_err_file_name,
+                         "",
+                         untrace_file_name,
+                         true,
+                         false,
+                         Murxla::TraceMode::NONE);
+  }
+  bool match =
+      exit == golden_exit
       && (d_murxla->d_options.dd_ignore_out
           || (!d_murxla->d_options.dd_match_out.empty()
-              && find_in_file(
-                  tmp_err_file_name, d_murxla->d_options.dd_match_out, false))
+              && find_in_file(tmp_err_file_name,
+                              d_murxla->d_options.dd_match_out,
+                              false))
           || compare_files(tmp_out_file_name, d_gold_out_file_name))
       && (d_murxla->d_options.dd_ignore_err
           || (!d_murxla->d_options.dd_match_err.empty()
-              && find_in_file(
-                  tmp_err_file_name, d_murxla->d_options.dd_match_err, false))
-          || compare_files(tmp_err_file_name, d_gold_err_file_name)))
+              && find_in_file(tmp_err_file_name,
+                              d_murxla->d_options.dd_match_err,
+                              false))
+          || compare_files(tmp_err_file_name, d_gold_err_file_name));
+  return {exit, match};
+}
+
+void
+DD::init_cache(Result golden_exit)
+{
+  const Options& options = d_murxla->d_options;
+
+  /* The fingerprint of the golden run identifies the entries of the persisted
+   * cache that belong to the current session. */
+  DDCache::Key fingerprint;
+  auto add = [&fingerprint](std::string_view data) {
+    /* Prefix data with its size to keep the concatenation unambiguous. */
+    fingerprint.add(std::to_string(data.size()) + ":");
+    fingerprint.add(data);
+  };
+  add(std::to_string(golden_exit));
+  for (const std::string& file_name :
+       {d_gold_out_file_name, d_gold_err_file_name})
+  {
+    DDCache::Key key = DDCache::get_file_key(file_name);
+    add(std::to_string(key.d_hash) + " " + std::to_string(key.d_size));
+  }
+  add(std::to_string(d_seed));
+  add(options.solver);
+  add(options.solver_binary);
+  add(options.dd_ignore_out ? "1" : "0");
+  add(options.dd_ignore_err ? "1" : "0");
+  add(options.dd_match_out);
+  add(options.dd_match_err);
+
+  if (!options.dd_cache)
+  {
+    d_cache.init(fingerprint, "");
+    return;
+  }
+
+  std::string cache_file_name =
+      get_tmp_file_path(RESULT_CACHE, options.tmp_dir);
+  d_cache.init(fingerprint, cache_file_name);
+  MURXLA_MESSAGE_DD << "using " << d_cache.size()
+                    << " cached test results from '" << cache_file_name << "'";
+}
+
+void
+DD::cache(const DDCache::Key& key, const TestResult& result)
+{
+  if (result.d_exit == RESULT_TIMEOUT) return;
+  d_cache.add(key, result);
+}
+
+const std::string&
+DD::get_job_tmp_dir(size_t job)
+{
+  while (d_job_tmp_dirs.size() <= job)
   {
-    res_superset = superset;
-    d_ntests_success += 1;
+    std::string tmp_dir = get_tmp_file_path(
+        "dd-job-" + std::to_string(d_job_tmp_dirs.size()), d_murxla->d_tmp_dir);
+    std::filesystem::create_directories(tmp_dir);
+    d_job_tmp_dirs.push_back(tmp_dir);
   }
-  return res_superset;
+  return d_job_tmp_dirs[job];
 }
 
 void
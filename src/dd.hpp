@@ -11,10 +11,14 @@
 #define __MURXLA__DD_H
 
 #include <cstdint>
+#include <fstream>
+#include <functional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "action.hpp"
+#include "dd_cache.hpp"
 #include "result.hpp"
 
 namespace murxla {
@@ -24,8 +28,13 @@ class Murxla;
 class DD
 {
  public:
+  /** The result of testing a candidate trace. */
+  using TestResult = DDCache::TestResult;
+
   /** The default api trace file name for temporary trace files. */
   inline static const std::string API_TRACE    = "tmp-dd-api.trace";
+  /** The file name of the persisted test result cache (in --tmp-dir). */
+  inline static const std::string RESULT_CACHE = "murxla-dd-cache";
 
   /**
    * Constructor.
@@ -73,10 +82,62 @@ class DD
                         std::vector<size_t>& included_lines,
                         const std::string& input_trace_file_name);
 
-  std::vector<size_t> test(Result golden_exit,
-                           const std::vector<std::vector<std::string>>& lines,
-                           const std::vector<size_t>& superset,
-                           const std::string& input_trace_file_name);
+  /**
+   * Test candidates 'first' to 'n - 1' in this order until the first
+   * candidate is found that preserves the golden behavior.
+   *
+   * If more than one job is configured, the candidates are tested in batches
+   * of up to 'd_jobs' candidates in parallel. All candidates of a batch are
+   * derived from the same state, only the results up to the first successful
+   * candidate are used. The result is thus the same as when testing the
+   * candidates sequentially.
+   *
+   * @param golden_exit        The exit code of the golden run.
+   * @param first              The index of the first candidate to test.
+   * @param n                  The number of candidates.
+   * @param untrace_file_name  The trace file to use when testing
+   *                           sequentially.
+   * @param write_candidate    Writes the trace of the candidate with the
+   *                           given index to the given file, returns false
+   *                           if the candidate is to be skipped.
+   * @return  The index of the first successful candidate, and 'n' if none of
+   *          the candidates was successful.
+   */
+  size_t test_first(
+      Result golden_exit,
+      size_t first,
+      size_t n,
+      const std::string& untrace_file_name,
+      const std::function<bool(size_t, const std::string&)>& write_candidate);
+
+  /**
+   * Replay given trace and determine if it preserves the golden behavior.
+   *
+   * @param golden_exit        The exit code of the golden run.
+   * @param untrace_file_name  The trace file to replay.
+   */
+  TestResult test(Result golden_exit, const std::string& untrace_file_name);
+
+  /**
+   * Initialize the test result cache for the current golden run. If the
+   * cache is persisted, the entries of previous sessions with the same
+   * golden run are loaded.
+   *
+   * @param golden_exit  The exit code of the golden run.
+   */
+  void init_cache(Result golden_exit);
+
+  /**
+   * Cache given test result. Test results of runs that timed out are not
+   * cached since they depend on the load of the machine.
+   *
+   * @param key     The key of the tested trace.
+   * @param result  The test result.
+   */
+  void cache(const DDCache::Key& key, const TestResult& result);
+
+  /** Get the directory for temp files of the parallel job with index 'job'. */
+  const std::string& get_job_tmp_dir(size_t job);
 
   /**
    * Write trace lines to output file.
@@ -113,6 +174,8 @@ class DD
   uint64_t d_ntests = 0;
   /** Number of successful tests performed while delta debugging. */
   uint64_t d_ntests_success = 0;
+  /** Number of tests answered from the test result cache. */
+  uint64_t d_ntests_cached = 0;
   /** The output file name for the initial dd test run. */
   std::string d_gold_out_file_name;
   /** The error output file name for the initial dd test run. */
@@ -121,6 +184,20 @@ class DD
   std::string d_tmp_trace_file_name;
   /** The trace line configuring murxla options. */
   std::string d_options_line;
+  /**
+   * The number of candidates to test in parallel, at most the number of
+   * available cores.
+   */
+  uint32_t d_jobs;
+  /**
+   * True if tested traces are resumed from snapshots of previous replays
+   * (see Murxla::replay()).
+   */
+  bool d_checkpoint;
+  /** The directories for temp files of parallel jobs. */
+  std::vector<std::string> d_job_tmp_dirs;
+  /** The cache of test results. */
+  DDCache d_cache;
 };
 
 }  // namespace murxla
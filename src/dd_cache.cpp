@@ -0,0 +1,114 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#include "dd_cache.hpp"
+
+#include <sstream>
+
+#include "except.hpp"
+#include "util.hpp"
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+void
+DDCache::Key::add(std::string_view data)
+{
+  for (char c : data)
+  {
+    d_hash ^= static_cast<uint8_t>(c);
+    d_hash *= FNV_PRIME;
+  }
+  d_size += data.size();
+}
+
+DDCache::Key
+DDCache::get_key(std::string_view data)
+{
+  Key res;
+  res.add(data);
+  return res;
+}
+
+DDCache::Key
+DDCache::get_file_key(const std::string& file_name)
+{
+  std::ifstream file = open_input_file(file_name, false);
+  Key res;
+  char buf[4096];
+  while (file.read(buf, sizeof(buf)) || file.gcount() > 0)
+  {
+    res.add(std::string_view(buf, static_cast<size_t>(file.gcount())));
+  }
+  return res;
+}
+
+void
+DDCache::init(const Key& fingerprint, const std::string& file_name)
+{
+  d_cache.clear();
+  d_fingerprint = fingerprint;
+  if (d_file.is_open()) d_file.close();
+  if (file_name.empty()) return;
+
+  /* Each line of the persisted cache is of the form
+   * <fingerprint hash> <fingerprint size> <hash> <size> <exit> <match>, with
+   * hashes in hexadecimal. We only load the entries of previous sessions with
+   * the same golden run, and skip malformed lines. */
+  {
+    std::ifstream file(file_name);
+    std::string line;
+    while (std::getline(file, line))
+    {
+      std::stringstream ss(line);
+      Key fp, key;
+      uint32_t exit;
+      bool match;
+      std::string rest;
+      if (!(ss >> std::hex >> fp.d_hash >> std::dec >> fp.d_size >> std::hex
+            >> key.d_hash >> std::dec >> key.d_size >> exit >> match)
+          || exit > RESULT_UNKNOWN || (ss >> rest))
+      {
+        continue;
+      }
+      if (fp == d_fingerprint)
+      {
+        d_cache[key] = {static_cast<Result>(exit), match};
+      }
+    }
+  }
+  d_file.open(file_name, std::ios::app);
+  MURXLA_EXIT_ERROR(!d_file.is_open())
+      << "unable to open file '" << file_name << "'";
+}
+
+const DDCache::TestResult*
+DDCache::find(const Key& key) const
+{
+  auto it = d_cache.find(key);
+  return it == d_cache.end() ? nullptr : &it->second;
+}
+
+void
+DDCache::add(const Key& key, const TestResult& result)
+{
+  d_cache[key] = result;
+  if (d_file.is_open())
+  {
+    d_file << std::hex << d_fingerprint.d_hash << std::dec << " "
+           << d_fingerprint.d_size << " " << std::hex << key.d_hash << std::dec
+           << " " << key.d_size << " " << static_cast<uint32_t>(result.d_exit)
+           << " " << result.d_match << std::endl;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
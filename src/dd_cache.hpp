@@ -0,0 +1,120 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__DD_CACHE_H
+#define __MURXLA__DD_CACHE_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "result.hpp"
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * The test result cache of delta debugging.
+ *
+ * Tested traces are identified by their size and the 64-bit FNV-1a hash of
+ * their contents. Both are independent of the standard library in use, hence
+ * cache entries can be persisted and reused by other builds of Murxla.
+ * Persisted entries are only reused for a golden run with the same
+ * fingerprint, which is a key computed over the golden run's
+ * configuration and output.
+ */
+class DDCache
+{
+ public:
+  /** The result of testing a candidate trace. */
+  struct TestResult
+  {
+    /** The exit code of the test run. */
+    Result d_exit;
+    /** True if the test run preserved the golden behavior. */
+    bool d_match;
+  };
+
+  /** The key of a tested trace, or the fingerprint of a golden run. */
+  struct Key
+  {
+    /** The FNV-1a offset basis. */
+    static constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325;
+    /** The FNV-1a prime. */
+    static constexpr uint64_t FNV_PRIME = 0x100000001b3;
+
+    /** Add given data to the hashed data. */
+    void add(std::string_view data);
+
+    bool operator==(const Key& other) const
+    {
+      return d_hash == other.d_hash && d_size == other.d_size;
+    }
+
+    /** The FNV-1a hash of the data. */
+    uint64_t d_hash = FNV_OFFSET;
+    /** The size of the data in bytes. */
+    uint64_t d_size = 0;
+  };
+
+  /** @return  The key of given data. */
+  static Key get_key(std::string_view data);
+  /** @return  The key of the contents of given file. */
+  static Key get_file_key(const std::string& file_name);
+
+  /**
+   * Clear the cache and initialize it for the golden run with given
+   * fingerprint.
+   * @param fingerprint  The fingerprint of the golden run.
+   * @param file_name    The file to persist the cache to, empty if it is not
+   *                     persisted. Entries of previous sessions with the
+   *                     same fingerprint are loaded from this file.
+   */
+  void init(const Key& fingerprint, const std::string& file_name);
+
+  /**
+   * Get the cached result of the trace with given key.
+   * @param key  The key of the trace.
+   * @return  The cached result, nullptr if not cached.
+   */
+  const TestResult* find(const Key& key) const;
+
+  /**
+   * Cache given test result, and persist it if enabled.
+   * @param key     The key of the tested trace.
+   * @param result  The test result.
+   */
+  void add(const Key& key, const TestResult& result);
+
+  /** @return  The number of cached test results. */
+  size_t size() const { return d_cache.size(); }
+
+ private:
+  /** Hash function for keys. */
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const { return key.d_hash; }
+  };
+
+  /** The cached test results. */
+  std::unordered_map<Key, TestResult, KeyHash> d_cache;
+  /** The fingerprint of the current golden run. */
+  Key d_fingerprint;
+  /** The file to persist the cache to, if enabled. */
+  std::ofstream d_file;
+};
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
+
+#endif
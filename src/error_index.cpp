@@ -0,0 +1,293 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#include "error_index.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <limits>
+#include <regex>
+#include <sstream>
+#include <string_view>
+
+#include "util.hpp"
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** The number of stack frames included in the fingerprint of an error. */
+constexpr size_t NUM_FINGERPRINT_FRAMES = 3;
+
+/** Lines longer than this are not searched for error locations. */
+constexpr size_t MAX_LOCATION_LINE_LENGTH = 1024;
+
+/**
+ * Split string into tokens.
+ */
+std::vector<std::string>
+str_tokenize(const std::string& s)
+{
+  std::istringstream buf(s);
+  std::vector<std::string> ret{std::istream_iterator<std::string>(buf),
+                               std::istream_iterator<std::string>()};
+  return ret;
+}
+
+bool
+is_digit(char c)
+{
+  return std::isdigit(static_cast<unsigned char>(c));
+}
+
+/**
+ * Count the number of non-digit characters two token sequences differ in.
+ */
+size_t
+str_diff(const std::vector<std::string>& tokens1,
+         const std::vector<std::string>& tokens2)
+{
+  const std::vector<std::string>* t1 = &tokens1;
+  const std::vector<std::string>* t2 = &tokens2;
+
+  if (t1->size() > t2->size())
+  {
+    std::swap(t1, t2);
+  }
+
+  size_t diff = t2->size() - t1->size();
+  for (size_t i = 0; i < t1->size(); ++i)
+  {
+    const std::string& tok1 = (*t1)[i];
+    if (tok1 != (*t2)[i])
+    {
+      /* Ignore numbers for diff. */
+      diff += static_cast<size_t>(
+          std::count_if(tok1.begin(), tok1.end(), [](char c) {
+            return !is_digit(c);
+          }));
+    }
+  }
+  return diff;
+}
+
+double
+error_diff(const std::string& e1,
+           const std::vector<std::string>& tokens1,
+           const std::string& e2,
+           const std::vector<std::string>& tokens2)
+{
+  size_t len  = std::max(e1.size(), e2.size());
+  size_t diff = str_diff(tokens1, tokens2);
+  return static_cast<double>(diff) / static_cast<double>(len);
+}
+
+/** Mix the bits of given hash value (splitmix64 finalizer). */
+uint64_t
+mix(uint64_t h)
+{
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111eb;
+  h ^= h >> 31;
+  return h;
+}
+
+}  // namespace
+
+/* -------------------------------------------------------------------------- */
+
+void
+ErrorIndex::add(const std::string& err)
+{
+  std::vector<std::string> tokens = str_tokenize(err);
+  size_t idx                      = d_errors.size();
+  for (uint64_t key : get_keys(err, tokens))
+  {
+    std::vector<size_t>& bucket = d_buckets[key];
+    /* The same key may be generated more than once for an error. */
+    if (bucket.empty() || bucket.back() != idx)
+    {
+      bucket.push_back(idx);
+    }
+  }
+  d_errors.push_back({err, std::move(tokens)});
+}
+
+const std::string*
+ErrorIndex::find(const std::string& err) const
+{
+  std::vector<std::string> tokens = str_tokenize(err);
+
+  std::vector<size_t> candidates;
+  for (uint64_t key : get_keys(err, tokens))
+  {
+    auto it = d_buckets.find(key);
+    if (it != d_buckets.end())
+    {
+      candidates.insert(
+          candidates.end(), it->second.begin(), it->second.end());
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+
+  for (size_t idx : candidates)
+  {
+    const Entry& e = d_errors[idx];
+    /* The difference in the number of tokens is a lower bound of str_diff(). */
+    size_t ntokens = std::max(tokens.size(), e.d_tokens.size())
+                     - std::min(tokens.size(), e.d_tokens.size());
+    if (static_cast<double>(ntokens)
+        > MAX_DIFF * static_cast<double>(std::max(err.size(), e.d_err.size())))
+    {
+      continue;
+    }
+    if (error_diff(err, tokens, e.d_err, e.d_tokens) <= MAX_DIFF)
+    {
+      return &e.d_err;
+    }
+  }
+  return nullptr;
+}
+
+std::string
+ErrorIndex::fingerprint(const std::string& err)
+{
+  /* Matches the location of failed assertions, e.g.,
+   * 'murxla: file.cpp:42: void f(): Assertion `x' failed.',
+   * and of undefined behavior, e.g., 'file.cpp:42:7: runtime error: ...'. */
+  static const std::regex re_location(
+      "([^ :]+:[0-9]+)(:[0-9]+)?: (.*Assertion|runtime error)",
+      std::regex::optimize);
+
+  std::string kind, location;
+  std::vector<std::string> frames;
+
+  std::string_view s(err);
+  while (!s.empty())
+  {
+    size_t eol            = s.find('\n');
+    std::string_view line = s.substr(0, eol);
+    s.remove_prefix(eol == std::string_view::npos ? s.size() : eol + 1);
+
+    size_t begin = line.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) continue;
+    line.remove_prefix(begin);
+
+    /* Sanitizer reports, e.g., 'ERROR: AddressSanitizer: heap-use-after-free'
+     * followed by stack frames '#0 <address> in <function> <file>'. */
+    size_t pos = line.find("Sanitizer: ");
+    if (kind.empty() && pos != std::string_view::npos)
+    {
+      std::string_view k = line.substr(pos + 11);
+      kind               = k.substr(0, k.find(' '));
+    }
+    else if (line[0] == '#' && line.size() > 1 && is_digit(line[1]))
+    {
+      if (frames.size() < NUM_FINGERPRINT_FRAMES)
+      {
+        pos = line.find(" in ");
+        if (pos != std::string_view::npos)
+        {
+          std::string_view fun = line.substr(pos + 4);
+          frames.emplace_back(fun.substr(0, fun.find(' ')));
+        }
+      }
+    }
+    else if (location.empty() && line.size() <= MAX_LOCATION_LINE_LENGTH)
+    {
+      std::match_results<std::string_view::const_iterator> m;
+      if (std::regex_search(line.begin(), line.end(), m, re_location))
+      {
+        location = m[1].str();
+      }
+    }
+  }
+
+  if (!frames.empty())
+  {
+    std::string res = kind;
+    for (const auto& f : frames)
+    {
+      res += " " + f;
+    }
+    return res;
+  }
+  return location;
+}
+
+std::vector<uint64_t>
+ErrorIndex::get_keys(const std::string& err,
+                     const std::vector<std::string>& tokens)
+{
+  std::vector<uint64_t> keys;
+  size_t tag = 0;
+
+  /* The canonical form of the error message, numeric tokens are ignored
+   * by str_diff(). */
+  size_t canonical = tag++;
+  for (const auto& t : tokens)
+  {
+    hash_combine(canonical,
+                 std::all_of(t.begin(), t.end(), is_digit) ? std::string("#")
+                                                           : t);
+  }
+  keys.push_back(canonical);
+
+  /* The fingerprint of the error location. */
+  std::string fp = fingerprint(err);
+  size_t fp_key  = tag++;
+  if (!fp.empty())
+  {
+    hash_combine(fp_key, fp);
+    keys.push_back(fp_key);
+  }
+
+  /* The MinHash signature of the set of tokens, with digits removed. */
+  std::vector<uint64_t> signature(NUM_BANDS * NUM_ROWS,
+                                  std::numeric_limits<uint64_t>::max());
+  bool empty = true;
+  for (const auto& t : tokens)
+  {
+    std::string tok;
+    std::copy_if(t.begin(), t.end(), std::back_inserter(tok), [](char c) {
+      return !is_digit(c);
+    });
+    if (tok.empty()) continue;
+    empty      = false;
+    uint64_t h = std::hash<std::string>{}(tok);
+    for (size_t i = 0, n = signature.size(); i < n; ++i)
+    {
+      signature[i] = std::min(signature[i], mix(h + i * 0x9e3779b97f4a7c15));
+    }
+  }
+  if (!empty)
+  {
+    for (size_t b = 0; b < NUM_BANDS; ++b)
+    {
+      size_t band = tag++;
+      for (size_t r = 0; r < NUM_ROWS; ++r)
+      {
+        hash_combine(band, signature[b * NUM_ROWS + r]);
+      }
+      keys.push_back(band);
+    }
+  }
+  return keys;
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
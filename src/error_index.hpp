@@ -0,0 +1,97 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__ERROR_INDEX_H
+#define __MURXLA__ERROR_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Index of error messages for detecting duplicate errors.
+ *
+ * Two error messages are duplicates if they differ in at most MAX_DIFF of
+ * their characters, where messages are compared token-wise and numbers are
+ * ignored. Rather than comparing a given error message against all indexed
+ * messages, candidates are retrieved via hash keys of
+ *  - the canonical form of the message, which ignores numeric tokens,
+ *  - the fingerprint of the error location (see fingerprint()), and
+ *  - the bands of a MinHash signature of the set of tokens of the message,
+ *    which are likely to be shared by messages that differ in few tokens.
+ * Only the candidates are compared, hence the cost of a lookup does not
+ * depend on the number of indexed messages that are not similar to the given
+ * message.
+ */
+class ErrorIndex
+{
+ public:
+  /** Error messages that differ in at most this ratio are duplicates. */
+  static constexpr double MAX_DIFF = 0.05;
+
+  /**
+   * Add error message to the index.
+   * @param err  The error message.
+   */
+  void add(const std::string& err);
+
+  /**
+   * Find an indexed error message that is a duplicate of the given message.
+   * If there are multiple duplicates, the one that was added first is
+   * returned.
+   * @param err  The error message.
+   * @return  The duplicate error message, or nullptr if there is none.
+   */
+  const std::string* find(const std::string& err) const;
+
+  /**
+   * Get the fingerprint of the location of an error, i.e., the kind of error
+   * and the top-most stack frames of sanitizer reports, or the location of a
+   * failed assertion.
+   * @param err  The error message.
+   * @return  The fingerprint, or the empty string if the message does not
+   *          contain a known location format.
+   */
+  static std::string fingerprint(const std::string& err);
+
+ private:
+  /** The number of MinHash bands. */
+  static constexpr size_t NUM_BANDS = 12;
+  /** The number of MinHash values per band. */
+  static constexpr size_t NUM_ROWS = 3;
+
+  /** An indexed error message. */
+  struct Entry
+  {
+    /** The error message. */
+    std::string d_err;
+    /** The tokens of the error message. */
+    std::vector<std::string> d_tokens;
+  };
+
+  /** Compute the hash keys of the given error message. */
+  static std::vector<uint64_t> get_keys(const std::string& err,
+                                        const std::vector<std::string>& tokens);
+
+  /** The indexed error messages. */
+  std::vector<Entry> d_errors;
+  /** Map hash key to the indices of error messages in d_errors. */
+  std::unordered_map<uint64_t, std::vector<size_t>> d_buckets;
+};
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
+
+#endif
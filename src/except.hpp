@@ -363,6 +363,17 @@ class OstreamVoider
       ? (void) 0                                        \
       : OstreamVoider() & ExitStream(is_forked, EXIT_ERROR_UNTRACE).stream()
 
+/**
+ * Create an exit stream for test runs that exceed their time limit in the
+ * fork which exits with exit code EXIT_TIMEOUT if given condition is not true.
+ * Flag `is_forked` indicates if process is indeed forked.
+ * @param cond The condition to check.
+ * @param is_forked True if the process is forked.
+ */
+#define MURXLA_EXIT_TIMEOUT_FORK(cond, is_forked) \
+  !(cond) ? (void) 0                              \
+          : OstreamVoider() & ExitStream(is_forked, EXIT_TIMEOUT).stream()
+
 /**
  * Create an exception stream which throws a MurxlaException if given condition
  * is not true.
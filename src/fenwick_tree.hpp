@@ -0,0 +1,151 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__FENWICK_TREE_H
+#define __MURXLA__FENWICK_TREE_H
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Fenwick tree (binary indexed tree) over a sequence of non-negative values.
+ *
+ * Supports appending and removing values at the end, updating values and
+ * computing prefix sums in O(log n). Node i (1-based) of the tree stores the
+ * sum of the values in range (i - lsb(i), i], where lsb(i) is the least
+ * significant bit of i.
+ */
+template <typename T>
+class FenwickTree
+{
+ public:
+  /** @return  The number of values in the tree. */
+  size_t size() const { return d_nodes.size(); }
+
+  /** @return  True if the tree is empty. */
+  bool empty() const { return d_nodes.empty(); }
+
+  /** Remove all values. */
+  void clear() { d_nodes.clear(); }
+
+  /** Append value at the end. */
+  void push_back(T value)
+  {
+    size_t node = d_nodes.size() + 1;
+    d_nodes.push_back(value + prefix_sum(node - 1)
+                      - prefix_sum(node - range(node)));
+  }
+
+  /** Remove value at the end. */
+  void pop_back()
+  {
+    assert(!d_nodes.empty());
+    d_nodes.pop_back();
+  }
+
+  /** Add 'delta' to the value at index 'idx'. */
+  void add(size_t idx, T delta)
+  {
+    assert(idx < d_nodes.size());
+    for (size_t node = idx + 1; node <= d_nodes.size(); node += range(node))
+    {
+      d_nodes[node - 1] += delta;
+    }
+  }
+
+  /** Subtract 'delta' from the value at index 'idx'. */
+  void sub(size_t idx, T delta)
+  {
+    assert(idx < d_nodes.size());
+    for (size_t node = idx + 1; node <= d_nodes.size(); node += range(node))
+    {
+      assert(d_nodes[node - 1] >= delta);
+      d_nodes[node - 1] -= delta;
+    }
+  }
+
+  /** @return  The sum of the first 'n' values. */
+  T prefix_sum(size_t n) const
+  {
+    assert(n <= d_nodes.size());
+    T res = 0;
+    for (size_t node = n; node > 0; node -= range(node))
+    {
+      res += d_nodes[node - 1];
+    }
+    return res;
+  }
+
+  /** @return  The sum of all values. */
+  T sum() const { return prefix_sum(d_nodes.size()); }
+
+  /**
+   * Get the sum stored at given node.
+   * @param node  The (1-based) node index.
+   * @return  The sum of the values in range (node - range(node), node].
+   */
+  T node(size_t node) const
+  {
+    assert(node > 0 && node <= d_nodes.size());
+    return d_nodes[node - 1];
+  }
+
+  /** @return  The number of values covered by given (1-based) node. */
+  static size_t range(size_t node) { return node & (~node + 1); }
+
+  /**
+   * Search the index of the element where the prefix sum of a sequence of n
+   * non-negative weights exceeds 'value'.
+   *
+   * The weights are given implicitly via function 'node_weight', which maps a
+   * (1-based) node index to the sum of the weights covered by that node. This
+   * allows to search over weights that are derived from the nodes of one or
+   * more Fenwick trees of size n.
+   *
+   * @param n            The number of weights.
+   * @param value        The value to search for, must be less than the sum
+   *                     of all weights.
+   * @param node_weight  The function that maps a node to its weight.
+   * @return  The smallest index i such that the sum of weights 0 to i is
+   *          greater than 'value'.
+   */
+  template <typename W, typename F>
+  static size_t search(size_t n, W value, F node_weight)
+  {
+    size_t pos = 0, step = 1;
+    while (step * 2 <= n) step *= 2;
+    for (; step > 0; step /= 2)
+    {
+      if (pos + step > n) continue;
+      W w = node_weight(pos + step);
+      if (w <= value)
+      {
+        pos += step;
+        value -= w;
+      }
+    }
+    assert(pos < n);
+    return pos;
+  }
+
+ private:
+  /** The nodes of the tree. */
+  std::vector<T> d_nodes;
+};
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
+
+#endif
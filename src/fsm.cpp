@@ -11,12 +11,15 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <numeric>
+#include <optional>
 #include <sstream>
 #include <unordered_set>
 
+#include "binary_trace.hpp"
 #include "solver_manager.hpp"
 
 namespace murxla {
@@ -37,6 +40,7 @@ State::add_action(Action* a, uint32_t priority, State* next)
       << "transition into choice state must be from decision state";
   d_actions.emplace_back(ActionTuple(a, next == nullptr ? this : next));
   d_weights.push_back(priority);
+  d_weights_changed = true;
 }
 
 void
@@ -46,7 +50,8 @@ State::disable_action(Action::Kind kind)
   {
     if (d_actions[i].d_action->get_kind() == kind)
     {
-      d_weights[i] = 0;
+      d_weights[i]      = 0;
+      d_weights_changed = true;
     }
   }
 }
@@ -56,7 +61,15 @@ State::run(RNGenerator& rng)
 {
   MURXLA_CHECK_CONFIG(!d_actions.empty()) << "no actions configured";
 
-  uint32_t idx      = rng.pick_weighted<uint32_t>(d_weights);
+  /* Picking from the cached distribution consumes the same random numbers as
+   * RNGenerator::pick_weighted(), i.e., runs are reproducible either way. */
+  if (d_weights_changed)
+  {
+    d_sampler = std::discrete_distribution<uint32_t>(d_weights.begin(),
+                                                     d_weights.end());
+    d_weights_changed = false;
+  }
+  uint32_t idx      = d_sampler(rng.get_engine());
   ActionTuple& atup = d_actions[idx];
 
   /* record state statistics */
@@ -69,7 +82,11 @@ State::run(RNGenerator& rng)
 
   /* run action */
   atup.d_action->seed_solver_rng();
-  if (atup.d_action->generate()
+  uint64_t start = statistics::get_time_ns();
+  bool success   = atup.d_action->generate();
+  d_mbt_stats->add_action_latency(atup.d_action->get_id(),
+                                  statistics::get_time_ns() - start);
+  if (success
       && (atup.d_next->f_precond == nullptr || atup.d_next->f_precond()))
   {
     /* record action statistics */
@@ -84,7 +101,8 @@ State::run(RNGenerator& rng)
    * conditions in the current run. */
   else if (atup.d_action->disabled())
   {
-    d_weights[idx] = 0;
+    d_weights[idx]    = 0;
+    d_weights_changed = true;
   }
 
   return this;
@@ -535,7 +553,12 @@ FSM::configure()
     d_smgr.get_solver().configure_fsm(this);
     if (d_fuzz_options)
     {
-      d_smgr.get_solver().configure_options(&d_smgr);
+      /* Solver options are usually already configured by the parent process
+       * (see Murxla::preinitialize()). */
+      if (d_smgr.solver_options().empty())
+      {
+        d_smgr.get_solver().configure_options(&d_smgr);
+      }
       d_smgr.filter_solver_options(d_fuzz_options_filter);
     }
   }
@@ -548,7 +571,7 @@ FSM::configure()
   {
     Action* action                                  = std::get<0>(t);
     uint32_t priority                               = std::get<1>(t);
-    std::unordered_set<std::string> excluded_states = std::get<2>(t);
+    std::unordered_set<State::Kind> excluded_states = std::get<2>(t);
     State* next                                     = std::get<3>(t);
     for (const auto& s : d_states)
     {
@@ -574,7 +597,7 @@ FSM::configure()
     Action* action                                  = std::get<0>(t);
     uint32_t priority                               = std::get<1>(t);
     State* state                                    = std::get<2>(t);
-    std::unordered_set<std::string> excluded_states = std::get<3>(t);
+    std::unordered_set<State::Kind> excluded_states = std::get<3>(t);
     for (const auto& s : d_states)
     {
       if (s->d_ignore) continue;
@@ -606,7 +629,57 @@ FSM::configure()
       if (w == 0) continue;
       w = sum / w;
     }
+    s->d_weights_changed = true;
   }
+
+  /* Scale weights with coverage feedback. */
+  const coverage::Feedback* feedback = d_smgr.get_coverage_feedback();
+  if (feedback)
+  {
+    for (const auto& s : d_states)
+    {
+      for (size_t i = 0, n = s->d_weights.size(); i < n; ++i)
+      {
+        uint32_t& w = s->d_weights[i];
+        if (w == 0) continue;
+        double factor =
+            feedback->get_action_factor(s->d_actions[i].d_action->get_id());
+        w = std::max(1u, static_cast<uint32_t>(std::lround(w * factor)));
+      }
+    }
+  }
+
+  /* Scale weights with configured (or adapted) weight factors. */
+  if (!d_action_weight_factors.empty())
+  {
+    for (const auto& s : d_states)
+    {
+      for (size_t i = 0, n = s->d_weights.size(); i < n; ++i)
+      {
+        uint32_t& w = s->d_weights[i];
+        if (w == 0) continue;
+        auto it = d_action_weight_factors.find(
+            s->d_actions[i].d_action->get_kind().str());
+        if (it == d_action_weight_factors.end()) continue;
+        double factor = static_cast<double>(it->second) / 100;
+        w = std::max(1u, static_cast<uint32_t>(std::lround(w * factor)));
+      }
+    }
+  }
+}
+
+void
+FSM::set_coverage_feedback(const coverage::Feedback* feedback)
+{
+  d_smgr.set_coverage_feedback(feedback);
+}
+
+void
+FSM::set_weight_factors(const adaptive::WeightMap& actions,
+                        const adaptive::WeightMap& ops)
+{
+  d_action_weight_factors = actions;
+  d_smgr.set_op_weight_factors(ops);
 }
 
 void
@@ -667,57 +740,106 @@ FSM::print() const
 /* ========================================================================== */
 
 void
-FSM::untrace(const std::string& trace_file_name)
+FSM::untrace(const std::string& trace_file_name,
+             const UntraceCheckpoint& checkpoint)
 {
   assert(!trace_file_name.empty());
 
-  uint32_t nline   = 0;
   std::vector<uint64_t> ret_val;
   Action* ret_action;
-  std::string line;
-  std::ifstream trace;
+  TraceLine line, next_line;
   bool sng_untrace_mode = d_smgr.get_sng().is_untrace_mode();
+  /* Maps the string table indices of action kinds in binary traces to the
+   * corresponding action. */
+  std::vector<Action*> actions_by_index;
 
   /* Set mode to untracing. We keep the untraced solver seeds when untracing
    * and do not generate new solver seeds. */
   d_smgr.get_sng().set_untrace_mode(true);
 
-  trace.open(trace_file_name);
-  MURXLA_CHECK_CONFIG(trace.is_open())
-      << "untrace: unable to open file '" << trace_file_name << "'";
+  std::string file_name              = trace_file_name;
+  std::unique_ptr<TraceReader> trace = TraceReader::open(file_name);
+  MURXLA_CHECK_CONFIG(trace != nullptr)
+      << "untrace: unable to open file '" << file_name << "'";
 
   try
   {
-    while (std::getline(trace, line))
+    while (true)
     {
-      nline += 1;
-      if (line.empty()) continue;
-      if (line[0] == '#') continue;
-      if (line.rfind("set-murxla-options", 0) == 0) continue;
+      /* Continue with the trace file given by the checkpoint callback, which
+       * shares the lines replayed so far with the current trace file. */
+      std::string next_file_name;
+      if (checkpoint)
+      {
+        next_file_name = checkpoint(trace->line_number());
+      }
+      if (!next_file_name.empty())
+      {
+        uint32_t nlines = trace->line_number();
+        file_name       = next_file_name;
+        trace           = TraceReader::open(file_name);
+        MURXLA_CHECK_CONFIG(trace != nullptr)
+            << "untrace: unable to open file '" << file_name << "'";
+        actions_by_index.clear();
+
+        std::string skipped;
+        bool newline;
+        while (trace->line_number() < nlines)
+        {
+          if (!trace->next_text(skipped, newline))
+          {
+            throw MurxlaUntraceException(file_name,
+                                         trace->line_number(),
+                                         "unexpected end of trace");
+          }
+        }
+      }
+
+      if (!trace->next(line)) break;
+      if (line.d_ignore) continue;
 
-      const auto& [seed, id, tokens] = tokenize(line);
-      d_smgr.get_sng().set_seed(seed);
+      const std::string& id                  = line.d_id;
+      const std::vector<std::string>& tokens = line.d_tokens;
+      d_smgr.get_sng().set_seed(line.d_seed);
 
       if (id == "return")
       {
         throw MurxlaUntraceException(
-            trace_file_name, nline, "stray 'return' statement");
+            file_name, trace->line_number(), "stray 'return' statement");
       }
       else
       {
-        if (d_actions.find(id) == d_actions.end())
+        /* Action kinds of binary traces are only looked up once. */
+        Action* action = nullptr;
+        size_t id_index = static_cast<size_t>(line.d_id_index);
+        if (line.d_id_index >= 0)
         {
-          std::stringstream ss;
-          ss << "unknown action '" << id << "'";
-          throw MurxlaUntraceException(trace_file_name, nline, ss);
+          if (id_index >= actions_by_index.size())
+          {
+            actions_by_index.resize(id_index + 1, nullptr);
+          }
+          action = actions_by_index[id_index];
+        }
+        if (!action)
+        {
+          std::optional<uint32_t> kind_id = Action::Kind::find(id);
+          if (!kind_id || *kind_id >= d_actions.size() || !d_actions[*kind_id])
+          {
+            std::stringstream ss;
+            ss << "unknown action '" << id << "'";
+            throw MurxlaUntraceException(file_name, trace->line_number(), ss);
+          }
+          action = d_actions[*kind_id].get();
+          if (line.d_id_index >= 0)
+          {
+            actions_by_index[id_index] = action;
+          }
         }
-
-        Action* action = d_actions.at(id).get();
         if (!d_smgr.get_solver().is_initialized()
             && action->get_kind() != ActionNew::s_name)
         {
-          throw MurxlaUntraceException(trace_file_name,
-                                       nline,
+          throw MurxlaUntraceException(file_name,
+                                       trace->line_number(),
                                        "solver not initialized, are you "
                                        "missing an action 'new' trace line?");
         }
@@ -728,7 +850,7 @@ FSM::untrace(const std::string& trace_file_name)
           if (!ret_val.empty())
           {
             throw MurxlaUntraceException(
-                trace_file_name, nline, "unexpected return value");
+                file_name, trace->line_number(), "unexpected return value");
           }
         }
         else
@@ -740,21 +862,22 @@ FSM::untrace(const std::string& trace_file_name)
           }
           catch (MurxlaActionUntraceException& e)
           {
-            throw MurxlaUntraceException(trace_file_name, nline, e.get_msg());
+            throw MurxlaUntraceException(
+                file_name, trace->line_number(), e.get_msg());
           }
 
-          if (std::getline(trace, line))
+          if (trace->next(next_line))
           {
-            nline += 1;
-
-            const auto& [seed, next_id, next_tokens] = tokenize(line);
-            size_t next_tokens_size                  = next_tokens.size();
-            d_smgr.get_sng().set_seed(seed);
+            const std::string& next_id                  = next_line.d_id;
+            const std::vector<std::string>& next_tokens = next_line.d_tokens;
+            size_t next_tokens_size                     = next_tokens.size();
+            d_smgr.get_sng().set_seed(next_line.d_seed);
 
             if (next_id != "return")
             {
-              throw MurxlaUntraceException(
-                  trace_file_name, nline, "expected 'return' statement");
+              throw MurxlaUntraceException(file_name,
+                                           trace->line_number(),
+                                           "expected 'return' statement");
             }
 
             if (action->returns() == Action::ReturnValue::ID)
@@ -765,16 +888,16 @@ FSM::untrace(const std::string& trace_file_name)
                 if (next_tokens_size != 2)
                 {
                   throw MurxlaUntraceException(
-                      trace_file_name,
-                      nline,
+                      file_name,
+                      trace->line_number(),
                       "expected two arguments (term, sort) to 'return'");
                 }
               }
               else if (next_tokens_size != 1)
               {
                 throw MurxlaUntraceException(
-                    trace_file_name,
-                    nline,
+                    file_name,
+                    trace->line_number(),
                     "expected single argument to 'return'");
               }
             }
@@ -782,8 +905,8 @@ FSM::untrace(const std::string& trace_file_name)
                      && next_tokens_size < 1)
             {
               throw MurxlaUntraceException(
-                  trace_file_name,
-                  nline,
+                  file_name,
+                  trace->line_number(),
                   "expected at least one argument to 'return'");
             }
 
@@ -792,7 +915,8 @@ FSM::untrace(const std::string& trace_file_name)
               std::stringstream ss;
               ss << next_tokens_size << " arguments given but expected "
                  << ret_val.size();
-              throw MurxlaUntraceException(trace_file_name, nline, ss.str());
+              throw MurxlaUntraceException(
+                  file_name, trace->line_number(), ss.str());
             }
 
             for (uint32_t i = 0; i < next_tokens_size; ++i)
@@ -803,8 +927,8 @@ FSM::untrace(const std::string& trace_file_name)
                 if (!d_smgr.register_sort(rid, ret_val[i]))
                 {
                   throw MurxlaUntraceException(
-                      trace_file_name,
-                      nline,
+                      file_name,
+                      trace->line_number(),
                       "unknown sort id '" + next_tokens[i] + "'");
                 }
               }
@@ -813,7 +937,7 @@ FSM::untrace(const std::string& trace_file_name)
                 if (next_tokens[i][0] != 't')
                 {
                   throw MurxlaUntraceException(
-                      trace_file_name, nline, "expected term id");
+                      file_name, trace->line_number(), "expected term id");
                 }
                 d_smgr.register_term(rid, ret_val[i]);
               }
@@ -826,9 +950,8 @@ FSM::untrace(const std::string& trace_file_name)
   }
   catch (MurxlaUntraceIdException& e)
   {
-    throw MurxlaUntraceException(trace_file_name, nline, e.get_msg());
+    throw MurxlaUntraceException(file_name, trace->line_number(), e.get_msg());
   }
-  if (trace.is_open()) trace.close();
 
   /* reset to previous mode */
   d_smgr.get_sng().set_untrace_mode(sng_untrace_mode);
@@ -15,12 +15,15 @@
 #include <fstream>
 #include <functional>
 #include <memory>
+#include <random>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "action.hpp"
+#include "adaptive_weights.hpp"
 #include "config.hpp"
+#include "coverage.hpp"
 #include "except.hpp"
 #include "solver_manager.hpp"
 #include "solver_option.hpp"
@@ -82,10 +85,10 @@ class State
    *
    * This is used a state identifier when retrieving states that have been
    * added to the FSM via FSM::get_state().
-   * We use strings here to make the set of state kinds easily extensible
-   * with solver-specific states.
+   * Kinds are identified by strings to make the set of state kinds easily
+   * extensible with solver-specific states (see InternedKind).
    */
-  using Kind = std::string;
+  using Kind = InternedKind<State>;
 
   /** The undefined state. */
   inline static const Kind UNDEFINED = "undefined";
@@ -284,7 +287,7 @@ class State
 
  private:
   /** State kind. */
-  const Kind& d_kind;
+  Kind d_kind;
 
   /** The configuration of this state. */
   ConfigKind d_config = REGULAR;
@@ -308,6 +311,14 @@ class State
   std::vector<ActionTuple> d_actions;
   /** The weights of the actions associated with this state. */
   std::vector<uint32_t> d_weights;
+  /**
+   * The distribution over d_weights to pick the next transition from.
+   * Cached since the weights only change on configuration or when actions get
+   * disabled, and rebuilt on demand if d_weights_changed is true.
+   */
+  std::discrete_distribution<uint32_t> d_sampler;
+  /** True if d_weights changed since d_sampler was built. */
+  bool d_weights_changed = true;
 
   /** The associated statistics object. */
   statistics::Statistics* d_mbt_stats;
@@ -382,6 +393,15 @@ class State
 class FSM
 {
  public:
+  /**
+   * Callback that is called by untrace() before each trace statement with
+   * the number of trace lines replayed so far. Returns the name of the trace
+   * file to continue with, or the empty string to continue with the current
+   * trace file. The lines of the returned trace file up to the current line
+   * must be identical to the replayed lines.
+   */
+  using UntraceCheckpoint = std::function<std::string(uint32_t)>;
+
   /** Constructor. */
   FSM(RNGenerator& rng,
       SolverSeedGenerator& sng,
@@ -464,7 +484,7 @@ class FSM
    * @param fun   The precondition for transitioning into the state.
    * @return  The created decision state.
    */
-  State* new_decision_state(const std::string& kind,
+  State* new_decision_state(const State::Kind& kind,
                             std::function<bool(void)> fun = nullptr);
 
   /**
@@ -485,7 +505,7 @@ class FSM
    * @param is_final True if state is a final state.
    * @return  The created choice state.
    */
-  State* new_choice_state(const std::string& kind,
+  State* new_choice_state(const State::Kind& kind,
                           std::function<bool(void)> fun = nullptr,
                           bool is_final                 = false);
   /**
@@ -501,7 +521,7 @@ class FSM
    * @param fun   The precondition for transitioning into the state.
    * @return  The created choice state.
    */
-  State* new_final_state(const std::string& kind,
+  State* new_final_state(const State::Kind& kind,
                          std::function<bool(void)> fun = nullptr);
 
   /** Create new action of given type T. */
@@ -535,7 +555,7 @@ class FSM
   void add_action_to_all_states(
       T* action,
       uint32_t priority,
-      const std::unordered_set<std::string>& excluded_states = {},
+      const std::unordered_set<State::Kind>& excluded_states = {},
       State* next                                            = nullptr);
 
   /**
@@ -563,7 +583,7 @@ class FSM
       T* action,
       uint32_t priority,
       State* state,
-      const std::unordered_set<std::string>& excluded_states = {});
+      const std::unordered_set<State::Kind>& excluded_states = {});
 
   /** Set given state as initial state. */
   void set_init_state(State* init_state);
@@ -575,8 +595,28 @@ class FSM
   void run();
   /** Configure state machine with base configuration. */
   void configure();
-  /** Replay given trace. */
-  void untrace(const std::string& trace_file_name);
+  /**
+   * Set the coverage feedback to scale the weights of actions and operators
+   * with. Must be called before configure().
+   * @param feedback  The coverage feedback, nullptr to disable.
+   */
+  void set_coverage_feedback(const coverage::Feedback* feedback);
+  /**
+   * Set the factors to scale the weights of actions and operators with.
+   * Must be called before configure().
+   * @param actions  The weight factors of actions in percent, by kind.
+   * @param ops      The weight factors of operators in percent, by kind.
+   */
+  void set_weight_factors(const adaptive::WeightMap& actions,
+                          const adaptive::WeightMap& ops);
+  /**
+   * Replay given trace.
+   * @param trace_file_name  The trace file to replay.
+   * @param checkpoint       The callback to call before each trace
+   *                         statement, see UntraceCheckpoint.
+   */
+  void untrace(const std::string& trace_file_name,
+               const UntraceCheckpoint& checkpoint = nullptr);
 
   /** Print the current configuration of this FSM to stdout. */
   void print() const;
@@ -588,8 +628,13 @@ class FSM
   RNGenerator& d_rng;
   /** The set of configured states. */
   std::vector<std::unique_ptr<State>> d_states;
-  /** The set of configured actions. */
-  std::unordered_map<Action::Kind, std::unique_ptr<Action>> d_actions;
+  /**
+   * The set of configured actions, indexed by the id of their kind (see
+   * InternedKind::get_id()).
+   */
+  std::vector<std::unique_ptr<Action>> d_actions;
+  /** The number of configured actions. */
+  uint64_t d_num_actions = 0;
 
   /**
    * A temporary list with actions (incl. priorities, the next state and
@@ -614,9 +659,12 @@ class FSM
    * The state kinds always to exclude when adding actions to all states
    * (add_action_to_all_states) or when adding all aconfigured states to an
    * action/transition (add_action_to_all_states_next). */
-  std::unordered_set<std::string> d_actions_all_states_excluded = {
+  std::unordered_set<State::Kind> d_actions_all_states_excluded = {
       State::NEW, State::DELETE, State::OPT, State::OPT_REQ, State::SET_LOGIC};
 
+  /** The factors (in percent) to scale the weights of actions with. */
+  adaptive::WeightMap d_action_weight_factors;
+
   /** The initial state. */
   State* d_state_init = nullptr;
   /** The current state. */
@@ -647,9 +695,14 @@ FSM::new_action()
   T* action               = new T(d_smgr);
   const Action::Kind& kind = action->get_kind();
   assert(kind.size() <= MURXLA_MAX_KIND_LEN);
-  if (d_actions.find(kind) == d_actions.end())
+  uint32_t kind_id = kind.get_id();
+  if (kind_id >= d_actions.size())
+  {
+    d_actions.resize(kind_id + 1);
+  }
+  if (!d_actions[kind_id])
   {
-    uint64_t id = d_actions.size();
+    uint64_t id = d_num_actions;
     if (id >= MURXLA_MAX_N_ACTIONS)
     {
       delete action;
@@ -658,14 +711,15 @@ FSM::new_action()
           "value of macro MURXLA_MAX_N_ACTIONS in config.hpp");
     }
     action->set_id(id);
-    d_actions[kind].reset(action);
+    d_actions[kind_id].reset(action);
+    d_num_actions += 1;
     strncpy(d_mbt_stats->d_action_kinds[id], kind.c_str(), kind.size());
   }
   else
   {
     delete action;
   }
-  return static_cast<T*>(d_actions[kind].get());
+  return static_cast<T*>(d_actions[kind_id].get());
 }
 
 template <class T>
@@ -0,0 +1,290 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__INDEXED_SET_H
+#define __MURXLA__INDEXED_SET_H
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * A set that stores its elements densely in a vector, with a hash map from
+ * element to index for lookups.
+ *
+ * In contrast to std::unordered_set, iterators are random access, which allows
+ * to pick a random element in O(1) (see RNGenerator::pick_from_set()).
+ * Elements are removed by moving the last element into the gap, hence removal
+ * is O(1), too. Iteration order is the insertion order modulo removals and
+ * does not depend on the hash values of the elements, which keeps random
+ * picks deterministic for a given seed.
+ */
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
+class IndexedSet
+{
+ public:
+  using value_type     = T;
+  using size_type      = size_t;
+  using iterator       = typename std::vector<T>::const_iterator;
+  using const_iterator = iterator;
+
+  IndexedSet() = default;
+  /** Construct set from the elements in range [first, last). */
+  template <class Iterator>
+  IndexedSet(Iterator first, Iterator last)
+  {
+    for (; first != last; ++first) insert(*first);
+  }
+
+  iterator begin() const { return d_elements.cbegin(); }
+  iterator end() const { return d_elements.cend(); }
+
+  /** @return  The number of elements. */
+  size_t size() const { return d_elements.size(); }
+  /** @return  True if the set is empty. */
+  bool empty() const { return d_elements.empty(); }
+  /** Remove all elements. */
+  void clear()
+  {
+    d_elements.clear();
+    d_idx.clear();
+  }
+
+  /** @return  The element at index 'idx' with 0 <= idx < size(). */
+  const T& operator[](size_t idx) const
+  {
+    assert(idx < d_elements.size());
+    return d_elements[idx];
+  }
+
+  /** @return  The iterator to given element, end() if not in the set. */
+  iterator find(const T& element) const
+  {
+    auto it = d_idx.find(element);
+    if (it == d_idx.end()) return end();
+    return begin() + it->second;
+  }
+  /** @return  1 if given element is in the set, else 0. */
+  size_t count(const T& element) const { return d_idx.count(element); }
+
+  /**
+   * Insert element.
+   * @return  The iterator to the element in the set and true if it was
+   *          inserted, false if an equal element was already in the set.
+   */
+  std::pair<iterator, bool> insert(const T& element)
+  {
+    auto [it, inserted] = d_idx.emplace(element, d_elements.size());
+    if (inserted) d_elements.push_back(element);
+    return {begin() + it->second, inserted};
+  }
+
+  /**
+   * Remove element at given position.
+   * @return  The iterator to the element that took its place (the previously
+   *          last element), end() if it was the last element.
+   */
+  iterator erase(iterator pos)
+  {
+    size_t idx = pos - begin();
+    erase_at(idx);
+    return begin() + idx;
+  }
+  /**
+   * Remove element.
+   * @return  The number of removed elements (0 or 1).
+   */
+  size_t erase(const T& element)
+  {
+    auto it = d_idx.find(element);
+    if (it == d_idx.end()) return 0;
+    erase_at(it->second);
+    return 1;
+  }
+
+ private:
+  /** Remove the element at index 'idx'. */
+  void erase_at(size_t idx)
+  {
+    assert(idx < d_elements.size());
+    d_idx.erase(d_elements[idx]);
+    if (idx + 1 < d_elements.size())
+    {
+      d_elements[idx]           = std::move(d_elements.back());
+      d_idx.at(d_elements[idx]) = idx;
+    }
+    d_elements.pop_back();
+  }
+
+  /** The elements. */
+  std::vector<T> d_elements;
+  /** Maps element to its index in d_elements. */
+  std::unordered_map<T, size_t, Hash, KeyEqual> d_idx;
+};
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * A map that stores its entries densely in a vector, with a hash map from key
+ * to index for lookups. See IndexedSet.
+ *
+ * Entries are std::pair<Key, Value>, the key of an entry must not be modified
+ * via an iterator. References to values are invalidated on insertion and
+ * removal.
+ */
+template <class Key,
+          class Value,
+          class Hash     = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+class IndexedMap
+{
+ public:
+  using key_type       = Key;
+  using mapped_type    = Value;
+  using value_type     = std::pair<Key, Value>;
+  using size_type      = size_t;
+  using iterator       = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  iterator begin() { return d_entries.begin(); }
+  iterator end() { return d_entries.end(); }
+  const_iterator begin() const { return d_entries.cbegin(); }
+  const_iterator end() const { return d_entries.cend(); }
+
+  /** @return  The number of entries. */
+  size_t size() const { return d_entries.size(); }
+  /** @return  True if the map is empty. */
+  bool empty() const { return d_entries.empty(); }
+  /** Remove all entries. */
+  void clear()
+  {
+    d_entries.clear();
+    d_idx.clear();
+  }
+
+  /** @return  The iterator to the entry of given key, end() if none. */
+  iterator find(const Key& key)
+  {
+    auto it = d_idx.find(key);
+    if (it == d_idx.end()) return end();
+    return begin() + it->second;
+  }
+  /** @return  The iterator to the entry of given key, end() if none. */
+  const_iterator find(const Key& key) const
+  {
+    auto it = d_idx.find(key);
+    if (it == d_idx.end()) return end();
+    return begin() + it->second;
+  }
+  /** @return  1 if the map contains an entry for given key, else 0. */
+  size_t count(const Key& key) const { return d_idx.count(key); }
+
+  /**
+   * @return  The value of given key.
+   * @throws std::out_of_range if the map has no entry for the key.
+   */
+  Value& at(const Key& key)
+  {
+    auto it = d_idx.find(key);
+    if (it == d_idx.end()) throw std::out_of_range("IndexedMap::at");
+    return d_entries[it->second].second;
+  }
+  /**
+   * @return  The value of given key.
+   * @throws std::out_of_range if the map has no entry for the key.
+   */
+  const Value& at(const Key& key) const
+  {
+    auto it = d_idx.find(key);
+    if (it == d_idx.end()) throw std::out_of_range("IndexedMap::at");
+    return d_entries[it->second].second;
+  }
+
+  /**
+   * @return  The value of given key, a default constructed value is inserted
+   *          if the map has no entry for the key.
+   */
+  Value& operator[](const Key& key) { return emplace(key).first->second; }
+
+  /**
+   * Insert an entry for given key with a value constructed from given
+   * arguments if the map has no entry for the key.
+   * @return  The iterator to the entry of the key and true if it was inserted.
+   */
+  template <class... Args>
+  std::pair<iterator, bool> emplace(const Key& key, Args&&... args)
+  {
+    auto [it, inserted] = d_idx.emplace(key, d_entries.size());
+    if (inserted)
+    {
+      d_entries.emplace_back(
+          std::piecewise_construct,
+          std::forward_as_tuple(key),
+          std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    return {begin() + it->second, inserted};
+  }
+
+  /**
+   * Remove entry at given position.
+   * @return  The iterator to the entry that took its place (the previously
+   *          last entry), end() if it was the last entry.
+   */
+  iterator erase(iterator pos)
+  {
+    size_t idx = pos - begin();
+    erase_at(idx);
+    return begin() + idx;
+  }
+  /**
+   * Remove entry of given key.
+   * @return  The number of removed entries (0 or 1).
+   */
+  size_t erase(const Key& key)
+  {
+    auto it = d_idx.find(key);
+    if (it == d_idx.end()) return 0;
+    erase_at(it->second);
+    return 1;
+  }
+
+ private:
+  /** Remove the entry at index 'idx'. */
+  void erase_at(size_t idx)
+  {
+    assert(idx < d_entries.size());
+    d_idx.erase(d_entries[idx].first);
+    if (idx + 1 < d_entries.size())
+    {
+      d_entries[idx]                 = std::move(d_entries.back());
+      d_idx.at(d_entries[idx].first) = idx;
+    }
+    d_entries.pop_back();
+  }
+
+  /** The entries. */
+  std::vector<value_type> d_entries;
+  /** Maps key to the index of its entry in d_entries. */
+  std::unordered_map<Key, size_t, Hash, KeyEqual> d_idx;
+};
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
+
+#endif
@@ -0,0 +1,187 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__INTERNED_KIND_H
+#define __MURXLA__INTERNED_KIND_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * A kind identified by a string that is interned on construction, i.e.,
+ * mapped to a unique id. Ids are dense and assigned in the order kinds are
+ * first created, separately for each tag.
+ *
+ * Kinds are hashed and compared via their id, which allows to index tables by
+ * kind via get_id(). The string is only required for tracing and printing.
+ * Since kinds are interned on construction, the set of kinds remains
+ * extensible with solver-specific kinds, which are usually defined as static
+ * constants. Strings that do not necessarily identify a kind (e.g., when
+ * parsing traces) are looked up via find(), which does not intern them.
+ *
+ * @tparam Tag  The tag that distinguishes different kinds of kinds, e.g.,
+ *              operator kinds from action kinds.
+ */
+template <class Tag>
+class InternedKind
+{
+ public:
+  /** Constructor, creates the kind identified by the empty string. */
+  InternedKind() : InternedKind(std::string()) {}
+  /**
+   * Constructor.
+   * @param str  The string identifying the kind.
+   */
+  InternedKind(const char* str) : InternedKind(std::string(str)) {}
+  /**
+   * Constructor.
+   * @param str  The string identifying the kind.
+   */
+  InternedKind(const std::string& str)
+  {
+    Table& table = get_table();
+    std::lock_guard<std::mutex> lock(table.d_mutex);
+    auto [it, inserted] =
+        table.d_ids.emplace(str, static_cast<uint32_t>(table.d_ids.size()));
+    d_id  = it->second;
+    d_str = &it->first;
+  }
+
+  /**
+   * Look up the kind identified by given string without interning it, e.g.,
+   * for strings read from user-supplied traces, which may not identify any
+   * kind.
+   * @param str  The string identifying the kind.
+   * @return  The id of the kind, std::nullopt if no such kind was created.
+   */
+  static std::optional<uint32_t> find(const std::string& str)
+  {
+    Table& table = get_table();
+    std::lock_guard<std::mutex> lock(table.d_mutex);
+    auto it = table.d_ids.find(str);
+    if (it == table.d_ids.end()) return std::nullopt;
+    return it->second;
+  }
+
+  /**
+   * Get the number of kinds created so far, i.e., an upper bound for the ids
+   * of all kinds created so far.
+   * @return  The number of kinds.
+   */
+  static size_t get_num_kinds()
+  {
+    Table& table = get_table();
+    std::lock_guard<std::mutex> lock(table.d_mutex);
+    return table.d_ids.size();
+  }
+
+  /** @return  The id of this kind. */
+  uint32_t get_id() const { return d_id; }
+  /** @return  The string identifying this kind. */
+  const std::string& str() const { return *d_str; }
+  operator const std::string&() const { return *d_str; }
+  const char* c_str() const { return d_str->c_str(); }
+  size_t size() const { return d_str->size(); }
+  bool empty() const { return d_str->empty(); }
+
+  friend bool operator==(const InternedKind& a, const InternedKind& b)
+  {
+    return a.d_id == b.d_id;
+  }
+  friend bool operator!=(const InternedKind& a, const InternedKind& b)
+  {
+    return a.d_id != b.d_id;
+  }
+  friend bool operator==(const InternedKind& a, const std::string& b)
+  {
+    return *a.d_str == b;
+  }
+  friend bool operator!=(const InternedKind& a, const std::string& b)
+  {
+    return *a.d_str != b;
+  }
+  friend bool operator==(const std::string& a, const InternedKind& b)
+  {
+    return a == *b.d_str;
+  }
+  friend bool operator!=(const std::string& a, const InternedKind& b)
+  {
+    return a != *b.d_str;
+  }
+  friend bool operator==(const InternedKind& a, const char* b)
+  {
+    return *a.d_str == b;
+  }
+  friend bool operator!=(const InternedKind& a, const char* b)
+  {
+    return *a.d_str != b;
+  }
+  /** Kinds are ordered by their strings (for ordered containers). */
+  friend bool operator<(const InternedKind& a, const InternedKind& b)
+  {
+    return *a.d_str < *b.d_str;
+  }
+  friend std::ostream& operator<<(std::ostream& out, const InternedKind& kind)
+  {
+    return out << *kind.d_str;
+  }
+
+ private:
+  /** The table of interned kinds. */
+  struct Table
+  {
+    /** Kinds may be created concurrently by multiple threads. */
+    std::mutex d_mutex;
+    /**
+     * Map string to id. The strings of the kinds are the keys of this map,
+     * which are not invalidated by inserting new keys.
+     */
+    std::unordered_map<std::string, uint32_t> d_ids;
+  };
+
+  /** @return  The table of interned kinds of this tag. */
+  static Table& get_table()
+  {
+    static Table table;
+    return table;
+  }
+
+  /** The id of this kind. */
+  uint32_t d_id;
+  /** The string identifying this kind. */
+  const std::string* d_str;
+};
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
+
+namespace std {
+
+template <class Tag>
+struct hash<murxla::InternedKind<Tag>>
+{
+  size_t operator()(const murxla::InternedKind<Tag>& kind) const
+  {
+    return kind.get_id();
+  }
+};
+
+}  // namespace std
+
+#endif
@@ -23,6 +23,8 @@
 #include <iostream>
 #include <sstream>
 
+#include "binary_trace.hpp"
+#include "coverage.hpp"
 #include "dd.hpp"
 #include "except.hpp"
 #include "exit.hpp"
@@ -192,12 +194,20 @@ set_sigint_handler_stats(void)
   "  -l, --smt-lib              generate SMT-LIB compliant traces only\n"      \
   "  -y, --random-symbols       use random symbol names\n"                     \
   "  --stats                    print statistics\n"                            \
+  "  --stats-json <out>         export statistics to JSON file <out>\n"        \
   "  --print-fsm                print FSM configuration, may be combined\n"    \
   "                             with solver option to show config for \n"      \
   "\n"                                                                         \
   " Continuous mode options:\n"                                                \
   "  -t, --time <double>        time limit per test run\n"                     \
   "  -m, --max-runs <int>       limit number of test runs\n"                   \
+  "  -j, --jobs <int>           number of test runs to execute in parallel\n"  \
+  "  --persistent <int>         execute up to <int> test runs per forked\n"    \
+  "                             process\n"                                     \
+  "  --coverage-feedback        weight actions and operators based on the\n"   \
+  "                             solver coverage of previous test runs\n"       \
+  "  --adaptive-weights         adapt weights of actions and operators to\n"   \
+  "                             their success in previous test runs\n"         \
   "  --csv                      print error summary in csv format\n"           \
   "  -e, --export-errors <out>  export found errors to JSON file <out>\n"      \
   "\n"                                                                         \
@@ -206,10 +216,18 @@ set_sigint_handler_stats(void)
   "  -a, --api-trace <file>     trace API call sequence into <file>\n"         \
   "  -f, --smt2-file <file>     write --smt2 output to <file>\n"               \
   "  -u, --untrace <file>       replay given API call sequence\n"              \
+  "  --binary-trace             write API traces in binary format\n"           \
+  "  --convert-trace <file>     convert trace given via -u from text to\n"     \
+  "                             binary format or vice versa into <file>\n"     \
   "  --solver-trace             print native solver API trace to stdout\n"     \
+  "  --action-weights <w>       scale the weights of actions with factors\n"   \
+  "                             <w> given as <kind>=<percent>[,...]\n"         \
+  "  --op-weights <w>           scale the weights of operators with factors\n" \
+  "                             <w> given as <kind>=<percent>[,...]\n"         \
   "\n"                                                                         \
   " Trace minimizer:\n"                                                        \
   "  -d, --dd                   enable delta debugging\n"                      \
+  "                             (tests up to --jobs candidates in parallel)\n" \
   "  --dd-match-err <string>    check for occurrence of <string> in stderr\n"  \
   "                             output when delta debugging\n"                 \
   "  --dd-match-out <string>    check for occurrence of <string> in stdout\n"  \
@@ -217,6 +235,11 @@ set_sigint_handler_stats(void)
   "  --dd-ignore-err            ignore stderr output when delta debugging\n"   \
   "  --dd-ignore-out            ignore stdout output when delta debugging\n"   \
   "  -D, --dd-trace <file>      delta debug API trace into <file>\n"           \
+  "  --dd-cache                 persist results of delta debugging tests\n"    \
+  "                             across sessions in --tmp-dir\n"                \
+  "  --dd-checkpoint <int>      snapshot replays every <int> trace lines\n"    \
+  "                             when delta debugging and resume tested\n"      \
+  "                             traces from the deepest matching snapshot\n"   \
   "\n"                                                                         \
   " Solvers:\n"                                                                \
   "  --btor                     test Boolector\n"                              \
@@ -226,6 +249,8 @@ set_sigint_handler_stats(void)
   "  --smt2 [<binary>]          print SMT-LIB 2 (optionally to solver "        \
   "binary\n"                                                                   \
   "                             via stdout)\n"                                 \
+  "  --smt2-pipeline            only wait for the response of the solver\n"    \
+  "                             binary to queries\n"                           \
   "  -o name=value,...          solver options enabled by default\n"           \
   "  --fuzz-opts [wildcard,...] restrict options to be fuzzed with multiple\n" \
   "                             wildcards, which are matched against option\n" \
@@ -236,6 +261,9 @@ set_sigint_handler_stats(void)
   "                             options for cross check solver\n"              \
   "  -C, --check [<solver>]     check unsat cores/assumptions and \n"          \
   "                             model values with <solver>\n"                  \
+  "  --check-concurrent         run cross check and check solver\n"            \
+  "                             concurrently to the solver under test\n"       \
+  "                             (requires different, reentrant solvers)\n"     \
   "\n"                                                                         \
   " Enable/disable theories:\n"                                                \
   "  --[no-]arrays                theory of arrays\n"                          \
@@ -326,11 +354,12 @@ get_options(Options& options,
   if (!options.untrace_file_name.empty())
   {
     std::vector<std::string> opts;
-    std::ifstream trace(options.untrace_file_name);
-    if (trace.good())
+    std::unique_ptr<TraceReader> trace =
+        TraceReader::open(options.untrace_file_name);
+    std::string line;
+    bool newline;
+    if (trace && trace->next_text(line, newline))
     {
-      std::string line;
-      std::getline(trace, line);
       if (line.rfind("set-murxla-options", 0) == 0)
       {
         opts = split(line, ' ');
@@ -423,6 +452,18 @@ parse_options(Options& options, int argc, char* argv[])
     {
       options.dd_ignore_err = true;
     }
+    else if (arg == "--dd-cache")
+    {
+      options.dd_cache = true;
+    }
+    else if (arg == "--dd-checkpoint")
+    {
+      i += 1;
+      check_next_arg(arg, i, size);
+      MURXLA_EXIT_ERROR(!is_numeric(args[i]) || std::stoi(args[i]) < 1)
+          << "invalid argument to option '" << arg << "': " << args[i];
+      options.dd_checkpoint = (uint32_t) std::stoi(args[i]);
+    }
     else if (arg == "-D" || arg == "--dd-trace")
     {
       i += 1;
@@ -435,6 +476,16 @@ parse_options(Options& options, int argc, char* argv[])
       check_next_arg(arg, i, size);
       options.untrace_file_name = args[i];
     }
+    else if (arg == "--binary-trace")
+    {
+      options.binary_trace = true;
+    }
+    else if (arg == "--convert-trace")
+    {
+      i += 1;
+      check_next_arg(arg, i, size);
+      options.convert_trace_file_name = args[i];
+    }
     else if (arg == "-c" || arg == "--cross-check")
     {
       record_args.push_back(arg);
@@ -458,6 +509,11 @@ parse_options(Options& options, int argc, char* argv[])
         i += 1;
       }
     }
+    else if (arg == "--check-concurrent")
+    {
+      record_args.push_back(arg);
+      options.check_concurrent = true;
+    }
     else if (arg == "--no-check")
     {
       record_args.push_back(arg);
@@ -518,6 +574,10 @@ parse_options(Options& options, int argc, char* argv[])
       }
       options.solver = SOLVER_SMT2;
     }
+    else if (arg == "--smt2-pipeline")
+    {
+      options.smt2_pipelined = true;
+    }
     else if (arg == "-f" || arg == "--smt2-file")
     {
       i += 1;
@@ -548,6 +608,12 @@ parse_options(Options& options, int argc, char* argv[])
     {
       options.print_stats = true;
     }
+    else if (arg == "--stats-json")
+    {
+      i += 1;
+      check_next_arg(arg, i, size);
+      options.stats_json_filename = args[i];
+    }
     else if (arg == "--print-fsm")
     {
       options.print_fsm = true;
@@ -572,6 +638,44 @@ parse_options(Options& options, int argc, char* argv[])
       check_next_arg(arg, i, size);
       options.max_runs = (uint32_t) std::stoi(args[i]);
     }
+    else if (arg == "-j" || arg == "--jobs")
+    {
+      i += 1;
+      check_next_arg(arg, i, size);
+      MURXLA_EXIT_ERROR(!is_numeric(args[i]) || std::stoi(args[i]) < 1)
+          << "invalid argument to option '" << arg << "': " << args[i];
+      options.jobs = (uint32_t) std::stoi(args[i]);
+    }
+    else if (arg == "--persistent")
+    {
+      i += 1;
+      check_next_arg(arg, i, size);
+      MURXLA_EXIT_ERROR(!is_numeric(args[i]) || std::stoi(args[i]) < 1)
+          << "invalid argument to option '" << arg << "': " << args[i];
+      options.persistent_runs = (uint32_t) std::stoi(args[i]);
+    }
+    else if (arg == "--coverage-feedback")
+    {
+      MURXLA_EXIT_ERROR(!coverage::Feedback::is_supported())
+          << "coverage feedback requires Murxla to be configured with SANCOV";
+      options.coverage_feedback = true;
+    }
+    else if (arg == "--adaptive-weights")
+    {
+      options.adaptive_weights = true;
+    }
+    else if (arg == "--action-weights" || arg == "--op-weights")
+    {
+      record_args.push_back(arg);
+      i += 1;
+      check_next_arg(arg, i, size);
+      record_args.push_back(args[i]);
+      MURXLA_EXIT_ERROR(!adaptive::parse_weights(
+          args[i],
+          arg == "--action-weights" ? options.action_weights
+                                    : options.op_weights))
+          << "invalid argument to option '" << arg << "': " << args[i];
+    }
     else if (arg == "-l" || arg == "--smt-lib")
     {
       options.smtlib_compliant = true;
@@ -754,6 +858,30 @@ main(int argc, char* argv[])
   bool is_continuous = !options.is_seeded && !is_untrace;
   bool is_forked     = options.dd || is_continuous;
 
+  MURXLA_EXIT_ERROR_CONFIG(options.adaptive_weights && !is_continuous)
+      << "option --adaptive-weights requires continuous mode";
+  MURXLA_EXIT_ERROR_CONFIG(
+      options.adaptive_weights
+      && (!options.action_weights.empty() || !options.op_weights.empty()))
+      << "option --adaptive-weights cannot be combined with --action-weights "
+         "and --op-weights";
+
+  if (!options.convert_trace_file_name.empty())
+  {
+    MURXLA_EXIT_ERROR_CONFIG(!is_untrace)
+        << "option --convert-trace requires a trace given via -u";
+    try
+    {
+      convert_trace(options.untrace_file_name,
+                    options.convert_trace_file_name);
+    }
+    catch (MurxlaException& e)
+    {
+      MURXLA_EXIT_ERROR_CONFIG(true) << e.get_msg();
+    }
+    return 0;
+  }
+
   create_tmp_directory(options.tmp_dir);
 
   std::string api_trace_file_name = options.api_trace_file_name;
@@ -846,6 +974,14 @@ main(int argc, char* argv[])
   {
     stats->print();
   }
+  if (!options.stats_json_filename.empty())
+  {
+    std::ofstream out(options.stats_json_filename);
+    MURXLA_EXIT_ERROR(!out.is_open())
+        << "unable to open statistics output file '"
+        << options.stats_json_filename << "'";
+    stats->print_json(out);
+  }
 
   MURXLA_EXIT_ERROR(munmap(stats, sizeof(Statistics)))
       << "failed to unmap shared memory for statistics";
@@ -10,17 +10,22 @@
 #include "murxla.hpp"
 
 #include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
-#include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <cerrno>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <nlohmann/json.hpp>
 #include <regex>
 
+#include "binary_trace.hpp"
 #include "dd.hpp"
 #include "except.hpp"
 #include "fsm.hpp"
@@ -33,6 +38,7 @@
 #include "solver/solver_profile.hpp"
 #include "solver/yices/yices_solver.hpp"
 #include "statistics.hpp"
+#include "trace_buffer.hpp"
 #include "util.hpp"
 
 namespace murxla {
@@ -69,17 +75,16 @@ namespace {
 std::string
 normalize_asan_error(const std::string& s)
 {
-  std::vector<std::string> regex = {"0x[0-9a-fA-F]+", "==[0-9]+=="};
+  static const std::vector<std::regex> regex = {
+      std::regex("0x[0-9a-fA-F]+", std::regex::optimize),
+      std::regex("==[0-9]+==", std::regex::optimize)};
 
   std::string res, cur_s(s);
   for (const auto& re : regex)
   {
     res.clear();
-    std::regex_replace(std::back_inserter(res),
-                       cur_s.begin(),
-                       cur_s.end(),
-                       std::regex(re),
-                       "");
+    std::regex_replace(
+        std::back_inserter(res), cur_s.begin(), cur_s.end(), re, "");
     cur_s = res;
   }
 
@@ -87,54 +92,83 @@ normalize_asan_error(const std::string& s)
 }
 
 /**
- * Split string into tokens.
+ * Get the error message of a test run from its captured stderr output.
+ * The error message is always terminated with a newline.
  */
-std::vector<std::string>
-str_tokenize(const std::string& s)
+std::string
+get_error_message(OutputBuffer& err)
 {
-  std::istringstream buf(s);
-  std::vector<std::string> ret{std::istream_iterator<std::string>(buf),
-                               std::istream_iterator<std::string>()};
-  return ret;
+  std::string res = err.str();
+  if (!res.empty() && res.back() != '\n')
+  {
+    res += "\n";
+  }
+  return res;
 }
 
 /**
- * Count the number of non-digit characters two strings differ in.
+ * Read exactly 'size' bytes from file descriptor 'fd' into 'buf'.
+ * Returns false if the end of file was reached or reading failed.
  */
-size_t
-str_diff(const std::string& s1, const std::string& s2)
+bool
+read_all(int32_t fd, void* buf, size_t size)
 {
-  size_t diff;
-  auto t1 = str_tokenize(s1);
-  auto t2 = str_tokenize(s2);
+  char* b = static_cast<char*>(buf);
+  while (size > 0)
+  {
+    ssize_t n = read(fd, b, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    b += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
 
-  if (t1.size() > t2.size())
+/**
+ * Write 'size' bytes from 'buf' to file descriptor 'fd'.
+ */
+void
+write_all(int32_t fd, const void* buf, size_t size)
+{
+  const char* b = static_cast<const char*>(buf);
+  while (size > 0)
   {
-    std::swap(t1, t2);
+    ssize_t n = write(fd, b, size);
+    if (n < 0 && errno == EINTR) continue;
+    MURXLA_EXIT_ERROR(n < 0) << "writing to pipe failed";
+    b += n;
+    size -= static_cast<size_t>(n);
   }
+}
 
-  diff = t2.size() - t1.size();
-  for (size_t i = 0; i < t1.size(); ++i)
+/** Get the result of a test run from the exit status of its process. */
+Result
+get_result(int32_t status)
+{
+  if (WIFEXITED(status))
   {
-    if (t1[i] != t2[i])
+    switch (WEXITSTATUS(status))
     {
-      /* Ignore numbers for diff. */
-      for (size_t j = 0; j < t1[i].size(); ++j)
-      {
-        if (std::isdigit(t1[i][j])) continue;
-        ++diff;
-      }
+      case EXIT_OK: return RESULT_OK;
+      case EXIT_ERROR_CONFIG: return RESULT_ERROR_CONFIG;
+      case EXIT_ERROR_UNTRACE: return RESULT_ERROR_UNTRACE;
+      case EXIT_TIMEOUT: return RESULT_TIMEOUT;
+      default: assert(WEXITSTATUS(status) == EXIT_ERROR); return RESULT_ERROR;
     }
   }
-  return diff;
+  if (WIFSIGNALED(status))
+  {
+    return RESULT_ERROR;
+  }
+  return RESULT_UNKNOWN;
 }
 
-double
-error_diff(const std::string& e1, const std::string& e2)
+/** Convert given time in seconds to microseconds. */
+uint64_t
+to_usecs(double time)
 {
-  size_t len  = std::max(e1.size(), e2.size());
-  size_t diff = str_diff(e1, e2);
-  return static_cast<double>(diff) / static_cast<double>(len);
+  return static_cast<uint64_t>(time * 1000000);
 }
 
 }  // namespace
@@ -155,6 +189,7 @@ Murxla::Murxla(statistics::Statistics* stats,
   assert(stats);
   assert(solver_options);
   load_solver_profile();
+  preinitialize();
 
   if (!d_options.export_errors_filename.empty())
   {
@@ -175,8 +210,10 @@ Murxla::run(uint64_t seed,
             bool record_stats,
             Murxla::TraceMode trace_mode)
 {
-  std::string tmp_file_out = get_tmp_file_path("run-tmp1.out", d_tmp_dir);
-  std::string tmp_file_err = get_tmp_file_path("run-tmp1.err", d_tmp_dir);
+  if (run_forked)
+  {
+    reset_run_buffers();
+  }
 
   /* If we don't run forked, and an explicit api trace file name is given, the
    * trace is immediately written to the given file (rather than writing it
@@ -195,8 +232,6 @@ Murxla::run(uint64_t seed,
 
   Result res = run_aux(seed,
                        time,
-                       tmp_file_out,
-                       tmp_file_err,
                        tmp_api_trace_file_name,
                        untrace_file_name,
                        run_forked,
@@ -235,6 +270,13 @@ Murxla::run(uint64_t seed,
                             copy_to,
                             std::filesystem::copy_options::overwrite_existing);
     }
+
+    if (api_trace_file_name != DEVNULL
+        && (copy_to == api_trace_file_name
+            || tmp_api_trace_file_name == api_trace_file_name))
+    {
+      convert_to_binary_trace(api_trace_file_name);
+    }
   }
   // Print terminating "}" for main() function of native API traces.
   else if (trace_mode == TO_STDOUT && d_options.solver_trace)
@@ -242,262 +284,1030 @@ Murxla::run(uint64_t seed,
     std::cout << "}" << std::endl;
   }
 
+  /* Only write captured output to disk if requested. */
   if (run_forked)
   {
-    std::ofstream err = open_output_file(file_err, true);
-    std::ofstream out = open_output_file(file_out, true);
+    if (file_out != DEVNULL)
+    {
+      d_run_out->write_to_file(file_out);
+    }
+    if (file_err != DEVNULL)
+    {
+      d_run_err->write_to_file(file_err);
+    }
+  }
+  return res;
+}
+
+void
+Murxla::reset_run_buffers()
+{
+  /* Created on demand since worker processes need their own buffers. */
+  if (!d_run_out)
+  {
+    d_run_out.reset(new OutputBuffer("run-out", d_tmp_dir));
+    d_run_err.reset(new OutputBuffer("run-err", d_tmp_dir));
+  }
+  if (!d_run_trace)
+  {
+    d_run_trace.reset(new OutputBuffer("run-trace", d_tmp_dir));
+  }
+  d_run_out->reset();
+  d_run_err->reset();
+  d_run_trace->reset();
+}
+
+void
+Murxla::test()
+{
+  if (d_options.adaptive_weights)
+  {
+    d_adaptive_weights = adaptive::Weights::create();
+  }
+
+  if (d_options.jobs > 1)
+  {
+    test_parallel();
+    return;
+  }
+
+  SeedGenerator sg;
+  if (d_options.is_seeded)
+  {
+    sg.set_seed(d_options.seed);
+  }
+
+  TestStatus status;
+  status.start_time = get_cur_wall_time();
+
+  do
+  {
+    uint64_t seed = sg.next();
+
+    print_test_status(status, seed);
+    status.num_runs++;
+
+    /* Note: If the selected solver is SOLVER_SMT2 and no online solver is
+     *       configured, we'll never run into the error case below and replay
+     *       (the Smt2Solver only answers 'unknown' and dumps SMT2 -> should
+     *       never terminate with an error).  We therefore dump every generated
+     *       sequence to smt2 continuously. */
+
+    /* Run and test for error without tracing to trace file. The trace is
+     * captured in memory and only written to file if an error is encountered
+     * (see report_test_result()), no replay is necessary. */
+    Result res = run_test(seed);
+
+    std::string errmsg;
+    if (res == RESULT_ERROR || res == RESULT_ERROR_CONFIG
+        || res == RESULT_ERROR_UNTRACE)
+    {
+      errmsg = get_error_message(*d_run_err);
+    }
+    report_test_result(status, seed, res, d_run_usage, errmsg, *d_run_trace);
+
+    if (d_adaptive_weights
+        && status.num_runs % MURXLA_ADAPTIVE_WEIGHTS_INTERVAL == 0)
+    {
+      d_adaptive_weights->update(*d_stats, d_feedback);
+    }
+  } while (d_options.max_runs == 0 || status.num_runs < d_options.max_runs);
+
+  stop_persistent();
+}
+
+void
+Murxla::detach(const std::string& tmp_dir)
+{
+  d_tmp_dir = tmp_dir;
+  /* Output buffers are created on demand in run(). */
+  d_run_out.reset();
+  d_run_err.reset();
+  d_run_trace.reset();
+}
+
+void
+Murxla::test_parallel()
+{
+  /* A worker process, the parent end of its pipes, and whether it is still
+   * dispatched seeds. */
+  struct Worker
+  {
+    pid_t pid;
+    int32_t fd_seeds;
+    int32_t fd_results;
+    bool active;
+  };
+
+  uint32_t num_dispatched = 0;
+  SeedGenerator sg;
+  if (d_options.is_seeded)
+  {
+    sg.set_seed(d_options.seed);
+  }
+
+  TestStatus status;
+  status.start_time = get_cur_wall_time();
+
+  auto dispatch = [this, &sg, &num_dispatched](Worker& w) {
+    if (d_options.max_runs > 0 && num_dispatched >= d_options.max_runs)
+    {
+      close(w.fd_seeds);
+      w.active = false;
+      return;
+    }
+    uint64_t seed = sg.next();
+    write_all(w.fd_seeds, &seed, sizeof(seed));
+    ++num_dispatched;
+  };
+
+  /* Make sure that buffered output is not duplicated in the workers. */
+  std::cout << std::flush;
+
+  std::vector<Worker> workers;
+  /* The trace buffers of the workers. A worker does not reset its buffer
+   * before it receives the next seed, hence the parent can access the trace
+   * of the last test run of a worker while reporting its result. */
+  std::vector<std::unique_ptr<OutputBuffer>> traces;
+  for (uint32_t i = 0; i < d_options.jobs; ++i)
+  {
+    statistics::Statistics* stats =
+        static_cast<statistics::Statistics*>(mmap(0,
+                                                  sizeof(statistics::Statistics),
+                                                  PROT_READ | PROT_WRITE,
+                                                  MAP_ANONYMOUS | MAP_SHARED,
+                                                  -1,
+                                                  0));
+    MURXLA_EXIT_ERROR(stats == MAP_FAILED)
+        << "failed to map shared memory for worker statistics";
+    memset(stats, 0, sizeof(statistics::Statistics));
+    d_worker_stats.push_back(stats);
+
+    std::string tmp_dir =
+        get_tmp_file_path("worker-" + std::to_string(i), d_tmp_dir);
+    std::filesystem::create_directory(tmp_dir);
+    traces.emplace_back(
+        new OutputBuffer("run-trace-" + std::to_string(i), tmp_dir));
+
+    int32_t fds_seeds[2], fds_results[2];
+    MURXLA_EXIT_ERROR(pipe(fds_seeds) || pipe(fds_results))
+        << "failed to create pipes for worker process";
+
+    pid_t pid = fork();
+    MURXLA_EXIT_ERROR(pid < 0) << "forking worker process failed.";
+
+    /* worker */
+    if (pid == 0)
+    {
+      /* Close parent ends of the pipes of this and all previous workers. */
+      close(fds_seeds[1]);
+      close(fds_results[0]);
+      for (const auto& w : workers)
+      {
+        close(w.fd_seeds);
+        close(w.fd_results);
+      }
+      d_stats = stats;
+      detach(tmp_dir);
+      d_run_trace = std::move(traces.back());
+      traces.clear();
+      run_worker(fds_seeds[0], fds_results[1]);
+    }
+
+    close(fds_seeds[0]);
+    close(fds_results[1]);
+    workers.push_back({pid, fds_seeds[1], fds_results[0], true});
+  }
+
+  for (auto& w : workers)
+  {
+    dispatch(w);
+  }
+
+  std::vector<struct pollfd> fds;
+  for (const auto& w : workers)
+  {
+    fds.push_back({w.fd_results, POLLIN, 0});
+  }
+
+  size_t num_active = workers.size();
+  while (num_active > 0)
+  {
+    if (poll(fds.data(), fds.size(), -1) < 0)
+    {
+      MURXLA_EXIT_ERROR(errno != EINTR) << "polling worker processes failed";
+      continue;
+    }
+
+    for (size_t i = 0, n = workers.size(); i < n; ++i)
+    {
+      Worker& w = workers[i];
+      if (!w.active || !(fds[i].revents & (POLLIN | POLLHUP))) continue;
+
+      WorkerResult wres;
+      std::string errmsg;
+      bool received = read_all(w.fd_results, &wres, sizeof(wres));
+      if (received)
+      {
+        errmsg.resize(wres.errmsg_size);
+        received = read_all(w.fd_results, errmsg.data(), wres.errmsg_size);
+      }
+      MURXLA_EXIT_ERROR(!received) << "worker process terminated unexpectedly";
+
+      print_test_status(status, wres.seed);
+      status.num_runs++;
+      report_test_result(status,
+                         wres.seed,
+                         static_cast<Result>(wres.result),
+                         wres.usage,
+                         errmsg,
+                         *traces[i]);
+
+      /* The coverage feedback is recorded per worker, hence only the
+       * statistics of the workers are available here. */
+      if (d_adaptive_weights
+          && status.num_runs % MURXLA_ADAPTIVE_WEIGHTS_INTERVAL == 0)
+      {
+        std::unique_ptr<statistics::Statistics> stats(
+            new statistics::Statistics());
+        for (const statistics::Statistics* s : d_worker_stats)
+        {
+          stats->merge(*s);
+        }
+        d_adaptive_weights->update(*stats, nullptr);
+      }
+
+      dispatch(w);
+      if (!w.active)
+      {
+        fds[i].fd = -1;
+        --num_active;
+      }
+    }
+  }
+
+  /* Collect workers and aggregate their statistics. */
+  for (size_t i = 0, n = workers.size(); i < n; ++i)
+  {
+    close(workers[i].fd_results);
+    waitpid(workers[i].pid, nullptr, 0);
+    d_stats->merge(*d_worker_stats[i]);
+    munmap(d_worker_stats[i], sizeof(statistics::Statistics));
+  }
+  d_worker_stats.clear();
+}
+
+void
+Murxla::run_worker(int32_t fd_seeds, int32_t fd_results)
+{
+  signal(SIGINT, SIG_DFL);  // reset stats signal handler
+
+  uint64_t seed;
+
+  while (read_all(fd_seeds, &seed, sizeof(seed)))
+  {
+    Result res = run_test(seed);
+
+    std::string errmsg;
+    if (res == RESULT_ERROR || res == RESULT_ERROR_CONFIG
+        || res == RESULT_ERROR_UNTRACE)
+    {
+      errmsg = get_error_message(*d_run_err);
+    }
+
+    WorkerResult wres = {seed, res, d_run_usage, errmsg.size()};
+    write_all(fd_results, &wres, sizeof(wres));
+    write_all(fd_results, errmsg.data(), errmsg.size());
+  }
+  stop_persistent();
+  exit(EXIT_OK);
+}
+
+Result
+Murxla::run_test(uint64_t seed)
+{
+  /* The number of times each action and operator was used before this test
+   * run, for computing the actions and operators used in this test run. */
+  std::vector<uint64_t> actions, ops;
+  if (d_options.coverage_feedback)
+  {
+    if (!d_feedback)
+    {
+      d_feedback = coverage::Feedback::create();
+    }
+    actions.assign(d_stats->d_actions,
+                   d_stats->d_actions + MURXLA_MAX_N_ACTIONS);
+    ops.assign(d_stats->d_ops, d_stats->d_ops + MURXLA_MAX_N_OPS);
+    d_feedback->start_run();
+  }
+
+  /* SMT2 offline mode writes all SMT2 files, which requires a new process for
+   * each test run. */
+  Result res;
+  if (d_options.persistent_runs > 1 && !is_smt2_offline())
+  {
+    res = run_persistent(seed, d_options.time);
+  }
+  else
+  {
+    res = run(seed,
+              d_options.time,
+              DEVNULL,
+              DEVNULL,
+              get_api_trace_file_name(seed),
+              d_options.untrace_file_name,
+              true,
+              true,
+              // for the SMT2 offline mode we want to store all SMT2 files
+              is_smt2_offline() ? TO_FILE : TO_BUFFER);
+  }
+
+  if (d_feedback)
+  {
+    for (size_t i = 0; i < MURXLA_MAX_N_ACTIONS; ++i)
+    {
+      actions[i] = d_stats->d_actions[i] - actions[i];
+    }
+    for (size_t i = 0; i < MURXLA_MAX_N_OPS; ++i)
+    {
+      ops[i] = d_stats->d_ops[i] - ops[i];
+    }
+    d_feedback->finish_run(actions.data(), ops.data());
+  }
+  return res;
+}
+
+Result
+Murxla::run_persistent(uint64_t seed, double time)
+{
+  reset_run_buffers();
+
+  if (!d_persistent.pid)
+  {
+    int32_t fds_seeds[2], fds_results[2];
+    MURXLA_EXIT_ERROR(pipe(fds_seeds) || pipe(fds_results))
+        << "failed to create pipes for persistent test run process";
+    /* Processes started by the solver (e.g., the online solver of the SMT2
+     * solver) must not keep the pipes open after the test run process
+     * terminated. */
+    for (int32_t fd :
+         {fds_seeds[0], fds_seeds[1], fds_results[0], fds_results[1]})
+    {
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    /* Make sure that buffered output is not duplicated in the child. */
+    std::cout << std::flush;
+
+    pid_t pid = fork();
+    MURXLA_EXIT_ERROR(pid < 0) << "forking test run process failed.";
+
+    if (pid == 0)
+    {
+      close(fds_seeds[1]);
+      close(fds_results[0]);
+      run_persistent_process(fds_seeds[0], fds_results[1]);
+    }
+
+    close(fds_seeds[0]);
+    close(fds_results[1]);
+    d_persistent.pid        = pid;
+    d_persistent.fd_seeds   = fds_seeds[1];
+    d_persistent.fd_results = fds_results[0];
+  }
+
+  double start = get_cur_wall_time();
+  write_all(d_persistent.fd_seeds, &seed, sizeof(seed));
+
+  /* Wait for the result of the test run. If the process terminates, the end
+   * of file is reached. */
+  bool timeout = false;
+  for (;;)
+  {
+    int32_t timeout_ms = -1;
+    if (time > 0)
+    {
+      double left = start + time - get_cur_wall_time();
+      timeout_ms  = left > 0 ? static_cast<int32_t>(std::ceil(left * 1000)) : 0;
+    }
+    struct pollfd fd = {d_persistent.fd_results, POLLIN, 0};
+    int32_t n        = poll(&fd, 1, timeout_ms);
+    MURXLA_EXIT_ERROR(n < 0 && errno != EINTR)
+        << "polling test run process failed";
+    if (n > 0) break;
+    if (n == 0 && timeout_ms == 0)
+    {
+      timeout = true;
+      break;
+    }
+  }
+
+  Result result;
+  ResourceUsage usage;
+  if (!timeout && read_all(d_persistent.fd_results, &usage, sizeof(usage)))
+  {
+    result = RESULT_OK;
+    ++d_persistent.num_runs;
+  }
+  else
+  {
+    pid_t pid = d_persistent.pid;
+    if (timeout)
+    {
+      interrupt(pid);
+      kill(pid, SIGKILL);
+    }
+    Watchdog watchdog;
+    watchdog.watch(pid, 0);
+    Watchdog::Event event = watchdog.wait();
+    usage                 = event.d_usage;
+
+    close(d_persistent.fd_seeds);
+    close(d_persistent.fd_results);
+    d_persistent.pid = 0;
+
+    result = timeout ? RESULT_TIMEOUT : get_result(event.d_status);
+    if (result == RESULT_ERROR_CONFIG || result == RESULT_ERROR_UNTRACE)
+    {
+      d_error_msg = d_run_err->str();
+    }
+  }
+
+  /* Truncate the trace to the length recorded by the test run process. */
+  TraceBuffer::truncate(d_run_trace->get_path());
+
+  /* The process reports its accumulated CPU time. */
+  d_run_usage.d_wall_time = get_cur_wall_time() - start;
+  d_run_usage.d_cpu_time  = usage.d_cpu_time - d_persistent.cpu_time;
+  d_run_usage.d_max_rss   = usage.d_max_rss;
+  d_persistent.cpu_time   = usage.d_cpu_time;
+  record_run_usage();
+
+  if (!d_persistent.pid)
+  {
+    d_persistent = PersistentProcess();
+  }
+  else if (d_persistent.num_runs >= d_options.persistent_runs)
+  {
+    stop_persistent();
+  }
+  return result;
+}
+
+void
+Murxla::stop_persistent()
+{
+  if (!d_persistent.pid) return;
+  /* The process terminates when it reaches the end of file. */
+  close(d_persistent.fd_seeds);
+  close(d_persistent.fd_results);
+  waitpid(d_persistent.pid, nullptr, 0);
+  d_persistent = PersistentProcess();
+}
+
+void
+Murxla::run_persistent_process(int32_t fd_seeds, int32_t fd_results)
+{
+  signal(SIGINT, SIG_DFL);  // reset stats signal handler
+#ifdef MURXLA_COVERAGE
+  signal(SIGABRT, handle_abort);
+#endif
+
+  /* Redirect stdout and stderr into the output buffers, which are reset by
+   * the parent before each test run. */
+  d_run_out->redirect(STDOUT_FILENO);
+  d_run_err->redirect(STDERR_FILENO);
+
+  uint64_t seed;
+  while (read_all(fd_seeds, &seed, sizeof(seed)))
+  {
+    std::ostream trace(nullptr);
+    std::ostream smt2_out(nullptr);
+    std::unique_ptr<TraceBuffer> trace_buffer =
+        trace_to_buffer(trace, smt2_out);
+
+    /* Each test run creates a new FSM, and thus a new solver manager and
+     * solver, hence no state is carried over to the next test run. */
+    run_fsm(seed, trace, smt2_out, d_options.untrace_file_name, true, true);
+
+    trace_buffer->close();
+    std::cout << std::flush;
+    std::cerr << std::flush;
+    fflush(stdout);
+    fflush(stderr);
+
+    ResourceUsage usage = get_self_usage();
+    write_all(fd_results, &usage, sizeof(usage));
+  }
+  exit(EXIT_OK);
+}
+
+Result
+Murxla::replay(uint64_t seed,
+               double time,
+               const std::string& file_out,
+               const std::string& file_err,
+               const std::string& untrace_file_name)
+{
+  std::vector<std::string> lines;
+  {
+    std::unique_ptr<TraceReader> trace = TraceReader::open(untrace_file_name);
+    MURXLA_EXIT_ERROR(trace == nullptr)
+        << "unable to open file '" << untrace_file_name << "'";
+    std::string line;
+    bool newline;
+    while (trace->next_text(line, newline))
+    {
+      lines.push_back(line);
+    }
+  }
+
+  /* Determine the deepest snapshot whose replayed lines are a prefix of the
+   * given trace. */
+  uint32_t depth = 0;
+  if (d_replay.pid && d_replay.seed == seed
+      && d_replay.untrace_file_name == untrace_file_name)
+  {
+    size_t nprefix = 0;
+    while (nprefix < lines.size() && nprefix < d_replay.lines.size()
+           && lines[nprefix] == d_replay.lines[nprefix])
+    {
+      nprefix += 1;
+    }
+    while (depth < d_replay.nlines.size() && d_replay.nlines[depth] <= nprefix)
+    {
+      depth += 1;
+    }
+  }
+
+  if (depth == 0)
+  {
+    stop_replay();
+    reset_run_buffers();
+
+    int32_t fds_requests[2], fds_messages[2];
+    MURXLA_EXIT_ERROR(pipe(fds_requests) || pipe(fds_messages))
+        << "failed to create pipes for replay process";
+    for (int32_t fd :
+         {fds_requests[0], fds_requests[1], fds_messages[0], fds_messages[1]})
+    {
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    /* Make sure that buffered output is not duplicated in the child. */
+    std::cout << std::flush;
+
+    pid_t pid = fork();
+    MURXLA_EXIT_ERROR(pid < 0) << "forking replay process failed.";
+
+    if (pid == 0)
+    {
+      /* All snapshots are in the process group of the root, which allows to
+       * kill them at once on timeout. */
+      setpgid(0, 0);
+      close(fds_requests[1]);
+      close(fds_messages[0]);
+      d_replay_process = {
+          fds_requests[0], fds_messages[1], 0, 0, untrace_file_name};
+
+      signal(SIGINT, SIG_DFL);  // reset stats signal handler
+      d_run_out->redirect(STDOUT_FILENO);
+      d_run_err->redirect(STDERR_FILENO);
+
+      std::ostream trace(nullptr);
+      std::ostream smt2_out(nullptr);
+      run_fsm(seed, trace, smt2_out, untrace_file_name, true, false, true);
+      exit(EXIT_OK);
+    }
+
+    setpgid(pid, pid);
+    close(fds_requests[0]);
+    close(fds_messages[1]);
+    d_replay.pid               = pid;
+    d_replay.fd_requests       = fds_requests[1];
+    d_replay.fd_messages       = fds_messages[0];
+    d_replay.seed              = seed;
+    d_replay.untrace_file_name = untrace_file_name;
+  }
+  else
+  {
+    write_all(d_replay.fd_requests, &depth, sizeof(depth));
+    d_replay.nlines.resize(depth);
+  }
+  d_replay.lines = std::move(lines);
+
+  /* Collect the snapshots taken by the replay until it terminates. If the
+   * root terminates, the end of file is reached. */
+  Result result = RESULT_UNKNOWN;
+  double start  = get_cur_wall_time();
+  for (;;)
+  {
+    int32_t timeout_ms = -1;
+    if (time > 0)
+    {
+      double left = start + time - get_cur_wall_time();
+      timeout_ms  = left > 0 ? static_cast<int32_t>(std::ceil(left * 1000)) : 0;
+    }
+    struct pollfd fd = {d_replay.fd_messages, POLLIN, 0};
+    int32_t n        = poll(&fd, 1, timeout_ms);
+    MURXLA_EXIT_ERROR(n < 0 && errno != EINTR) << "polling replay failed";
+    if (n == 0 && timeout_ms == 0)
+    {
+      kill(-d_replay.pid, SIGKILL);
+      stop_replay();
+      result = RESULT_TIMEOUT;
+      break;
+    }
+    if (n <= 0) continue;
+
+    ReplayMessage msg;
+    if (!read_all(d_replay.fd_messages, &msg, sizeof(msg)))
+    {
+      int32_t status = 0;
+      while (waitpid(d_replay.pid, &status, 0) < 0)
+      {
+        MURXLA_EXIT_ERROR(errno != EINTR) << "failed to collect replay";
+      }
+      d_replay.pid = 0;
+      stop_replay();
+      result = get_result(status);
+      break;
+    }
+    if (msg.depth == 0)
+    {
+      result = get_result(msg.status);
+      break;
+    }
+    d_replay.nlines.resize(msg.depth - 1);
+    d_replay.nlines.push_back(msg.nlines);
+  }
+
+  if (result == RESULT_ERROR_CONFIG || result == RESULT_ERROR_UNTRACE)
+  {
+    d_error_msg = d_run_err->str();
+  }
+  if (file_out != DEVNULL)
+  {
+    d_run_out->write_to_file(file_out);
+  }
+  if (file_err != DEVNULL)
+  {
+    d_run_err->write_to_file(file_err);
+  }
+  return result;
+}
+
+void
+Murxla::stop_replay()
+{
+  /* The snapshots terminate when they reach the end of file. */
+  if (d_replay.pid)
+  {
+    close(d_replay.fd_requests);
+    close(d_replay.fd_messages);
+    waitpid(d_replay.pid, nullptr, 0);
+  }
+  else if (d_replay.fd_requests >= 0)
+  {
+    close(d_replay.fd_requests);
+    close(d_replay.fd_messages);
+  }
+  d_replay = ReplaySnapshots();
+}
 
-    std::ifstream tmp_out = open_input_file(tmp_file_out, true);
-    out << tmp_out.rdbuf();
-    tmp_out.close();
+std::string
+Murxla::checkpoint_replay(uint32_t nlines)
+{
+  ReplayProcess& proc = d_replay_process;
+  if (nlines < proc.nlines + d_options.dd_checkpoint)
+  {
+    return "";
+  }
+
+  /* This process becomes the snapshot at the next depth. The output of the
+   * replayed lines is flushed, its size is restored whenever a replay is
+   * resumed from this snapshot. */
+  uint32_t depth = proc.depth + 1;
+  std::cout << std::flush;
+  std::cerr << std::flush;
+  fflush(stdout);
+  fflush(stderr);
+  off_t out_size = lseek(STDOUT_FILENO, 0, SEEK_CUR);
+  off_t err_size = lseek(STDERR_FILENO, 0, SEEK_CUR);
+
+  ReplayMessage msg = {depth, nlines, 0};
+  write_all(proc.fd_messages, &msg, sizeof(msg));
+
+  /* The child process, and whether it is a snapshot. */
+  pid_t pid           = 0;
+  bool snapshot       = false;
+  int32_t fd_requests = -1, fd_messages = -1;
+
+  auto stop_child = [&]() {
+    if (!pid) return;
+    close(fd_requests);
+    close(fd_messages);
+    waitpid(pid, nullptr, 0);
+    pid = 0;
+  };
+
+  /* The first replay continues with the current trace. */
+  uint32_t request = depth;
+  std::string file_name;
+  for (;;)
+  {
+    if (request == depth || !snapshot)
+    {
+      stop_child();
+      MURXLA_EXIT_ERROR(ftruncate(STDOUT_FILENO, out_size) < 0
+                        || lseek(STDOUT_FILENO, out_size, SEEK_SET) < 0
+                        || ftruncate(STDERR_FILENO, err_size) < 0
+                        || lseek(STDERR_FILENO, err_size, SEEK_SET) < 0)
+          << "unable to restore output of replay snapshot";
+
+      int32_t fds_requests[2], fds_messages[2];
+      MURXLA_EXIT_ERROR(pipe(fds_requests) || pipe(fds_messages))
+          << "failed to create pipes for replay process";
+      for (int32_t fd :
+           {fds_requests[0], fds_requests[1], fds_messages[0], fds_messages[1]})
+      {
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+      }
+
+      pid = fork();
+      MURXLA_EXIT_ERROR(pid < 0) << "forking replay process failed.";
+      if (pid == 0)
+      {
+        close(proc.fd_requests);
+        close(proc.fd_messages);
+        close(fds_requests[1]);
+        close(fds_messages[0]);
+        proc.fd_requests = fds_requests[0];
+        proc.fd_messages = fds_messages[1];
+        proc.depth       = depth;
+        proc.nlines      = nlines;
+        return file_name;
+      }
+      close(fds_requests[0]);
+      close(fds_messages[1]);
+      fd_requests = fds_requests[1];
+      fd_messages = fds_messages[0];
+      snapshot    = false;
+    }
+    else
+    {
+      write_all(fd_requests, &request, sizeof(request));
+    }
+
+    /* Relay the messages of the descendants until the replay terminated. */
+    do
+    {
+      if (!read_all(fd_messages, &msg, sizeof(msg)))
+      {
+        int32_t status = 0;
+        while (waitpid(pid, &status, 0) < 0)
+        {
+          MURXLA_EXIT_ERROR(errno != EINTR) << "failed to collect replay";
+        }
+        close(fd_requests);
+        close(fd_messages);
+        pid      = 0;
+        snapshot = false;
+        msg      = {0, 0, status};
+      }
+      else if (msg.depth > 0)
+      {
+        snapshot = true;
+      }
+      write_all(proc.fd_messages, &msg, sizeof(msg));
+    } while (msg.depth > 0);
+
+    /* Wait for the next request, terminate if the parent terminated. */
+    if (!read_all(proc.fd_requests, &request, sizeof(request)))
+    {
+      stop_child();
+      _exit(EXIT_OK);
+    }
+    file_name = proc.untrace_file_name;
+  }
+}
+
+void
+Murxla::print_test_status(TestStatus& status, uint64_t seed) const
+{
+  auto num_results = [this](Solver::Result r) {
+    uint64_t res = d_stats->d_results[r];
+    for (const auto stats : d_worker_stats)
+    {
+      res += stats->d_results[r];
+    }
+    return res;
+  };
 
-    std::ifstream tmp_err = open_input_file(tmp_file_err, true);
-    err << tmp_err.rdbuf();
-    tmp_err.close();
+  double cur_time = get_cur_wall_time();
 
-    out.close();
-    err.close();
+  if (status.num_printed_lines % 100 == 0)
+  {
+    std::cout << std::setw(16) << "seed";
+    std::cout << " " << std::setw(5) << "runs";
+    std::cout << " " << std::setw(8) << "r/s";
+    std::cout << " " << std::setw(5) << "sat";
+    std::cout << " " << std::setw(5) << "unsat";
+    std::cout << " " << std::setw(5) << "unknw";
+    std::cout << " " << std::setw(5) << "to";
+    std::cout << " " << std::setw(5) << "err";
+
+    std::cout << std::endl;
+    ++status.num_printed_lines;
   }
-  return res;
+
+  std::cout << std::setw(16) << std::hex << seed << std::dec;
+  std::cout << " " << std::setw(5) << status.num_runs;
+  std::cout << " " << std::setw(8) << std::setprecision(2) << std::fixed;
+  std::cout << status.num_runs / (cur_time - status.start_time);
+  std::cout << " " << std::setw(5) << num_results(Solver::Result::SAT);
+  std::cout << " " << std::setw(5) << num_results(Solver::Result::UNSAT);
+  std::cout << " " << std::setw(5) << num_results(Solver::Result::UNKNOWN);
+  std::cout << " " << std::setw(5) << status.num_timeouts;
+  std::cout << " " << std::setw(5) << d_errors->size();
+  std::cout << std::flush;
 }
 
 void
-Murxla::test()
+Murxla::report_test_result(TestStatus& status,
+                           uint64_t seed,
+                           Result res,
+                           const ResourceUsage& usage,
+                           const std::string& errmsg,
+                           OutputBuffer& trace)
 {
-  uint64_t num_timeouts = 0, num_printed_lines = 0;
   uint64_t error_id = 0, error_nduplicates = 0;
-  uint32_t num_runs         = 0;
-  double start_time         = get_cur_wall_time();
-  std::string out_file_name = DEVNULL;
-  SeedGenerator sg;
-  if (d_options.is_seeded)
-  {
-    sg.set_seed(d_options.seed);
-  }
+  std::string api_trace_file_name = get_api_trace_file_name(seed);
+  Terminal& term                  = status.term;
 
-  std::string err_file_name = get_tmp_file_path("tmp.err", d_tmp_dir);
-  Terminal term;
+  std::string errmsg_filtered;
+  ErrorKind errkind = ErrorKind::ERROR;
 
-  do
+  if (d_options.verbosity > 1)
   {
-    double cur_time = get_cur_wall_time();
-
-    uint64_t seed = sg.next();
+    std::cout << " [" << usage << "]";
+  }
 
-    if (num_printed_lines % 100 == 0)
+  /* report status */
+  if (res == RESULT_OK)
+  {
+    if (term.is_term())
     {
-      std::cout << std::setw(16) << "seed";
-      std::cout << " " << std::setw(5) << "runs";
-      std::cout << " " << std::setw(8) << "r/s";
-      std::cout << " " << std::setw(5) << "sat";
-      std::cout << " " << std::setw(5) << "unsat";
-      std::cout << " " << std::setw(5) << "unknw";
-      std::cout << " " << std::setw(5) << "to";
-      std::cout << " " << std::setw(5) << "err";
-
-      std::cout << std::endl;
-      ++num_printed_lines;
-    }
-
-    std::cout << std::setw(16) << std::hex << seed << std::dec;
-    std::cout << " " << std::setw(5) << num_runs;
-    std::cout << " " << std::setw(8) << std::setprecision(2) << std::fixed;
-    std::cout << num_runs / (cur_time - start_time);
-    std::cout << " " << std::setw(5) << d_stats->d_results[Solver::Result::SAT];
-    std::cout << " " << std::setw(5)
-              << d_stats->d_results[Solver::Result::UNSAT];
-    std::cout << " " << std::setw(5)
-              << d_stats->d_results[Solver::Result::UNKNOWN];
-    std::cout << " " << std::setw(5) << num_timeouts;
-    std::cout << " " << std::setw(5) << d_errors->size();
-    std::cout << std::flush;
-    num_runs++;
-
-    /* Note: If the selected solver is SOLVER_SMT2 and no online solver is
-     *       configured, we'll never run into the error case below and replay
-     *       (the Smt2Solver only answers 'unknown' and dumps SMT2 -> should
-     *       never terminate with an error).  We therefore dump every generated
-     *       sequence to smt2 continuously. */
-
-    /* Run and test for error without tracing to trace file (we by default still
-     * trace to stdout here, which is redirected to /dev/null).
-     * If error encountered, replay and trace below. */
-
-    std::string api_trace_file_name = get_api_trace_file_name(seed);
-    bool smt2_offline =
-        (d_options.solver == SOLVER_SMT2 && d_options.solver_binary.empty());
-    Result res =
-        run(seed,
-            d_options.time,
-            out_file_name,
-            err_file_name,
-            api_trace_file_name,
-            d_options.untrace_file_name,
-            true,
-            true,
-            // for the SMT2 offline mode we want to store all SMT2 files
-            smt2_offline ? TO_FILE : NONE);
-
-    std::string errmsg, errmsg_filtered;
-    ErrorKind errkind = ErrorKind::ERROR;
-    /* report status */
-    if (res == RESULT_OK)
-    {
-      if (term.is_term())
-      {
-        term.erase(std::cout);
-      }
-      else
-      {
-        std::cout << std::endl;
-        ++num_printed_lines;
-      }
+      term.erase(std::cout);
     }
     else
     {
-      /* Read error file and check if we already encounterd the same error. */
-      if (res == RESULT_ERROR || res == RESULT_ERROR_CONFIG
-          || res == RESULT_ERROR_UNTRACE)
-      {
-        std::ifstream errs = open_input_file(err_file_name, false);
-        std::string line;
-        while (std::getline(errs, line))
-        {
-          errmsg += line + "\n";
-        }
-        if (res == RESULT_ERROR)
+      std::cout << std::endl;
+      ++status.num_printed_lines;
+    }
+  }
+  else
+  {
+    /* Check if we already encounterd the same error. */
+    if (res == RESULT_ERROR)
+    {
+      std::tie(errkind, errmsg_filtered, error_id, error_nduplicates) =
+          add_error(errmsg, seed);
+    }
+    else if (res == RESULT_ERROR_CONFIG)
+    {
+      term.erase(std::cout);
+      MURXLA_CHECK_CONFIG(false) << errmsg;
+    }
+    else if (res == RESULT_ERROR_UNTRACE)
+    {
+      MURXLA_CHECK_TRACE(false) << errmsg;
+    }
+
+    std::stringstream info;
+    info << " [";
+    switch (res)
+    {
+      case RESULT_ERROR:
+        if (errkind == ErrorKind::DUPLICATE)
         {
-          std::tie(errkind, errmsg_filtered, error_id, error_nduplicates) =
-              add_error(errmsg, seed);
+          info << term.green() << "duplicate:" << error_id;
         }
-        else if (res == RESULT_ERROR_CONFIG)
+        else if (errkind == ErrorKind::ERROR)
         {
-          term.erase(std::cout);
-          MURXLA_CHECK_CONFIG(false) << errmsg_filtered << " " << d_error_msg;
+          info << term.red() << "error:" << error_id;
         }
-        else
+        else if (errkind == ErrorKind::FILTER)
         {
-          assert(res == RESULT_ERROR_UNTRACE);
-          MURXLA_CHECK_TRACE(false) << errmsg_filtered << " " << d_error_msg;
+          info << term.gray() << "filtered";
         }
-      }
+        break;
+      case RESULT_ERROR_CONFIG: info << term.red() << "config error"; break;
+      case RESULT_ERROR_UNTRACE: info << term.red() << "untrace error"; break;
+      case RESULT_TIMEOUT:
+        info << term.blue() << "timeout";
+        ++status.num_timeouts;
+        break;
+      default: assert(res == RESULT_UNKNOWN); info << "unknown";
+    }
+    info << term.defaultcolor() << "]";
 
-      std::stringstream info;
-      info << " [";
-      switch (res)
+    std::cout << info.str() << std::flush;
+    if (res == RESULT_ERROR && errkind != ErrorKind::FILTER)
+    {
+      std::cout << " ";
+    }
+    else
+    {
+      if (d_options.verbosity > 0)
       {
-        case RESULT_ERROR:
-          if (errkind == ErrorKind::DUPLICATE)
-          {
-            info << term.green() << "duplicate:" << error_id;
-          }
-          else if (errkind == ErrorKind::ERROR)
-          {
-            info << term.red() << "error:" << error_id;
-          }
-          else if (errkind == ErrorKind::FILTER)
-          {
-            info << term.gray() << "filtered";
-          }
-          break;
-        case RESULT_ERROR_CONFIG: info << term.red() << "config error"; break;
-        case RESULT_ERROR_UNTRACE: info << term.red() << "untrace error"; break;
-        case RESULT_TIMEOUT:
-          info << term.blue() << "timeout";
-          ++num_timeouts;
-          break;
-        default: assert(res == RESULT_UNKNOWN); info << "unknown";
+        std::cout << std::endl;
+        ++status.num_printed_lines;
       }
-      info << term.defaultcolor() << "]";
+    }
 
-      std::cout << info.str() << std::flush;
-      if (res == RESULT_ERROR && errkind != ErrorKind::FILTER)
+    /* Write the trace captured in memory to file on error.
+     *
+     * If SMT2 solver with online solver configured, dump smt2.
+     * If SMT2 solver configured without an online solver, we'll never enter
+     * here (the SMT2 solver should never return an error result). */
+    if (res != RESULT_TIMEOUT && errkind != ErrorKind::FILTER)
+    {
+      // The SMT2 problem was already written to file.
+      if (is_smt2_offline())
       {
-        std::cout << " ";
+        std::cout << get_smt2_file_name(seed, api_trace_file_name)
+                  << std::endl;
       }
       else
       {
-        if (d_options.verbosity > 0)
-        {
-          std::cout << std::endl;
-          ++num_printed_lines;
-        }
-      }
-
-      /* Replay and trace on error.
-       *
-       * If SMT2 solver with online solver configured, dump smt2 on replay.
-       * If SMT2 solver configured without an online solver, we'll never enter
-       * here (the SMT2 solver should never return an error result). */
-      if (res != RESULT_TIMEOUT && errkind != ErrorKind::FILTER)
-      {
-        // No need to replay SMT2 since we already have the SMT2 problem.
-        if (smt2_offline)
-        {
-          std::cout << get_smt2_file_name(seed, api_trace_file_name)
-                    << std::endl;
-        }
-        else
-        {
-          assert(error_id > 0);
-          api_trace_file_name = get_api_trace_file_name(seed, error_id);
-          Result res_replay = replay(seed,
-                                     out_file_name,
-                                     err_file_name,
-                                     api_trace_file_name,
-                                     d_options.untrace_file_name);
-
-          std::cout << api_trace_file_name << std::endl;
-
-          // Note: This may happen in few cases where the replay runs into a
-          // timeout, but the original run does not.
-          MURXLA_WARN(res != res_replay)
-              << "Replay did not return the same result as original run. "
-              << "Original run returned " << res << ", but replay returned "
-              << res_replay << ".";
-        }
-      }
-      /* Print new error message after it was found. */
-      if (res == RESULT_ERROR && errkind == ErrorKind::ERROR)
-      {
-        std::cout << std::endl;
-        std::cout << rstrip(errmsg_filtered) << "\n" << std::endl;
-        num_printed_lines = 0;  // print header again after error
-
-        // If it is the first error, we also store the error message in a text
-        // file.
-        assert(error_nduplicates == 1);
-        std::filesystem::path fp(api_trace_file_name);
-        std::string text_file = prepend_path(fp.parent_path(), "error.txt");
-        std::ofstream os(text_file);
-        os << errmsg_filtered << "\n";
+        assert(error_id > 0);
+        api_trace_file_name = get_api_trace_file_name(seed, error_id);
+        persist_trace(seed, trace, api_trace_file_name);
+        std::cout << api_trace_file_name << std::endl;
       }
     }
-  } while (d_options.max_runs == 0 || num_runs < d_options.max_runs);
+    /* Print new error message after it was found. */
+    if (res == RESULT_ERROR && errkind == ErrorKind::ERROR)
+    {
+      std::cout << std::endl;
+      std::cout << rstrip(errmsg_filtered) << "\n" << std::endl;
+      status.num_printed_lines = 0;  // print header again after error
+
+      // If it is the first error, we also store the error message in a text
+      // file.
+      assert(error_nduplicates == 1);
+      std::filesystem::path fp(api_trace_file_name);
+      std::string text_file = prepend_path(fp.parent_path(), "error.txt");
+      std::ofstream os(text_file);
+      os << errmsg_filtered << "\n";
+    }
+  }
 }
 
-Result
-Murxla::replay(uint64_t seed,
-               const std::string& out_file_name,
-               const std::string& err_file_name,
-               const std::string& api_trace_file_name,
-               const std::string& untrace_file_name)
+void
+Murxla::persist_trace(uint64_t seed,
+                      OutputBuffer& trace,
+                      const std::string& api_trace_file_name)
 {
-  Result res = run(seed,
-                   0,
-                   out_file_name,
-                   err_file_name,
-                   api_trace_file_name,
-                   untrace_file_name,
-                   true,
-                   false,
-                   TO_FILE);
+  /* For the SMT2 solver, we only write the SMT2 file (not the trace). */
+  bool is_smt2 = !d_options.dd && d_options.solver == SOLVER_SMT2;
+  std::string file_name =
+      is_smt2 ? get_smt2_file_name(seed, d_options.untrace_file_name)
+              : api_trace_file_name;
+
+  if (file_name != DEVNULL)
+  {
+    // Create parent directories if they do not exist yet.
+    std::filesystem::path fp(file_name);
+    if (fp.has_parent_path() && !std::filesystem::exists(fp.parent_path()))
+    {
+      std::filesystem::create_directories(fp.parent_path());
+    }
+    trace.write_to_file(file_name);
+    if (!is_smt2)
+    {
+      convert_to_binary_trace(file_name);
+    }
+  }
 
   if (d_options.dd)
   {
     DD(this, seed).run(api_trace_file_name, d_options.dd_trace_file_name);
   }
-  return res;
+}
+
+void
+Murxla::convert_to_binary_trace(const std::string& api_trace_file_name) const
+{
+  /* Delta debugging operates on text traces. */
+  if (!d_options.binary_trace || d_options.dd) return;
+
+  std::string tmp_file_name = get_tmp_file_path(BINARY_TRACE, d_tmp_dir);
+  convert_trace(api_trace_file_name, tmp_file_name);
+  std::filesystem::copy(tmp_file_name,
+                        api_trace_file_name,
+                        std::filesystem::copy_options::overwrite_existing);
 }
 
 Solver*
@@ -531,7 +1341,11 @@ Murxla::new_solver(SolverSeedGenerator& sng,
   }
   else if (solver_kind == SOLVER_SMT2)
   {
-    return new smt2::Smt2Solver(sng, smt2_out, d_options.solver_binary);
+    return new smt2::Smt2Solver(sng,
+                                smt2_out,
+                                d_options.solver_binary,
+                                d_options.time,
+                                d_options.smt2_pipelined);
   }
   MURXLA_CHECK(true) << "no solver created";
   return nullptr;
@@ -541,18 +1355,45 @@ Solver*
 Murxla::create_solver(SolverSeedGenerator& sng, std::ostream& smt2_out) const
 {
   Solver* solver = new_solver(sng, d_options.solver, smt2_out);
+  /* The solvers that run on separate threads with --check-concurrent. */
+  std::vector<const Solver*> solvers = {solver};
 
   /* If unsat core checking is enabled wrap solver with a CheckSolver. */
   if (d_options.check_solver)
   {
     Solver* reference_solver = new_solver(sng, d_options.check_solver_name);
-    solver                   = new CheckSolver(sng, solver, reference_solver);
+    solvers.push_back(reference_solver);
+    solver = new CheckSolver(
+        sng, solver, reference_solver, d_options.check_concurrent);
   }
 
   if (!d_options.cross_check.empty())
   {
     Solver* reference_solver = new_solver(sng, d_options.cross_check);
-    solver = new shadow::ShadowSolver(sng, solver, reference_solver);
+    solvers.push_back(reference_solver);
+    solver = new shadow::ShadowSolver(
+        sng, solver, reference_solver, d_options.check_concurrent);
+  }
+
+  /* Solvers that share process-global state must not run concurrently, two
+   * instances of the same solver library are never run concurrently. This
+   * is checked when the solver profile is loaded, i.e., before any test run
+   * is executed. */
+  if (d_options.check_concurrent && solvers.size() > 1)
+  {
+    for (size_t i = 0; i < solvers.size(); ++i)
+    {
+      MURXLA_EXIT_ERROR_CONFIG(!solvers[i]->is_reentrant())
+          << "option --check-concurrent not supported for solver '"
+          << solvers[i]->get_name() << "', which is not reentrant";
+      for (size_t j = i + 1; j < solvers.size(); ++j)
+      {
+        MURXLA_EXIT_ERROR_CONFIG(solvers[i]->get_name()
+                                 == solvers[j]->get_name())
+            << "option --check-concurrent requires different solvers, but '"
+            << solvers[i]->get_name() << "' is used more than once";
+      }
+    }
   }
 
   return solver;
@@ -564,15 +1405,33 @@ Murxla::create_fsm(RNGenerator& rng,
                    std::ostream& trace,
                    std::ostream& smt2_out,
                    bool record_stats,
-                   bool in_untrace_replay_mode) const
+                   bool in_untrace_replay_mode,
+                   const adaptive::WeightMap& action_weights,
+                   const adaptive::WeightMap& op_weights) const
 {
   /* Dummy statistics object for the cases were we don't want to record
-   * statistics (replay, dd). */
-  statistics::Statistics dummy_stats;
-
-  if (!d_options.cmd_line_trace.empty())
+   * statistics (replay, dd). Static since the FSM keeps a pointer to it,
+   * zero-initialized since operator entries are looked up by kind. */
+  static statistics::Statistics dummy_stats;
+
+  /* Adapted weights are recorded to reproduce the test run with its seed,
+   * weights given via options are already recorded. */
+  std::string cmd_line_trace = d_options.cmd_line_trace;
+  if (d_adaptive_weights && !in_untrace_replay_mode)
+  {
+    if (!action_weights.empty())
+    {
+      cmd_line_trace +=
+          " --action-weights " + adaptive::to_string(action_weights);
+    }
+    if (!op_weights.empty())
+    {
+      cmd_line_trace += " --op-weights " + adaptive::to_string(op_weights);
+    }
+  }
+  if (!cmd_line_trace.empty())
   {
-    trace << d_options.cmd_line_trace << std::endl;
+    trace << cmd_line_trace << std::endl;
   }
 
   return FSM(rng,
@@ -601,7 +1460,15 @@ Murxla::print_fsm() const
   std::ofstream file_smt2_out = open_output_file(DEVNULL, false);
   std::ostream smt2_out(std::cout.rdbuf());
   smt2_out.rdbuf(file_smt2_out.rdbuf());
-  FSM fsm = create_fsm(rng, sng, std::cout, smt2_out, false, false);
+  FSM fsm = create_fsm(rng,
+                       sng,
+                       std::cout,
+                       smt2_out,
+                       false,
+                       false,
+                       d_options.action_weights,
+                       d_options.op_weights);
+  fsm.set_weight_factors(d_options.action_weights, d_options.op_weights);
   fsm.configure();
   fsm.print();
 }
@@ -609,8 +1476,6 @@ Murxla::print_fsm() const
 Result
 Murxla::run_aux(uint64_t seed,
                 double time,
-                const std::string& file_out,
-                const std::string& file_err,
                 std::string& api_trace_file_name,
                 const std::string& untrace_file_name,
                 bool run_forked,
@@ -618,20 +1483,22 @@ Murxla::run_aux(uint64_t seed,
                 Murxla::TraceMode trace_mode,
                 std::string& error_msg)
 {
-  int32_t status, fd;
+  int32_t status;
   Result result;
-  pid_t pid_solver = 0, pid_timeout = 0;
+  pid_t pid_solver = 0;
   std::ofstream file_trace, file_smt2;
+  std::unique_ptr<TraceBuffer> trace_buffer;
   std::ostream smt2_out(std::cout.rdbuf());
   std::ostream trace(std::cout.rdbuf());
 
+  /* Output that is not recorded is discarded by streams without a stream
+   * buffer, which skip formatting (see SolverManager::is_tracing()). */
   if (trace_mode == NONE)
   {
-    file_trace = open_output_file(DEVNULL, false);
-    trace.rdbuf(file_trace.rdbuf());
+    trace.rdbuf(nullptr);
     if (d_options.solver == SOLVER_SMT2)
     {
-      smt2_out.rdbuf(file_trace.rdbuf());
+      smt2_out.rdbuf(nullptr);
     }
   }
   else if (trace_mode == TO_FILE)
@@ -644,8 +1511,18 @@ Murxla::run_aux(uint64_t seed,
     {
       api_trace_file_name = get_tmp_file_path(API_TRACE, d_tmp_dir);
     }
-    file_trace = open_output_file(api_trace_file_name, false);
-    trace.rdbuf(file_trace.rdbuf());
+    /* When running forked, the trace is written into a memory mapping of the
+     * trace file, which does not require flushing after each trace line. */
+    if (run_forked)
+    {
+      trace_buffer.reset(new TraceBuffer(api_trace_file_name));
+      trace.rdbuf(trace_buffer.get());
+    }
+    else
+    {
+      file_trace = open_output_file(api_trace_file_name, false);
+      trace.rdbuf(file_trace.rdbuf());
+    }
     if (d_options.solver == SOLVER_SMT2)
     {
       std::string smt2_file_name = get_tmp_file_path(SMT2_FILE, d_tmp_dir);
@@ -653,6 +1530,11 @@ Murxla::run_aux(uint64_t seed,
       smt2_out.rdbuf(file_smt2.rdbuf());
     }
   }
+  else if (trace_mode == TO_BUFFER)
+  {
+    assert(run_forked);
+    trace_buffer = trace_to_buffer(trace, smt2_out);
+  }
   else
   {
     assert(trace_mode == TO_STDOUT);
@@ -660,20 +1542,10 @@ Murxla::run_aux(uint64_t seed,
      * stdout. */
     if (d_options.solver == SOLVER_SMT2 || d_options.solver_trace)
     {
-      file_trace = open_output_file(DEVNULL, false);
-      trace.rdbuf(file_trace.rdbuf());
+      trace.rdbuf(nullptr);
     }
   }
 
-  /* The global random number generator. Used everywhere, except for in the
-   * solvers, which maintain their own RNG, seed with seeds from the solver
-   * seed generator. This guarantees that runs can be reproduced even when
-   * solvers use the RNG in their API wrapper functions. */
-  RNGenerator rng(seed);
-  /* The solver seed generator.  Responsible for generating seeds to be used to
-   * seed the random generator of the solver. */
-  SolverSeedGenerator sng(seed);
-
   result = RESULT_UNKNOWN;
 
   /* If seeded, run in main process. */
@@ -687,75 +1559,37 @@ Murxla::run_aux(uint64_t seed,
   /* parent */
   if (pid_solver)
   {
-    /* If a time limit is given, fork another process that kills the pid_solver
-     * after time seconds. (https://stackoverflow.com/a/8020324) */
-    if (time != 0)
+    /* Kill the solver process if it exceeds the time limit. */
+    Watchdog watchdog([this](pid_t pid) { interrupt(pid); });
+    watchdog.watch(pid_solver, time);
+    Watchdog::Event event = watchdog.wait();
+    assert(event.d_pid == pid_solver);
+    status      = event.d_status;
+    d_run_usage = event.d_usage;
+
+    /* Truncate the trace file to the length recorded by the child. */
+    if (trace_buffer)
     {
-      pid_timeout = fork();
-
-      MURXLA_CHECK(pid_timeout >= 0) << "forking timeout process failed";
-
-      if (pid_timeout == 0)
-      {
-        signal(SIGINT, SIG_DFL);  // reset stats signal handler
-        usleep(static_cast<useconds_t>(time * 1000000));
-        exit(EXIT_OK);
-      }
+      TraceBuffer::truncate(trace_mode == TO_BUFFER ? d_run_trace->get_path()
+                                                    : api_trace_file_name);
     }
 
-    /* Wait for the first process to finish (pid_solver or pid_timeout). */
-    pid_t exited_pid = wait(&status);
+    if (record_stats)
+    {
+      record_run_usage();
+    }
 
-    if (exited_pid == pid_solver)
+    if (event.d_timeout)
     {
-      /* Kill and collect timeout process if solver process terminated first. */
-      if (pid_timeout)
-      {
-        kill(pid_timeout, SIGKILL);
-        waitpid(pid_timeout, nullptr, 0);
-      }
-      if (WIFEXITED(status))
-      {
-        switch (WEXITSTATUS(status))
-        {
-          case EXIT_OK: result = RESULT_OK; break;
-          case EXIT_ERROR_CONFIG: result = RESULT_ERROR_CONFIG; break;
-          case EXIT_ERROR_UNTRACE: result = RESULT_ERROR_UNTRACE; break;
-          default:
-            assert(WEXITSTATUS(status) == EXIT_ERROR);
-            result = RESULT_ERROR;
-        }
-      }
-      else if (WIFSIGNALED(status))
-      {
-        result = RESULT_ERROR;
-      }
-      if (result == RESULT_ERROR_CONFIG || result == RESULT_ERROR_UNTRACE)
-      {
-        std::ifstream ferr(file_err);
-        std::stringstream ss;
-        ss << ferr.rdbuf();
-        error_msg = ss.str();
-      }
+      result = RESULT_TIMEOUT;
     }
     else
     {
-      /* Kill and collect solver process if time limit is exceeded. */
-      assert(pid_timeout);
-#ifdef MURXLA_COVERAGE
-      /* Try to trigger the abort handler to dump coverage information. */
-      kill(pid_solver, SIGABRT);
-      usleep(100);
-#endif
-      /* Signal the SMT2 solver to kill the online solver process. */
-      if (d_options.solver == SOLVER_SMT2 && !d_options.solver_binary.empty())
+      result = get_result(status);
+      if (result == RESULT_ERROR_CONFIG || result == RESULT_ERROR_UNTRACE)
       {
-        kill(pid_solver, SIGINT);
-        usleep(100);
+        error_msg = d_run_err->str();
       }
-      kill(pid_solver, SIGKILL);
-      waitpid(pid_solver, nullptr, 0);
-      result = RESULT_TIMEOUT;
     }
   }
   /* child */
@@ -768,70 +1602,158 @@ Murxla::run_aux(uint64_t seed,
 
     if (run_forked)
     {
-      /* Redirect stdout and stderr of child process into given files. */
-      fd = open(
-          file_out.c_str(), O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR);
-
-      MURXLA_EXIT_ERROR_FORK(fd < 0, true)
-          << "unable to open file " << file_out;
-      dup2(fd, STDOUT_FILENO);
-      close(fd);
-      fd = open(
-          file_err.c_str(), O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR);
-      if (fd < 0)
-      {
-        perror(0);
-        MURXLA_EXIT_ERROR_FORK(true, true)
-            << "unable to open file " << file_err;
-      }
-      dup2(fd, STDERR_FILENO);
-      close(fd);
+      /* Redirect stdout and stderr of child process into output buffers. */
+      d_run_out->redirect(STDOUT_FILENO);
+      d_run_err->redirect(STDERR_FILENO);
     }
 
-    try
+    run_fsm(
+        seed, trace, smt2_out, untrace_file_name, run_forked, record_stats);
+
+    if (file_trace.is_open()) file_trace.close();
+    if (trace_buffer) trace_buffer->close();
+
+    if (run_forked)
+    {
+      exit(EXIT_OK);
+    }
+    else
     {
-      FSM fsm = create_fsm(
-          rng, sng, trace, smt2_out, record_stats, !untrace_file_name.empty());
+      result = RESULT_OK;
+    }
+  }
+
+  return result;
+}
+
+void
+Murxla::run_fsm(uint64_t seed,
+                std::ostream& trace,
+                std::ostream& smt2_out,
+                const std::string& untrace_file_name,
+                bool run_forked,
+                bool record_stats,
+                bool checkpoint)
+{
+  /* The global random number generator. Used everywhere, except for in the
+   * solvers, which maintain their own RNG, seed with seeds from the solver
+   * seed generator. This guarantees that runs can be reproduced even when
+   * solvers use the RNG in their API wrapper functions. */
+  RNGenerator rng(seed);
+  /* The solver seed generator.  Responsible for generating seeds to be used to
+   * seed the random generator of the solver. */
+  SolverSeedGenerator sng(seed);
 
-      fsm.configure();
+  /* The weight factors of actions and operators, adapted by the parent
+   * process in continuous mode. */
+  adaptive::WeightMap action_weights = d_options.action_weights;
+  adaptive::WeightMap op_weights     = d_options.op_weights;
+  if (d_adaptive_weights && untrace_file_name.empty())
+  {
+    d_adaptive_weights->get(action_weights, op_weights);
+  }
 
-      /* replay/untrace given API trace */
-      if (!untrace_file_name.empty())
+  try
+  {
+    FSM fsm = create_fsm(rng,
+                         sng,
+                         trace,
+                         smt2_out,
+                         record_stats,
+                         !untrace_file_name.empty(),
+                         action_weights,
+                         op_weights);
+
+    /* With adaptive weights, the coverage feedback is already accounted for
+     * in the adapted weights unless it is recorded per worker. */
+    bool use_feedback =
+        record_stats && (!d_adaptive_weights || d_options.jobs > 1);
+    fsm.set_coverage_feedback(use_feedback ? d_feedback : nullptr);
+    fsm.set_weight_factors(action_weights, op_weights);
+    fsm.configure();
+
+    /* replay/untrace given API trace */
+    if (!untrace_file_name.empty())
+    {
+      if (checkpoint)
       {
-        fsm.untrace(untrace_file_name);
+        fsm.untrace(untrace_file_name, [this](uint32_t nlines) {
+          return checkpoint_replay(nlines);
+        });
       }
-      /* regular MBT run */
       else
       {
-        fsm.run();
+        fsm.untrace(untrace_file_name);
       }
     }
-    catch (MurxlaConfigException& e)
-    {
-      MURXLA_EXIT_ERROR_CONFIG_FORK(true, run_forked) << e.get_msg();
-    }
-    catch (MurxlaUntraceException& e)
-    {
-      MURXLA_EXIT_ERROR_UNTRACE_FORK(true, run_forked) << e.get_msg();
-    }
-    catch (MurxlaException& e)
+    /* regular MBT run */
+    else
     {
-      MURXLA_EXIT_ERROR_FORK(true, run_forked) << e.get_msg();
+      fsm.run();
     }
+  }
+  catch (MurxlaConfigException& e)
+  {
+    MURXLA_EXIT_ERROR_CONFIG_FORK(true, run_forked) << e.get_msg();
+  }
+  catch (MurxlaUntraceException& e)
+  {
+    MURXLA_EXIT_ERROR_UNTRACE_FORK(true, run_forked) << e.get_msg();
+  }
+  catch (MurxlaException& e)
+  {
+    MURXLA_EXIT_ERROR_FORK(true, run_forked) << e.get_msg();
+  }
+}
 
-    if (file_trace.is_open()) file_trace.close();
-
-    if (run_forked)
-    {
-      exit(EXIT_OK);
-    }
-    else
+std::unique_ptr<TraceBuffer>
+Murxla::trace_to_buffer(std::ostream& trace, std::ostream& smt2_out) const
+{
+  std::unique_ptr<TraceBuffer> trace_buffer(
+      new TraceBuffer(d_run_trace->get_path()));
+  /* For the SMT2 solver, we only capture the SMT2 output (see run()). */
+  if (!d_options.dd && d_options.solver == SOLVER_SMT2)
+  {
+    trace.rdbuf(nullptr);
+    smt2_out.rdbuf(trace_buffer.get());
+  }
+  else
+  {
+    trace.rdbuf(trace_buffer.get());
+    if (d_options.solver == SOLVER_SMT2)
     {
-      result = RESULT_OK;
+      smt2_out.rdbuf(nullptr);
     }
   }
+  return trace_buffer;
+}
 
-  return result;
+void
+Murxla::interrupt(pid_t pid) const
+{
+#ifdef MURXLA_COVERAGE
+  /* Try to trigger the abort handler to dump coverage information. */
+  kill(pid, SIGABRT);
+  usleep(100);
+#endif
+  /* Signal the SMT2 solver to kill the online solver process. */
+  if (d_options.solver == SOLVER_SMT2 && !d_options.solver_binary.empty())
+  {
+    kill(pid, SIGINT);
+    usleep(100);
+  }
+}
+
+void
+Murxla::record_run_usage()
+{
+  ++d_stats->d_runs;
+  d_stats->d_runs_wall_time += to_usecs(d_run_usage.d_wall_time);
+  d_stats->d_runs_cpu_time += to_usecs(d_run_usage.d_cpu_time);
+  d_stats->d_runs_max_wall_time = std::max(d_stats->d_runs_max_wall_time,
+                                           to_usecs(d_run_usage.d_wall_time));
+  d_stats->d_runs_max_rss =
+      std::max(d_stats->d_runs_max_rss, d_run_usage.d_max_rss);
 }
 
 std::string
@@ -841,7 +1763,7 @@ Murxla::filter_error(const std::string& err)
   for (const auto& re : d_error_filters)
   {
     std::smatch sm;
-    std::regex_search(err, sm, std::regex(re));
+    std::regex_search(err, sm, re);
     if (sm.size() == 1)
     {
       res = sm[0];
@@ -858,40 +1780,37 @@ Murxla::add_error(const std::string& err, uint64_t seed)
   std::string err_norm = normalize_asan_error(filtered_err);
 
   /* Filter errors if specified in the solver profile. */
-  for (const auto& e : d_exclude_errors)
+  for (const auto& re : d_exclude_regex)
   {
     std::smatch sm;
-    std::regex_search(filtered_err, sm, std::regex(e));
+    std::regex_search(filtered_err, sm, re);
     if (!sm.empty())
     {
       return std::make_tuple(ErrorKind::FILTER, filtered_err, 0, 0);
     }
-
-    /* Errors are classified as the same error if they differ in at most 5% of
-     * characters. */
-    if (error_diff(err_norm, e) <= 0.05)
-    {
-      return std::make_tuple(ErrorKind::FILTER, filtered_err, 0, 0);
-    }
   }
 
-  for (auto& p : *d_errors)
+  /* Errors are classified as the same error if they differ in at most
+   * ErrorIndex::MAX_DIFF of their (non-numeric) tokens. Candidates are looked
+   * up via the canonical form, the location fingerprint and the MinHash bands
+   * of the normalized error message (see ErrorIndex). */
+  if (d_exclude_index.find(err_norm))
   {
-    const auto& e_norm = p.first;
-    auto& e_info       = p.second;
+    return std::make_tuple(ErrorKind::FILTER, filtered_err, 0, 0);
+  }
 
-    /* Errors are classified as the same error if they differ in at most 5% of
-     * characters. */
-    if (error_diff(err_norm, e_norm) <= 0.05)
-    {
-      e_info.seeds.push_back(seed);
-      return std::make_tuple(
-          ErrorKind::DUPLICATE, filtered_err, e_info.id, e_info.seeds.size());
-    }
+  const std::string* e_norm = d_error_index.find(err_norm);
+  if (e_norm)
+  {
+    auto& e_info = d_errors->at(*e_norm);
+    e_info.seeds.push_back(seed);
+    return std::make_tuple(
+        ErrorKind::DUPLICATE, filtered_err, e_info.id, e_info.seeds.size());
   }
 
   d_errors->emplace(err_norm,
                     ErrorInfo(d_errors->size() + 1, filtered_err, {seed}));
+  d_error_index.add(err_norm);
 
   // Export errors to JSON file.
   if (!d_options.export_errors_filename.empty())
@@ -927,9 +1846,76 @@ Murxla::load_solver_profile()
   d_solver_profile.reset(new SolverProfile(profile));
   auto errors = d_solver_profile->get_excluded_errors();
   d_exclude_errors.insert(errors.begin(), errors.end());
-  auto error_filters = d_solver_profile->get_error_filters();
-  d_error_filters.insert(
-      d_error_filters.end(), error_filters.begin(), error_filters.end());
+  for (const auto& e : d_exclude_errors)
+  {
+    d_exclude_index.add(e);
+    /* Excluded errors are not necessarily valid regular expressions (e.g.,
+     * errors exported via --export-errors), these are only matched via
+     * d_exclude_index. */
+    try
+    {
+      d_exclude_regex.emplace_back(e, std::regex::optimize);
+    }
+    catch (std::regex_error& err)
+    {
+      MURXLA_WARN(true) << "excluded error '" << e
+                        << "' is not a valid regular expression ("
+                        << err.what()
+                        << "), only matching it as error message";
+    }
+  }
+  for (const auto& f : d_solver_profile->get_error_filters())
+  {
+    try
+    {
+      d_error_filters.emplace_back(f, std::regex::optimize);
+    }
+    catch (std::regex_error& e)
+    {
+      MURXLA_EXIT_ERROR_CONFIG(true)
+          << "invalid error filter '" << f << "' in solver profile: "
+          << e.what();
+    }
+  }
+}
+
+void
+Murxla::preinitialize()
+{
+  d_solver_profile->precompute();
+
+  /* Solver options are only fuzzed if not in SMT-LIB compliant mode (see
+   * FSM::configure()). Querying all options of a solver requires creating a
+   * solver instance and is thus rather expensive. */
+  if (!d_options.fuzz_options || d_options.smtlib_compliant
+      || !d_solver_options->empty())
+  {
+    return;
+  }
+
+  RNGenerator rng(0);
+  SolverSeedGenerator sng(0);
+  statistics::Statistics stats;
+  std::ofstream trace = open_output_file(DEVNULL, false);
+  Solver* solver      = create_solver(sng);
+  SolverManager smgr(solver,
+                     *d_solver_profile,
+                     rng,
+                     sng,
+                     trace,
+                     *d_solver_options,
+                     d_options.arith_linear,
+                     d_options.simple_symbols,
+                     &stats,
+                     d_options.enabled_theories,
+                     d_options.disabled_theories);
+  solver->configure_options(&smgr);
+}
+
+bool
+Murxla::is_smt2_offline() const
+{
+  return d_options.solver == SOLVER_SMT2 && d_options.solver_binary.empty();
 }
 
 std::string
@@ -11,14 +11,22 @@
 #define __MURXLA__MURXLA_H
 
 #include <cstdint>
+#include <memory>
+#include <regex>
 #include <string>
 
 #include "action.hpp"
+#include "adaptive_weights.hpp"
+#include "coverage.hpp"
+#include "error_index.hpp"
 #include "options.hpp"
+#include "output_buffer.hpp"
 #include "result.hpp"
 #include "solver/solver_profile.hpp"
 #include "solver_option.hpp"
 #include "theory.hpp"
+#include "util.hpp"
+#include "watchdog.hpp"
 
 namespace murxla {
 
@@ -28,6 +36,7 @@ namespace statistics {
 struct Statistics;
 };
 class Solver;
+class TraceBuffer;
 
 /* -------------------------------------------------------------------------- */
 
@@ -53,10 +62,16 @@ class Murxla
     NONE,
     TO_STDOUT,
     TO_FILE,
+    /**
+     * Trace into an in-memory buffer (see d_run_trace), only for forked runs.
+     * The buffer is only written to disk when the run revealed an error.
+     */
+    TO_BUFFER,
   };
 
-  inline static const std::string API_TRACE = "tmp-api.trace";
-  inline static const std::string SMT2_FILE = "tmp-smt2.smt2";
+  inline static const std::string API_TRACE    = "tmp-api.trace";
+  inline static const std::string BINARY_TRACE = "tmp-api.btrace";
+  inline static const std::string SMT2_FILE    = "tmp-smt2.smt2";
 
   /** Constructor. */
   Murxla(statistics::Statistics* stats,
@@ -72,6 +87,9 @@ class Murxla
    * double             : The time limit for one test run.
    * file_out           : The file to write stdout output of a test run to.
    * file_err           : The file to write stderr output of a test run to.
+   *                      When running forked, the output is captured in
+   *                      memory (see d_run_out and d_run_err) and only
+   *                      written to these files if they are not DEVNULL.
    * api_trace_file_name: When non-empty, trace is immediately written to file
    *                      if 'run_forked' is false. Else, 'api_trace_file_name'
    *                      is set to the name of the temp trace file name and
@@ -96,12 +114,53 @@ class Murxla
              bool record_stats,
              TraceMode trace_mode);
 
-  /** Continuous test run. */
+  /**
+   * Continuous test run.
+   *
+   * If more than one job is configured, test runs are distributed over the
+   * configured number of worker processes (see test_parallel()).
+   */
   void test();
 
   /** Print the current configuration of the FSM to stdout. */
   void print_fsm() const;
 
+  /**
+   * Prepare this instance for running tests in a forked process concurrently
+   * to its parent and siblings. The forked process gets its own directory
+   * for temp files and does not share output buffers with the parent.
+   *
+   * @param tmp_dir  The directory for temp files of the forked process.
+   */
+  void detach(const std::string& tmp_dir);
+
+  /**
+   * Replay given trace in a forked process while delta debugging.
+   *
+   * The replay process takes a snapshot of itself every
+   * d_options.dd_checkpoint trace lines (see ReplaySnapshots). The snapshots
+   * are kept across calls, and a trace is resumed from the deepest snapshot
+   * whose replayed lines are a prefix of the trace, only the remaining lines
+   * are replayed.
+   *
+   * @param seed               The seed for the RNG.
+   * @param time               The time limit for the replay.
+   * @param file_out           The file to write stdout output of the replay
+   *                           to.
+   * @param file_err           The file to write stderr output of the replay
+   *                           to.
+   * @param untrace_file_name  The name of the trace file to replay.
+   * @return  A result that indicates the status of the replay.
+   */
+  Result replay(uint64_t seed,
+                double time,
+                const std::string& file_out,
+                const std::string& file_err,
+                const std::string& untrace_file_name);
+
+  /** Terminate the snapshots of replay(), if any. */
+  void stop_replay();
+
   /**
    * Create solver.
    *
@@ -134,6 +193,199 @@ class Murxla
     FILTER,    /* Error message filtered out. */
   };
 
+  /** The status of a continuous test run, used for printing progress. */
+  struct TestStatus
+  {
+    /** The number of finished test runs. */
+    uint32_t num_runs = 0;
+    /** The number of test runs that ran into a timeout. */
+    uint64_t num_timeouts = 0;
+    /** The number of printed status lines since the last header. */
+    uint64_t num_printed_lines = 0;
+    /** The wall clock time the continuous test run was started. */
+    double start_time = 0;
+    /** The terminal to print to. */
+    Terminal term;
+  };
+
+  /** The result of a test run as reported by a worker process. */
+  struct WorkerResult
+  {
+    /** The seed of the test run. */
+    uint64_t seed;
+    /** The result of the test run. */
+    Result result;
+    /** The resources used by the test run. */
+    ResourceUsage usage;
+    /** The size of the error message that follows. */
+    size_t errmsg_size;
+  };
+
+  /**
+   * A persistent test run process, which executes the test runs of the seeds
+   * it receives from its parent until it terminates abnormally, runs into a
+   * timeout, or executed d_options.persistent_runs test runs.
+   */
+  struct PersistentProcess
+  {
+    /** The pid of the process, 0 if no process is running. */
+    pid_t pid = 0;
+    /** The file descriptor to write seeds to. */
+    int32_t fd_seeds = -1;
+    /** The file descriptor to read the results of test runs from. */
+    int32_t fd_results = -1;
+    /** The number of test runs executed by the process. */
+    uint32_t num_runs = 0;
+    /** The CPU time used by the process up to its last finished test run. */
+    double cpu_time = 0;
+  };
+
+  /**
+   * The snapshots of the replay process of replay().
+   *
+   * The replay process forks when it reaches a checkpoint (see
+   * checkpoint_replay()). The parent stays at the current trace line as a
+   * snapshot, the child continues replaying. Each snapshot is thus the parent
+   * of the next deeper snapshot, and relays the messages of its descendants
+   * (see ReplayMessage) to its parent. A request to replay a trace, i.e., the
+   * depth of the snapshot to resume from, is forwarded down the chain of
+   * snapshots. The snapshot at the requested depth terminates its
+   * descendants and forks a new replay process that continues with the lines
+   * of the trace after the lines of the snapshot.
+   */
+  struct ReplaySnapshots
+  {
+    /** The pid of the root of the chain of snapshots, 0 if not running. */
+    pid_t pid = 0;
+    /** The file descriptor to write requests to. */
+    int32_t fd_requests = -1;
+    /** The file descriptor to read messages from. */
+    int32_t fd_messages = -1;
+    /** The seed of the replays. */
+    uint64_t seed = 0;
+    /** The name of the replayed trace file. */
+    std::string untrace_file_name;
+    /** The lines of the last replayed trace. */
+    std::vector<std::string> lines;
+    /** The number of replayed lines of the snapshots, ordered by depth. */
+    std::vector<uint32_t> nlines;
+  };
+
+  /** The state of a replay process or snapshot of replay(). */
+  struct ReplayProcess
+  {
+    /** The file descriptor to read requests from the parent from. */
+    int32_t fd_requests = -1;
+    /** The file descriptor to write messages to the parent to. */
+    int32_t fd_messages = -1;
+    /** The depth of the snapshot this process was forked from, 0 if none. */
+    uint32_t depth = 0;
+    /** The number of replayed lines of that snapshot. */
+    uint32_t nlines = 0;
+    /** The name of the trace file to replay when resuming. */
+    std::string untrace_file_name;
+  };
+
+  /** A message sent up the chain of snapshots of replay(). */
+  struct ReplayMessage
+  {
+    /** The depth of a new snapshot, 0 if the replay terminated. */
+    uint32_t depth;
+    /** The number of replayed lines of the new snapshot. */
+    uint32_t nlines;
+    /** The exit status of the terminated replay process. */
+    int32_t status;
+  };
+
+  /**
+   * Continuous test run with d_options.jobs worker processes.
+   *
+   * Each worker is a forked copy of this Murxla instance with its own temp
+   * directory and its own shared memory statistics object. Workers receive
+   * seeds from the parent and report the result of each test run back to the
+   * parent, which deduplicates errors, prints the status, persists the traces
+   * of error inducing runs, and aggregates the statistics of all workers.
+   * The API trace of the last test run of a worker is captured in a buffer
+   * shared with the parent, which stays valid until the parent dispatches the
+   * next seed to the worker.
+   */
+  void test_parallel();
+
+  /**
+   * The main loop of a worker process.
+   * Reads seeds from 'fd_seeds' until the end of file is reached and writes
+   * the result of each test run to 'fd_results'. Never returns.
+   *
+   * @param fd_seeds    The file descriptor to read seeds from.
+   * @param fd_results  The file descriptor to write results to.
+   */
+  [[noreturn]] void run_worker(int32_t fd_seeds, int32_t fd_results);
+
+  /**
+   * Create the output buffers of forked test runs (d_run_out, d_run_err and
+   * d_run_trace) if necessary, and reset them.
+   */
+  void reset_run_buffers();
+
+  /**
+   * A single test run of a continuous test run. Uses the persistent test run
+   * process if configured, else forks a new process for the test run.
+   * Updates the coverage feedback with the result of the test run if
+   * enabled.
+   *
+   * @param seed  The seed of the test run.
+   * @return  A result that indicates the status of the test run.
+   */
+  Result run_test(uint64_t seed);
+
+  /**
+   * A single test run in the persistent test run process (see d_persistent),
+   * which is started if it is not running. The parent tracks the seed of the
+   * test run in flight, and the process is replaced after a crash, a timeout,
+   * or after d_options.persistent_runs test runs.
+   *
+   * @param seed  The seed of the test run.
+   * @param time  The time limit for the test run.
+   * @return  A result that indicates the status of the test run.
+   */
+  Result run_persistent(uint64_t seed, double time);
+
+  /** Stop the persistent test run process, if running. */
+  void stop_persistent();
+
+  /**
+   * The main loop of a persistent test run process.
+   * Reads seeds from 'fd_seeds' until the end of file is reached and writes
+   * its resource usage to 'fd_results' after each finished test run. Test
+   * runs that do not finish terminate the process. Never returns.
+   *
+   * @param fd_seeds    The file descriptor to read seeds from.
+   * @param fd_results  The file descriptor to write results to.
+   */
+  [[noreturn]] void run_persistent_process(int32_t fd_seeds,
+                                           int32_t fd_results);
+
+  /** Print the status line for the test run with given seed. */
+  void print_test_status(TestStatus& status, uint64_t seed) const;
+
+  /**
+   * Report the result of the continuous test run with given seed.
+   * Deduplicates errors and persists the traces of error inducing runs.
+   *
+   * @param status  The status of the continuous test run.
+   * @param seed    The seed of the test run.
+   * @param res     The result of the test run.
+   * @param usage   The resources used by the test run.
+   * @param errmsg  The stderr output of the test run if it returned an error.
+   * @param trace   The buffer holding the trace of the test run.
+   */
+  void report_test_result(TestStatus& status,
+                          uint64_t seed,
+                          Result res,
+                          const ResourceUsage& usage,
+                          const std::string& errmsg,
+                          OutputBuffer& trace);
+
   /**
    * Create solver.
    *
@@ -151,18 +403,24 @@ class Murxla
 
   /**
    * Create FSM.
-   * rng         : The global random number generator.
-   * sng         : The solver seed generator.
-   * trace       : The outputstream for the API trace.
-   * smt2_out    : The output stream for SMT-LIB output, if enabled.
-   * record_stats: True to record statistics.
+   * rng           : The global random number generator.
+   * sng           : The solver seed generator.
+   * trace         : The outputstream for the API trace.
+   * smt2_out      : The output stream for SMT-LIB output, if enabled.
+   * record_stats  : True to record statistics.
+   * action_weights: The weight factors of actions, recorded in the trace if
+   *                 adapted (see d_adaptive_weights).
+   * op_weights    : The weight factors of operators, recorded in the trace if
+   *                 adapted (see d_adaptive_weights).
    */
   FSM create_fsm(RNGenerator& rng,
                  SolverSeedGenerator& sng,
                  std::ostream& trace,
                  std::ostream& smt2_out,
                  bool record_stats,
-                 bool in_untrace_replay_mode) const;
+                 bool in_untrace_replay_mode,
+                 const adaptive::WeightMap& action_weights,
+                 const adaptive::WeightMap& op_weights) const;
 
   /**
    * Auxiliary helper for run().
@@ -170,8 +428,6 @@ class Murxla
    *
    * seed               : The current seed for the RNG.
    * double             : The time limit for one test run.
-   * file_out           : The file to write stdout output of a test run to.
-   * file_err           : The file to write stderr output of a test run to.
    * api_trace_file_name: When non-empty, trace is immediately written to file
    *                      if 'run_forked' is false. Else, 'api_trace_file_name'
    *                      is set to the name of the temp trace file name and
@@ -179,6 +435,8 @@ class Murxla
    *                      run(), after run_aux() is finished.
    * untrace_file_name  : When non-empty, the name of the trace file to replay.
    * run_forked         : True if test run is executed in a child process.
+   *                      The stdout and stderr output of the child process is
+   *                      redirected into d_run_out and d_run_err.
    * record_stats       : True if statistics for this test run should be
    *                      recorded. This should only be true for main test
    *                      runs, not for replayed runs or delta debugging runs.
@@ -188,8 +446,6 @@ class Murxla
    */
   Result run_aux(uint64_t seed,
                  double time,
-                 const std::string& file_out,
-                 const std::string& file_err,
                  std::string& api_trace_file_name,
                  const std::string& untrace_file_name,
                  bool run_forked,
@@ -198,21 +454,83 @@ class Murxla
                  std::string& error_msg);
 
   /**
-   * Replay a single test run.
+   * Run the FSM for the test run with given seed. Errors terminate the
+   * process if 'run_forked' is true.
    *
-   * seed               : The current seed for the RNG.
-   * out_file_name      : The name of the file to write stdout output to.
-   * err_file_name      : The name of the file to write stderr output to.
-   * api_trace_file_name: The name of the file to write the API trace to.
-   * untrace_file_name  : The name of the trace file to replay.
+   * seed             : The current seed for the RNG.
+   * trace            : The output stream for the API trace.
+   * smt2_out         : The output stream for SMT-LIB output, if enabled.
+   * untrace_file_name: When non-empty, the name of the trace file to replay.
+   * run_forked       : True if test run is executed in a child process.
+   * record_stats     : True if statistics for this test run should be
+   *                    recorded.
+   * checkpoint       : True to take snapshots of the replay process of
+   *                    replay(), see checkpoint_replay().
+   */
+  void run_fsm(uint64_t seed,
+               std::ostream& trace,
+               std::ostream& smt2_out,
+               const std::string& untrace_file_name,
+               bool run_forked,
+               bool record_stats,
+               bool checkpoint = false);
+
+  /**
+   * The untrace checkpoint callback of a replay process of replay(), see
+   * FSM::UntraceCheckpoint. Every d_options.dd_checkpoint trace lines, the
+   * process becomes a snapshot that serves replay requests until its parent
+   * terminates. The callback only returns in forked replay processes.
    *
-   * Returns a result that indicates the status of the test run.
+   * @param nlines  The number of replayed trace lines.
+   * @return  The name of the trace file to continue with, or the empty string
+   *          to continue with the current trace file.
    */
-  Result replay(uint64_t seed,
-                const std::string& out_file_name,
-                const std::string& err_file_name,
-                const std::string& api_trace_file_name,
-                const std::string& untrace_file_name);
+  std::string checkpoint_replay(uint32_t nlines);
+
+  /**
+   * Create the trace buffer for trace mode TO_BUFFER, which captures the
+   * trace into d_run_trace, and configure the output streams accordingly.
+   *
+   * @param trace     The output stream for the API trace.
+   * @param smt2_out  The output stream for SMT-LIB output.
+   * @return  The trace buffer, which must be closed by the test run process.
+   */
+  std::unique_ptr<TraceBuffer> trace_to_buffer(std::ostream& trace,
+                                               std::ostream& smt2_out) const;
+
+  /**
+   * Interrupt test run process with given pid before it is killed due to a
+   * timeout, to allow it to dump coverage information and to clean up the
+   * online solver process.
+   */
+  void interrupt(pid_t pid) const;
+
+  /** Record the resource usage of the last test run (d_run_usage). */
+  void record_run_usage();
+
+  /**
+   * Persist the trace of an error inducing test run that was captured in
+   * memory (trace mode TO_BUFFER), and delta debug it if enabled.
+   *
+   * For the SMT2 solver, the buffer holds the SMT-LIB output rather than the
+   * API trace (unless delta debugging is enabled), which is written to the
+   * SMT2 file of the test run.
+   *
+   * @param seed                 The seed of the test run.
+   * @param trace                The buffer holding the trace of the test run.
+   * @param api_trace_file_name  The name of the file to write the API trace
+   *                             to.
+   */
+  void persist_trace(uint64_t seed,
+                     OutputBuffer& trace,
+                     const std::string& api_trace_file_name);
+
+  /**
+   * Convert given API trace file into binary format (in place).
+   *
+   * @param api_trace_file_name  The name of the API trace file to convert.
+   */
+  void convert_to_binary_trace(const std::string& api_trace_file_name) const;
 
   /** Filter error messages based on filter regex provided in solver profile. */
   std::string filter_error(const std::string& err);
@@ -224,6 +542,18 @@ class Murxla
   /** Load solver profile of currently configured solver. */
   void load_solver_profile();
 
+  /**
+   * Pre-initialize the seed-independent parts of the test run setup, i.e.,
+   * cache solver profile queries and query the solver options to fuzz.
+   *
+   * This is done once in the parent process. All test runs are forked from it
+   * and thus inherit the pre-initialized data rather than recomputing it.
+   */
+  void preinitialize();
+
+  /** Return true if we dump SMT-LIB without an online solver. */
+  bool is_smt2_offline() const;
+
   std::string get_smt2_file_name(uint64_t seed,
                                  const std::string& untrace_file_name) const;
 
@@ -232,11 +562,48 @@ class Murxla
 
   /** Statistics of current test run(s). */
   statistics::Statistics* d_stats;
+  /** The resources used by the last forked test run. */
+  ResourceUsage d_run_usage;
+  /** The captured stdout output of the last forked test run. */
+  std::unique_ptr<OutputBuffer> d_run_out;
+  /** The captured stderr output of the last forked test run. */
+  std::unique_ptr<OutputBuffer> d_run_err;
+  /** The captured trace of the last forked test run in trace mode TO_BUFFER. */
+  std::unique_ptr<OutputBuffer> d_run_trace;
+  /** The persistent test run process (see run_persistent()). */
+  PersistentProcess d_persistent;
+  /** The snapshots of replay(). */
+  ReplaySnapshots d_replay;
+  /** The state of this process if it is a replay process of replay(). */
+  ReplayProcess d_replay_process;
+  /**
+   * The coverage feedback of the test runs of this process, created on
+   * demand in run_test() if enabled.
+   */
+  coverage::Feedback* d_feedback = nullptr;
+  /**
+   * The adaptive weights of actions and operators, created in test() if
+   * enabled. Updated by the parent process and read by test run processes.
+   */
+  adaptive::Weights* d_adaptive_weights = nullptr;
+  /**
+   * Statistics of the worker processes when running multiple jobs, merged
+   * into d_stats when all workers are finished.
+   */
+  std::vector<statistics::Statistics*> d_worker_stats;
   /** Map normalized error message to pair (original error message, seeds). */
   ErrorMap* d_errors;
 
+  /** The errors excluded via the solver profile. */
   std::unordered_set<std::string> d_exclude_errors;
-  std::vector<std::string> d_error_filters;
+  /** The precompiled regular expressions of the excluded errors. */
+  std::vector<std::regex> d_exclude_regex;
+  /** Index of the excluded errors for detecting near duplicates. */
+  ErrorIndex d_exclude_index;
+  /** The precompiled error filters of the solver profile. */
+  std::vector<std::regex> d_error_filters;
+  /** Index of the normalized messages of the errors in d_errors. */
+  ErrorIndex d_error_index;
 
   std::unique_ptr<SolverProfile> d_solver_profile;
 
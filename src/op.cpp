@@ -80,8 +80,12 @@ Op::get_arg_sort_kind(size_t i) const
 Op&
 OpKindManager::get_op(const Op::Kind& kind)
 {
-  if (d_op_kinds.find(kind) == d_op_kinds.end()) return d_op_undefined;
-  return d_op_kinds.at(kind);
+  uint32_t kind_id = kind.get_id();
+  if (kind_id >= d_ops_by_kind.size() || !d_ops_by_kind[kind_id])
+  {
+    return d_op_undefined;
+  }
+  return *d_ops_by_kind[kind_id];
 }
 
 void
@@ -465,7 +469,7 @@ OpKindManager::add_op_kind(const Op::Kind& kind,
     return;
   }
 
-  uint64_t id = d_op_kinds.size();
+  uint64_t id = d_stats->get_op_index(kind.c_str());
   if (id >= MURXLA_MAX_N_OPS)
   {
     throw MurxlaException(
@@ -503,9 +507,22 @@ OpKindManager::add_op_kind(const Op::Kind& kind,
     }
     sort_kinds_args.push_back(sk);
   }
-  d_op_kinds.emplace(
-      kind, Op(id, kind, arity, nidxs, sort_kinds, sort_kinds_args, theory));
-  strncpy(d_stats->d_op_kinds[id], kind.c_str(), kind.size());
+  auto it_op = d_op_kinds
+                   .emplace(kind,
+                            Op(id,
+                               kind,
+                               arity,
+                               nidxs,
+                               sort_kinds,
+                               sort_kinds_args,
+                               theory))
+                   .first;
+  uint32_t kind_id = kind.get_id();
+  if (kind_id >= d_ops_by_kind.size())
+  {
+    d_ops_by_kind.resize(kind_id + 1, nullptr);
+  }
+  d_ops_by_kind[kind_id] = &it_op->second;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -15,6 +15,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "interned_kind.hpp"
 #include "sort.hpp"
 
 namespace murxla {
@@ -29,7 +30,7 @@ struct Statistics;
 struct Op
 {
   /** The kind of an operator. */
-  using Kind = std::string;
+  using Kind = InternedKind<Op>;
 
   /**
    * \addtogroup op-kinds-internal
@@ -3492,10 +3493,13 @@ struct Op
    */
   SortKindSet get_arg_sort_kind(size_t i) const;
 
-  /** The operator id, assigned in the order operators have been created. */
+  /**
+   * The operator id, the index of the entry of its kind in the statistics
+   * (see statistics::Statistics::get_op_index()).
+   */
   uint64_t d_id = 0u;
   /** The operator kind. */
-  const Kind& d_kind = UNDEFINED;
+  Kind d_kind = UNDEFINED;
   /**
    * The arity (number of arguments) of this operator kind.
    *
@@ -3627,6 +3631,11 @@ class OpKindManager
 
   /** The set of enabled operator kinds. Maps Op::Kind to Op. */
   OpKindMap d_op_kinds;
+  /**
+   * The enabled operators indexed by the id of their kind (see
+   * InternedKind::get_id()), nullptr for kinds that are not enabled.
+   */
+  std::vector<Op*> d_ops_by_kind;
   /** The set of enabled theories. */
   TheorySet d_enabled_theories;
   /** Enabled sort kinds. */
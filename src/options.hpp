@@ -14,6 +14,7 @@
 #include <nlohmann/json.hpp>
 #include <string>
 
+#include "adaptive_weights.hpp"
 #include "theory.hpp"
 
 namespace murxla {
@@ -35,6 +36,29 @@ struct Options
   double time = 1;
   /** The maximum number of test runs to perform. */
   uint32_t max_runs = 0;
+  /** The number of test runs to execute in parallel in continuous mode. */
+  uint32_t jobs = 1;
+  /**
+   * The maximum number of test runs executed by a persistent test run
+   * process in continuous mode before it is replaced. The default of 1
+   * forks a new process for every test run.
+   */
+  uint32_t persistent_runs = 1;
+  /**
+   * True to weight actions and operators based on the solver coverage hit by
+   * previous test runs in continuous mode (see coverage::Feedback).
+   */
+  bool coverage_feedback = false;
+  /**
+   * True to periodically adapt the weights of actions and operators to their
+   * success rates in previous test runs in continuous mode (see
+   * adaptive::Weights).
+   */
+  bool adaptive_weights = false;
+  /** The factors (in percent) to scale the weights of actions with. */
+  adaptive::WeightMap action_weights;
+  /** The factors (in percent) to scale the weights of operators with. */
+  adaptive::WeightMap op_weights;
 
   /** True if seed is provided by user. */
   bool is_seeded = false;
@@ -44,6 +68,8 @@ struct Options
   bool smtlib_compliant = false;
   /** True to print statistics. */
   bool print_stats = false;
+  /** Output file for exporting statistics in JSON format. */
+  std::string stats_json_filename;
   /** True to print FSM configuration. */
   bool print_fsm = false;
   /** Restrict arithmetic operators to linear fragment. */
@@ -61,10 +87,19 @@ struct Options
   SolverKind solver;
   /** The path to the solver binary to test when --smt2 is enabled. */
   std::string solver_binary;
+  /**
+   * True to not wait for the response of the solver binary to commands that
+   * only respond with 'success'.
+   */
+  bool smt2_pipelined = false;
   /** The file to trace the API call sequence to. */
   std::string api_trace_file_name;
   /** The API trace file to replay. */
   std::string untrace_file_name;
+  /** True to write API traces in binary format. */
+  bool binary_trace = false;
+  /** The file to write the converted untrace file to. */
+  std::string convert_trace_file_name;
   /** The file to dump the SMT-LIB2 representation of the current trace to. */
   std::string smt2_file_name;
 
@@ -92,6 +127,17 @@ struct Options
   std::string dd_match_err;
   /** The file to write the reduced API trace to. */
   std::string dd_trace_file_name;
+  /**
+   * True to persist the results of delta debugging tests in the temp
+   * directory, such that repeated delta debugging sessions of the same trace
+   * skip already tested candidates.
+   */
+  bool dd_cache = false;
+  /**
+   * The number of trace lines between two snapshots of the replay process
+   * when delta debugging, 0 to replay each tested trace from the start.
+   */
+  uint32_t dd_checkpoint = 0;
 
   /** The name of the solver to cross-check given solver with. */
   std::string cross_check;
@@ -100,6 +146,11 @@ struct Options
   std::string check_solver_name;
   /** Whether unsat core/unsat assumptions/model checking is enabled. */
   bool check_solver = false;
+  /**
+   * True to run the cross-check and check solvers concurrently to the solver
+   * under test rather than in lock-step.
+   */
+  bool check_concurrent = false;
 
   /** Command line options that need to be set for enabled solver. */
   std::vector<std::pair<std::string, std::string>> solver_options;
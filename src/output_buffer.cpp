@@ -0,0 +1,116 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#include "output_buffer.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <vector>
+
+#include "except.hpp"
+#include "util.hpp"
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+OutputBuffer::OutputBuffer(const std::string& name, const std::string& tmp_dir)
+{
+#ifdef __linux__
+  d_fd = memfd_create(name.c_str(), MFD_CLOEXEC);
+#endif
+  /* Fall back to an unlinked temporary file. */
+  if (d_fd < 0)
+  {
+    std::string tmpl = get_tmp_file_path(name + "-XXXXXX", tmp_dir);
+    std::vector<char> file_name(tmpl.begin(), tmpl.end());
+    file_name.push_back('\0');
+    d_fd = mkstemp(file_name.data());
+    MURXLA_EXIT_ERROR(d_fd < 0)
+        << "unable to create output buffer file '" << tmpl << "'";
+    unlink(file_name.data());
+    fcntl(d_fd, F_SETFD, FD_CLOEXEC);
+  }
+}
+
+OutputBuffer::~OutputBuffer()
+{
+  unmap();
+  close(d_fd);
+}
+
+void
+OutputBuffer::reset()
+{
+  unmap();
+  MURXLA_EXIT_ERROR(ftruncate(d_fd, 0) < 0 || lseek(d_fd, 0, SEEK_SET) < 0)
+      << "unable to reset output buffer";
+}
+
+void
+OutputBuffer::redirect(int32_t fd) const
+{
+  MURXLA_EXIT_ERROR_FORK(dup2(d_fd, fd) < 0, true)
+      << "unable to redirect output into output buffer";
+}
+
+std::string
+OutputBuffer::get_path() const
+{
+#ifdef __linux__
+  return "/proc/self/fd/" + std::to_string(d_fd);
+#else
+  return "/dev/fd/" + std::to_string(d_fd);
+#endif
+}
+
+std::string_view
+OutputBuffer::view()
+{
+  unmap();
+
+  struct stat st;
+  MURXLA_EXIT_ERROR(fstat(d_fd, &st) < 0) << "unable to query output buffer";
+  if (st.st_size == 0)
+  {
+    return std::string_view();
+  }
+
+  d_size = static_cast<size_t>(st.st_size);
+  d_data = mmap(nullptr, d_size, PROT_READ, MAP_SHARED, d_fd, 0);
+  MURXLA_EXIT_ERROR(d_data == MAP_FAILED) << "unable to map output buffer";
+  return std::string_view(static_cast<const char*>(d_data), d_size);
+}
+
+void
+OutputBuffer::write_to_file(const std::string& file_name)
+{
+  std::string_view contents = view();
+  std::ofstream file        = open_output_file(file_name, false);
+  file.write(contents.data(), contents.size());
+}
+
+void
+OutputBuffer::unmap()
+{
+  if (d_data)
+  {
+    munmap(d_data, d_size);
+    d_data = nullptr;
+    d_size = 0;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
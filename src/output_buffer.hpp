@@ -0,0 +1,94 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__OUTPUT_BUFFER_H
+#define __MURXLA__OUTPUT_BUFFER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * In-memory buffer that captures the output of forked child processes.
+ *
+ * The buffer is backed by an anonymous memory file (memfd_create) on Linux
+ * and by an unlinked temporary file on other platforms. A child process
+ * redirects its output into the buffer, which the parent process then maps
+ * into memory to access it without copying. The buffer is intended to be
+ * reused across test runs, its contents only need to be written to disk if
+ * they are actually needed.
+ */
+class OutputBuffer
+{
+ public:
+  /**
+   * Constructor.
+   * @param name     The name of the buffer (for debugging purposes).
+   * @param tmp_dir  The directory to create the temporary file in if memory
+   *                 files are not supported.
+   */
+  OutputBuffer(const std::string& name, const std::string& tmp_dir);
+  ~OutputBuffer();
+
+  /** Discard the current contents of the buffer. */
+  void reset();
+
+  /**
+   * Redirect given file descriptor into this buffer.
+   * This is called in the child process.
+   * @param fd  The file descriptor to redirect, e.g., STDERR_FILENO.
+   */
+  void redirect(int32_t fd) const;
+
+  /**
+   * Get a path that refers to the underlying file of this buffer. Opening
+   * this path for writing (e.g., as the API trace output file of a forked
+   * child process) writes into this buffer.
+   * @return  The path of the underlying file.
+   */
+  std::string get_path() const;
+
+  /**
+   * Get the current contents of the buffer.
+   * @note  The returned view is only valid until the next call to reset(),
+   *        view() or until the buffer is destroyed.
+   * @return  A view of the mapped contents of the buffer.
+   */
+  std::string_view view();
+
+  /** @return  A copy of the current contents of the buffer. */
+  std::string str() { return std::string(view()); }
+
+  /**
+   * Write the current contents of the buffer to given file.
+   * @param file_name  The name of the file to write to.
+   */
+  void write_to_file(const std::string& file_name);
+
+ private:
+  /** Unmap the currently mapped contents. */
+  void unmap();
+
+  /** The file descriptor of the underlying (memory) file. */
+  int32_t d_fd = -1;
+  /** The currently mapped contents, nullptr if not mapped. */
+  void* d_data = nullptr;
+  /** The size of the currently mapped contents. */
+  size_t d_size = 0;
+};
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
+
+#endif
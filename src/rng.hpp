@@ -108,6 +108,17 @@ class RNGenerator
     return dist(d_rng);
   }
 
+  /**
+   * Pick an index between 0 and 'size' - 1 (inclusive). Draws the same
+   * random number as pick_from_set() on a set of given size, which keeps
+   * picks via indices and via sets interchangeable for a given seed.
+   */
+  size_t pick_index(size_t size)
+  {
+    assert(size > 0);
+    return pick<uint32_t>() % size;
+  }
+
   /**
    * Pick uint32_t between 0 and weights.size(), weighted by the given weights.
    * The probability to pick each number is w/S with w its weight and S the
@@ -164,13 +175,25 @@ class RNGenerator
   /** Pick string literal (theory of strings) */
   std::string pick_string_literal(uint32_t len);
 
-  /* Pick random key from given map. */
+  /*
+   * Pick random key from given map.
+   * This is O(1) for maps with random access iterators (see IndexedMap), and
+   * linear in the size of the map otherwise.
+   */
   template <typename TMap, typename TPicked>
   const TPicked& pick_key_from_map(const TMap& data);
-  /* Pick random value from given map. */
+  /*
+   * Pick random value from given map.
+   * This is O(1) for maps with random access iterators (see IndexedMap), and
+   * linear in the size of the map otherwise.
+   */
   template <typename TMap, typename TPicked>
   const TPicked& pick_value_from_map(const TMap& data);
-  /* Pick random element from given set/vector. */
+  /*
+   * Pick random element from given set/vector.
+   * This is O(1) for vectors and sets with random access iterators (see
+   * IndexedSet), and linear in the size of the set otherwise.
+   */
   template <typename TSet, typename TPicked>
   TPicked pick_from_set(const TSet& data);
 
@@ -231,7 +254,7 @@ RNGenerator::pick_key_from_map(const TMap& map)
 {
   assert(!map.empty());
   auto it = map.begin();
-  std::advance(it, pick<uint32_t>() % map.size());
+  std::advance(it, pick_index(map.size()));
   return it->first;
 }
 
@@ -241,7 +264,7 @@ RNGenerator::pick_value_from_map(const TMap& map)
 {
   assert(!map.empty());
   auto it = map.begin();
-  std::advance(it, pick<uint32_t>() % map.size());
+  std::advance(it, pick_index(map.size()));
   return it->second;
 }
 
@@ -251,7 +274,7 @@ RNGenerator::pick_from_set(const TSet& set)
 {
   assert(!set.empty());
   auto it = set.begin();
-  std::advance(it, pick<uint32_t>() % set.size());
+  std::advance(it, pick_index(set.size()));
   return *it;
 }
 
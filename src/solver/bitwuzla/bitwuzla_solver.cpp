@@ -844,6 +844,12 @@ BitwuzlaSolver::get_name() const
   return "Bitwuzla";
 }
 
+bool
+BitwuzlaSolver::is_reentrant() const
+{
+  return true;
+}
+
 const std::string
 BitwuzlaSolver::get_profile() const
 {
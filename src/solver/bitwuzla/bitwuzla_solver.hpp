@@ -175,6 +175,7 @@ class BitwuzlaSolver : public Solver
   bool is_initialized() const override;
 
   const std::string get_name() const override;
+  bool is_reentrant() const override;
 
   const std::string get_profile() const override;
 
@@ -430,6 +430,12 @@ BtorSolver::get_name() const
   return "Boolector";
 }
 
+bool
+BtorSolver::is_reentrant() const
+{
+  return true;
+}
+
 const std::string
 BtorSolver::get_profile() const
 {
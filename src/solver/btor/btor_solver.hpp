@@ -147,6 +147,7 @@ class BtorSolver : public Solver
   bool is_initialized() const override;
 
   const std::string get_name() const override;
+  bool is_reentrant() const override;
 
   const std::string get_profile() const override;
 
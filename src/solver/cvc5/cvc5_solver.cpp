@@ -1269,6 +1269,12 @@ Cvc5Solver::get_name() const
 }
 //! [docs-cvc5-solver-get_name end]
 
+bool
+Cvc5Solver::is_reentrant() const
+{
+  return true;
+}
+
 const std::string
 Cvc5Solver::get_profile() const
 {
@@ -219,6 +219,7 @@ class Cvc5Solver : public Solver
   bool is_initialized() const override;
 
   const std::string get_name() const override;
+  bool is_reentrant() const override;
 
   const std::string get_profile() const override;
 
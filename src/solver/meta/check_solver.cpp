@@ -15,8 +15,9 @@ using namespace shadow;
 
 CheckSolver::CheckSolver(SolverSeedGenerator& sng,
                          Solver* solver,
-                         Solver* solver_check)
-    : ShadowSolver(sng, solver, solver_check)
+                         Solver* solver_check,
+                         bool concurrent)
+    : ShadowSolver(sng, solver, solver_check, concurrent)
 {
   d_same_solver = false;
 }
@@ -41,10 +42,9 @@ CheckSolver::option_unsat_cores_enabled() const
 void
 CheckSolver::assert_formula(const Term& t)
 {
-  ShadowTerm* term = checked_cast<ShadowTerm*>(t.get());
-  assert(term);
-  d_solver->assert_formula(term->get_term());
-  d_assertions[term->get_term()] = term->get_term_shadow();
+  Term term = unwrap(t, false);
+  d_solver->assert_formula(term);
+  d_assertions[term] = t;
 }
 
 Solver::Result
@@ -60,12 +60,11 @@ CheckSolver::check_sat_assuming(const std::vector<Term>& assumptions)
   d_assumptions_shadow.clear();
   d_assumptions.clear();
 
-  std::vector<Term> assumptions_orig;
-  ShadowSolver::get_terms_helper(
-      assumptions, assumptions_orig, d_assumptions_shadow);
+  std::vector<Term> assumptions_orig = unwrap(assumptions, false);
+  d_assumptions_shadow               = assumptions;
   for (size_t i = 0, size = assumptions.size(); i < size; ++i)
   {
-    d_assumptions.emplace(assumptions_orig[i], d_assumptions_shadow[i]);
+    d_assumptions.emplace(assumptions_orig[i], assumptions[i]);
   }
   return d_solver->check_sat_assuming(assumptions_orig);
 }
@@ -73,25 +72,35 @@ CheckSolver::check_sat_assuming(const std::vector<Term>& assumptions)
 std::vector<Term>
 CheckSolver::get_unsat_core()
 {
-  std::vector<Term> terms, terms_shadow;
+  std::vector<Term> terms;
   auto unsat_core = d_solver->get_unsat_core();
 
-  // Check unsat core with d_solver_shadow
-  d_solver_shadow->push(1);
   for (const Term& t : unsat_core)
   {
     if (d_assertions.find(t) != d_assertions.end())
     {
-      d_solver_shadow->assert_formula(d_assertions.at(t));
+      terms.push_back(d_assertions.at(t));
     }
     else if (d_assumptions.find(t) != d_assumptions.end())
     {
-      d_solver_shadow->assert_formula(d_assumptions.at(t));
+      terms.push_back(d_assumptions.at(t));
     }
   }
-  Result res = d_solver_shadow->check_sat_assuming(d_assumptions_shadow);
-  MURXLA_TEST(res == Result::UNSAT);
-  d_solver_shadow->pop(1);
+
+  // Check unsat core with d_solver_shadow, in concurrent mode the result is
+  // not joined since a failed check aborts.
+  run_shadow(d_worker.get(),
+             [this, terms, assumptions = d_assumptions_shadow]() {
+               d_solver_shadow->push(1);
+               for (const Term& t : terms)
+               {
+                 d_solver_shadow->assert_formula(unwrap(t, true));
+               }
+               Result res = d_solver_shadow->check_sat_assuming(
+                   unwrap(assumptions, true));
+               MURXLA_TEST(res == Result::UNSAT);
+               d_solver_shadow->pop(1);
+             });
 
   return std::vector<Term>();
 }
@@ -134,17 +143,18 @@ CheckSolver::set_opt(const std::string& opt, const std::string& value)
   }
   if (opt == d_solver->get_option_name_unsat_cores() && value == "true")
   {
-    d_solver_shadow->set_opt(d_solver_shadow->get_option_name_incremental(),
-                             "true");
+    call_shadow(d_worker.get(), [this]() {
+      d_solver_shadow->set_opt(d_solver_shadow->get_option_name_incremental(),
+                               "true");
+    });
   }
 }
 
 std::vector<Term>
 CheckSolver::get_value(const std::vector<Term>& terms)
 {
-  std::vector<Term> res, terms_orig, terms_shadow;
-  get_terms_helper(terms, terms_orig, terms_shadow);
-  auto values_orig = d_solver->get_value(terms_orig);
+  std::vector<Term> terms_orig = unwrap(terms, false);
+  auto values_orig             = d_solver->get_value(terms_orig);
 
   /* Check values with d_shadow. */
   if (d_incremental)
@@ -175,7 +185,9 @@ void
 CheckSolver::disable_unsupported_actions(FSM* fsm) const
 {
   d_solver->disable_unsupported_actions(fsm);
-  d_solver_shadow->disable_unsupported_actions(fsm);
+  call_shadow(d_worker.get(), [this, fsm]() {
+    d_solver_shadow->disable_unsupported_actions(fsm);
+  });
 }
 
 }  // namespace murxla
@@ -17,7 +17,10 @@ namespace murxla {
 class CheckSolver : public shadow::ShadowSolver
 {
  public:
-  CheckSolver(SolverSeedGenerator& sng, Solver* solver, Solver* solver_check);
+  CheckSolver(SolverSeedGenerator& sng,
+              Solver* solver,
+              Solver* solver_check,
+              bool concurrent = false);
   ~CheckSolver() override;
 
   void delete_solver() override;
@@ -57,9 +60,12 @@ class CheckSolver : public shadow::ShadowSolver
     }
   };
 
+  /** Map assertions of d_solver to the asserted (wrapped) terms. */
   std::unordered_map<Term, Term, std::hash<Term>, Equal> d_assertions;
 
+  /** The (wrapped) assumptions of the last check-sat call. */
   std::vector<Term> d_assumptions_shadow;
+  /** Map assumptions of d_solver to the (wrapped) assumptions. */
   std::unordered_map<Term, Term, std::hash<Term>, Equal> d_assumptions;
 
   /* Flag whether incremental was enabled for d_solver. */
@@ -9,18 +9,53 @@
  */
 #include "solver/meta/shadow_solver.hpp"
 
+#include "arena.hpp"
 #include "solver/solver_profile.hpp"
 
 namespace murxla {
 namespace shadow {
 
-ShadowSort::ShadowSort(Sort sort, Sort sort_shadow)
-    : d_sort(sort), d_sort_shadow(sort_shadow)
+std::shared_ptr<ShadowSort>
+ShadowSort::create(Sort sort,
+                   Sort sort_shadow,
+                   const std::shared_ptr<ShadowWorker>& worker)
+{
+  ShadowSort* res = arena_new<ShadowSort>(sort, sort_shadow, worker);
+  if (!worker)
+  {
+    return std::shared_ptr<ShadowSort>(
+        res, arena_delete<ShadowSort>, ArenaAllocator<ShadowSort>());
+  }
+  /* Objects of the solver under test are released on the calling thread,
+   * the sort of the shadow solver is destroyed on the worker thread. */
+  return std::shared_ptr<ShadowSort>(
+      res,
+      [](ShadowSort* s) {
+        std::shared_ptr<ShadowWorker> w = s->release();
+        w->post([s]() { arena_delete(s); });
+      },
+      ArenaAllocator<ShadowSort>());
+}
+
+ShadowSort::ShadowSort(Sort sort,
+                       Sort sort_shadow,
+                       std::shared_ptr<ShadowWorker> worker)
+    : d_sort(sort), d_sort_shadow(sort_shadow), d_worker(std::move(worker))
 {
 }
 
 ShadowSort::~ShadowSort() {}
 
+std::shared_ptr<ShadowWorker>
+ShadowSort::release()
+{
+  d_sort.reset();
+  d_sorts.clear();
+  d_associated_sort.reset();
+  d_dt_ctors.clear();
+  return std::move(d_worker);
+}
+
 size_t
 ShadowSort::hash() const
 {
@@ -31,8 +66,9 @@ bool
 ShadowSort::equals(const Sort& other) const
 {
   ShadowSort* s_sort = checked_cast<ShadowSort*>(other.get());
-  return d_sort->equals(s_sort->d_sort)
-         && d_sort_shadow->equals(s_sort->d_sort_shadow);
+  return d_sort->equals(s_sort->d_sort) && call_shadow(d_worker.get(), [&]() {
+           return d_sort_shadow->equals(s_sort->d_sort_shadow);
+         });
 }
 
 std::string
@@ -141,7 +177,9 @@ uint32_t
 ShadowSort::get_bv_size() const
 {
   uint32_t res = d_sort->get_bv_size();
-  MURXLA_TEST(res == d_sort_shadow->get_bv_size());
+  run_shadow(d_worker.get(), [this, res]() {
+    MURXLA_TEST(res == d_sort_shadow->get_bv_size());
+  });
   return res;
 }
 
@@ -149,7 +187,9 @@ uint32_t
 ShadowSort::get_fp_exp_size() const
 {
   uint32_t res = d_sort->get_fp_exp_size();
-  MURXLA_TEST(res == d_sort_shadow->get_fp_exp_size());
+  run_shadow(d_worker.get(), [this, res]() {
+    MURXLA_TEST(res == d_sort_shadow->get_fp_exp_size());
+  });
   return res;
 }
 
@@ -157,7 +197,9 @@ uint32_t
 ShadowSort::get_fp_sig_size() const
 {
   uint32_t res = d_sort->get_fp_sig_size();
-  MURXLA_TEST(res == d_sort_shadow->get_fp_sig_size());
+  run_shadow(d_worker.get(), [this, res]() {
+    MURXLA_TEST(res == d_sort_shadow->get_fp_sig_size());
+  });
   return res;
 }
 
@@ -165,7 +207,9 @@ std::string
 ShadowSort::get_dt_name() const
 {
   std::string res = d_sort->get_dt_name();
-  MURXLA_TEST(res == d_sort_shadow->get_dt_name());
+  run_shadow(d_worker.get(), [this, res]() {
+    MURXLA_TEST(res == d_sort_shadow->get_dt_name());
+  });
   return res;
 }
 
@@ -173,7 +217,9 @@ uint32_t
 ShadowSort::get_dt_num_cons() const
 {
   uint32_t res = d_sort->get_dt_num_cons();
-  MURXLA_TEST(res == d_sort_shadow->get_dt_num_cons());
+  run_shadow(d_worker.get(), [this, res]() {
+    MURXLA_TEST(res == d_sort_shadow->get_dt_num_cons());
+  });
   return res;
 }
 
@@ -181,7 +227,9 @@ std::vector<std::string>
 ShadowSort::get_dt_cons_names() const
 {
   std::vector<std::string> res = d_sort->get_dt_cons_names();
-  MURXLA_TEST(res == d_sort_shadow->get_dt_cons_names());
+  run_shadow(d_worker.get(), [this, res]() {
+    MURXLA_TEST(res == d_sort_shadow->get_dt_cons_names());
+  });
   return res;
 }
 
@@ -189,7 +237,9 @@ uint32_t
 ShadowSort::get_dt_cons_num_sels(const std::string& name) const
 {
   uint32_t res = d_sort->get_dt_cons_num_sels(name);
-  MURXLA_TEST(res == d_sort_shadow->get_dt_cons_num_sels(name));
+  run_shadow(d_worker.get(), [this, res, name]() {
+    MURXLA_TEST(res == d_sort_shadow->get_dt_cons_num_sels(name));
+  });
   return res;
 }
 
@@ -197,32 +247,42 @@ std::vector<std::string>
 ShadowSort::get_dt_cons_sel_names(const std::string& name) const
 {
   std::vector<std::string> res = d_sort->get_dt_cons_sel_names(name);
-  MURXLA_TEST(res == d_sort_shadow->get_dt_cons_sel_names(name));
+  run_shadow(d_worker.get(), [this, res, name]() {
+    MURXLA_TEST(res == d_sort_shadow->get_dt_cons_sel_names(name));
+  });
   return res;
 }
 
 Sort
 ShadowSort::get_array_index_sort() const
 {
-  std::shared_ptr<ShadowSort> res(new ShadowSort(
-      d_sort->get_array_index_sort(), d_sort_shadow->get_array_index_sort()));
+  std::shared_ptr<ShadowSort> res =
+      create(d_sort->get_array_index_sort(), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res]() {
+    res->d_sort_shadow = d_sort_shadow->get_array_index_sort();
+  });
   return res;
 }
 
 Sort
 ShadowSort::get_array_element_sort() const
 {
-  std::shared_ptr<ShadowSort> res(
-      new ShadowSort(d_sort->get_array_element_sort(),
-                     d_sort_shadow->get_array_element_sort()));
+  std::shared_ptr<ShadowSort> res =
+      create(d_sort->get_array_element_sort(), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res]() {
+    res->d_sort_shadow = d_sort_shadow->get_array_element_sort();
+  });
   return res;
 }
 
 Sort
 ShadowSort::get_bag_element_sort() const
 {
-  std::shared_ptr<ShadowSort> res(new ShadowSort(
-      d_sort->get_bag_element_sort(), d_sort_shadow->get_bag_element_sort()));
+  std::shared_ptr<ShadowSort> res =
+      create(d_sort->get_bag_element_sort(), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res]() {
+    res->d_sort_shadow = d_sort_shadow->get_bag_element_sort();
+  });
   return res;
 }
 
@@ -230,46 +290,62 @@ uint32_t
 ShadowSort::get_fun_arity() const
 {
   uint32_t res = d_sort->get_fun_arity();
-  MURXLA_TEST(res == d_sort_shadow->get_fun_arity());
+  run_shadow(d_worker.get(), [this, res]() {
+    MURXLA_TEST(res == d_sort_shadow->get_fun_arity());
+  });
   return res;
 }
 
 Sort
 ShadowSort::get_fun_codomain_sort() const
 {
-  std::shared_ptr<ShadowSort> res(new ShadowSort(
-      d_sort->get_fun_codomain_sort(), d_sort_shadow->get_fun_codomain_sort()));
+  std::shared_ptr<ShadowSort> res =
+      create(d_sort->get_fun_codomain_sort(), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res]() {
+    res->d_sort_shadow = d_sort_shadow->get_fun_codomain_sort();
+  });
   return res;
 }
 
 std::vector<Sort>
 ShadowSort::get_fun_domain_sorts() const
 {
-  std::vector<Sort> sorts        = d_sort->get_fun_domain_sorts();
-  std::vector<Sort> sorts_shadow = d_sort_shadow->get_fun_domain_sorts();
-  MURXLA_TEST(sorts.size() == sorts_shadow.size());
+  std::vector<Sort> sorts = d_sort->get_fun_domain_sorts();
   std::vector<Sort> res;
-  for (size_t i = 0, n = sorts.size(); i < n; ++i)
+  for (const Sort& s : sorts)
   {
-    res.push_back(
-        std::shared_ptr<ShadowSort>(new ShadowSort(sorts[i], sorts_shadow[i])));
+    res.push_back(create(s, nullptr, d_worker));
   }
+  run_shadow(d_worker.get(), [this, res]() {
+    std::vector<Sort> sorts_shadow = d_sort_shadow->get_fun_domain_sorts();
+    MURXLA_TEST(res.size() == sorts_shadow.size());
+    for (size_t i = 0, n = res.size(); i < n; ++i)
+    {
+      checked_cast<ShadowSort*>(res[i].get())->d_sort_shadow = sorts_shadow[i];
+    }
+  });
   return res;
 }
 
 Sort
 ShadowSort::get_seq_element_sort() const
 {
-  std::shared_ptr<ShadowSort> res(new ShadowSort(
-      d_sort->get_seq_element_sort(), d_sort_shadow->get_seq_element_sort()));
+  std::shared_ptr<ShadowSort> res =
+      create(d_sort->get_seq_element_sort(), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res]() {
+    res->d_sort_shadow = d_sort_shadow->get_seq_element_sort();
+  });
   return res;
 }
 
 Sort
 ShadowSort::get_set_element_sort() const
 {
-  std::shared_ptr<ShadowSort> res(new ShadowSort(
-      d_sort->get_set_element_sort(), d_sort_shadow->get_set_element_sort()));
+  std::shared_ptr<ShadowSort> res =
+      create(d_sort->get_set_element_sort(), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res]() {
+    res->d_sort_shadow = d_sort_shadow->get_set_element_sort();
+  });
   return res;
 }
 
@@ -277,17 +353,19 @@ void
 ShadowSort::set_kind(SortKind sort_kind)
 {
   d_sort->set_kind(sort_kind);
-  d_sort_shadow->set_kind(sort_kind);
+  run_shadow(d_worker.get(),
+             [this, sort_kind]() { d_sort_shadow->set_kind(sort_kind); });
   d_kind = sort_kind;
 }
 
 void
 ShadowSort::set_sorts(const std::vector<Sort>& sorts)
 {
-  std::vector<Sort> sorts_orig, sorts_shadow;
-  ShadowSolver::get_sorts_helper(sorts, sorts_orig, sorts_shadow);
-  d_sort->set_sorts(sorts_orig);
-  d_sort_shadow->set_sorts(sorts_shadow);
+  d_sort->set_sorts(ShadowSolver::unwrap(sorts, false));
+  run_shadow(d_worker.get(),
+             [this, s = ShadowSolver::snapshot(sorts, d_worker.get())]() {
+               d_sort_shadow->set_sorts(ShadowSolver::unwrap(s, true));
+             });
   d_sorts = sorts;
 }
 
@@ -296,46 +374,20 @@ ShadowSort::set_associated_sort(Sort sort)
 {
   ShadowSort* s = checked_cast<ShadowSort*>(sort.get());
   d_sort->set_associated_sort(s->d_sort);
-  d_sort_shadow->set_associated_sort(s->d_sort_shadow);
+  run_shadow(d_worker.get(), [this, sort]() {
+    d_sort_shadow->set_associated_sort(
+        checked_cast<ShadowSort*>(sort.get())->d_sort_shadow);
+  });
 }
 
 void
 ShadowSort::set_dt_ctors(const DatatypeConstructorMap& ctors)
 {
-  DatatypeConstructorMap ctors_orig, ctors_shadow;
-
-  for (const auto& c : ctors)
-  {
-    const auto& cname   = c.first;
-    ctors_orig[cname]   = {};
-    ctors_shadow[cname] = {};
-
-    const auto& sels = c.second;
-    for (const auto& s : sels)
-    {
-      const auto& sname  = s.first;
-      auto& sel_sort     = s.second;
-      Sort sel_sort_orig = sel_sort, sel_sort_shadow = sel_sort;
-      if (sel_sort && !sel_sort->is_param_sort())
-      {
-        if (sel_sort->is_unresolved_sort())
-        {
-          ShadowSolver::get_unresolved_sort_helper(
-              sel_sort, sel_sort_orig, sel_sort_shadow);
-        }
-        else
-        {
-          ShadowSort* sort = checked_cast<ShadowSort*>(sel_sort.get());
-          sel_sort_orig    = sort->get_sort();
-          sel_sort_shadow  = sort->get_sort_shadow();
-        }
-      }
-      ctors_orig[cname].emplace_back(sname, sel_sort_orig);
-      ctors_shadow[cname].emplace_back(sname, sel_sort_shadow);
-    }
-  }
-  d_sort->set_dt_ctors(ctors_orig);
-  d_sort_shadow->set_dt_ctors(ctors_shadow);
+  d_sort->set_dt_ctors(ShadowSolver::unwrap(ctors, false));
+  run_shadow(d_worker.get(),
+             [this, c = ShadowSolver::snapshot(ctors, d_worker.get())]() {
+               d_sort_shadow->set_dt_ctors(ShadowSolver::unwrap(c, true));
+             });
   d_dt_ctors = ctors;
 }
 
@@ -344,17 +396,57 @@ ShadowSort::set_dt_is_instantiated(bool value)
 {
   AbsSort::set_dt_is_instantiated(value);
   d_sort->set_dt_is_instantiated(value);
-  d_sort_shadow->set_dt_is_instantiated(value);
+  run_shadow(d_worker.get(), [this, value]() {
+    d_sort_shadow->set_dt_is_instantiated(value);
+  });
 }
 
-ShadowTerm::ShadowTerm(Term term, Term term_shadow)
-    : d_term(term), d_term_shadow(term_shadow){};
+std::shared_ptr<ShadowTerm>
+ShadowTerm::create(Term term,
+                   Term term_shadow,
+                   const std::shared_ptr<ShadowWorker>& worker)
+{
+  ShadowTerm* res = arena_new<ShadowTerm>(term, term_shadow, worker);
+  if (!worker)
+  {
+    return std::shared_ptr<ShadowTerm>(
+        res, arena_delete<ShadowTerm>, ArenaAllocator<ShadowTerm>());
+  }
+  /* Objects of the solver under test are released on the calling thread,
+   * the term of the shadow solver is destroyed on the worker thread. */
+  return std::shared_ptr<ShadowTerm>(
+      res,
+      [](ShadowTerm* t) {
+        std::shared_ptr<ShadowWorker> w = t->release();
+        w->post([t]() { arena_delete(t); });
+      },
+      ArenaAllocator<ShadowTerm>());
+}
+
+ShadowTerm::ShadowTerm(Term term,
+                       Term term_shadow,
+                       std::shared_ptr<ShadowWorker> worker)
+    : d_term(term), d_term_shadow(term_shadow), d_worker(std::move(worker)){};
 
 ShadowTerm::~ShadowTerm() {}
 
+std::shared_ptr<ShadowWorker>
+ShadowTerm::release()
+{
+  d_term.reset();
+  d_sort.reset();
+  return std::move(d_worker);
+}
+
 size_t
 ShadowTerm::hash() const
 {
+  /* The shadow term is only available on the worker thread in concurrent
+   * mode, equal terms still have equal hash values. */
+  if (d_worker)
+  {
+    return d_term->hash();
+  }
   return d_term->hash() + d_term_shadow->hash();
 }
 bool
@@ -364,7 +456,9 @@ ShadowTerm::equals(const Term& other) const
   if (s_term)
   {
     return d_term->equals(s_term->d_term)
-           && d_term_shadow->equals(s_term->d_term_shadow);
+           && call_shadow(d_worker.get(), [&]() {
+                return d_term_shadow->equals(s_term->d_term_shadow);
+              });
   }
   return false;
 }
@@ -495,27 +589,12 @@ void
 ShadowTerm::set_sort(Sort sort)
 {
   AbsTerm::set_sort(sort);
-  Sort sort_orig, sort_shadow;
-  if (sort)
-  {
-    if (sort->is_param_sort())
-    {
-      ShadowSolver::get_param_sort_helper(sort, sort_orig, sort_shadow);
-    }
-    else if (sort->is_unresolved_sort())
-    {
-      ShadowSolver::get_unresolved_sort_helper(sort, sort_orig, sort_shadow);
-    }
-    else
-    {
-      ShadowSort* s = checked_cast<ShadowSort*>(sort.get());
-      assert(s);
-      sort_orig   = s->get_sort();
-      sort_shadow = s->get_sort_shadow();
-    }
-  }
-  d_term->set_sort(sort_orig);
-  d_term_shadow->set_sort(sort_shadow);
+  d_term->set_sort(sort ? ShadowSolver::unwrap(sort, false) : nullptr);
+  run_shadow(d_worker.get(),
+             [this, s = ShadowSolver::snapshot(sort, d_worker.get())]() {
+               d_term_shadow->set_sort(s ? ShadowSolver::unwrap(s, true)
+                                         : nullptr);
+             });
 }
 
 void
@@ -523,7 +602,9 @@ ShadowTerm::set_special_value_kind(const SpecialValueKind& value_kind)
 {
   AbsTerm::set_special_value_kind(value_kind);
   d_term->set_special_value_kind(value_kind);
-  d_term_shadow->set_special_value_kind(value_kind);
+  run_shadow(d_worker.get(), [this, value_kind]() {
+    d_term_shadow->set_special_value_kind(value_kind);
+  });
 }
 
 void
@@ -531,155 +612,194 @@ ShadowTerm::set_leaf_kind(LeafKind kind)
 {
   AbsTerm::set_leaf_kind(kind);
   d_term->set_leaf_kind(kind);
-  d_term_shadow->set_leaf_kind(kind);
+  run_shadow(d_worker.get(),
+             [this, kind]() { d_term_shadow->set_leaf_kind(kind); });
 }
 
 ShadowSolver::ShadowSolver(SolverSeedGenerator& sng,
                            Solver* solver,
-                           Solver* solver_shadow)
+                           Solver* solver_shadow,
+                           bool concurrent)
     : Solver(sng),
       d_solver(solver),
       d_solver_shadow(solver_shadow),
-      d_same_solver(solver->get_name() == solver_shadow->get_name()){};
-
-ShadowSolver::~ShadowSolver(){};
-
-void
-ShadowSolver::get_sorts_helper(const std::vector<Sort>& sorts,
-                               std::vector<Sort>& sorts_orig,
-                               std::vector<Sort>& sorts_shadow)
+      d_same_solver(solver->get_name() == solver_shadow->get_name())
 {
-  for (auto s : sorts)
+  if (concurrent)
   {
-    assert(s);
-    Sort s_orig, s_shadow;
-    if (s->is_param_sort())
-    {
-      get_param_sort_helper(s, s_orig, s_shadow);
-    }
-    else if (s->is_unresolved_sort())
-    {
-      get_unresolved_sort_helper(s, s_orig, s_shadow);
-    }
-    else
-    {
-      ShadowSort* sort = checked_cast<ShadowSort*>(s.get());
-      assert(sort);
-      s_orig   = sort->get_sort();
-      s_shadow = sort->get_sort_shadow();
-    }
-    sorts_orig.push_back(s_orig);
-    sorts_shadow.push_back(s_shadow);
+    d_worker.reset(new ShadowWorker());
   }
 }
 
-void
-ShadowSolver::get_param_sort_helper(Sort sort,
-                                    Sort& sort_orig,
-                                    Sort& sort_shadow)
+ShadowSolver::~ShadowSolver()
 {
-  assert(sort->is_param_sort());
+  if (d_worker)
+  {
+    /* The shadow solver is destroyed on the worker thread, after all pending
+     * tasks that refer to this solver are executed. */
+    d_worker->post([solver = d_solver_shadow.release()]() { delete solver; });
+    /* Errors of the shadow solver are reported by delete_solver(), which
+     * synchronizes with the worker. Pending tasks only remain if this solver
+     * is destroyed without being deleted, i.e., while an error is already
+     * being reported. */
+    d_worker->wait();
+  }
+}
 
-  ParamSort* psort = checked_cast<ParamSort*>(sort.get());
+Sort
+ShadowSolver::unwrap(const Sort& sort, bool shadow)
+{
+  assert(sort);
+  if (!sort->is_param_sort() && !sort->is_unresolved_sort())
+  {
+    ShadowSort* s = checked_cast<ShadowSort*>(sort.get());
+    assert(s);
+    return shadow ? s->get_sort_shadow() : s->get_sort();
+  }
 
-  sort_orig   = std::shared_ptr<ParamSort>(new ParamSort(psort->get_symbol()));
-  sort_shadow = std::shared_ptr<ParamSort>(new ParamSort(psort->get_symbol()));
+  Sort res;
+  if (sort->is_param_sort())
+  {
+    ParamSort* psort = checked_cast<ParamSort*>(sort.get());
+    res = std::shared_ptr<ParamSort>(new ParamSort(psort->get_symbol()));
+  }
+  else
+  {
+    UnresolvedSort* usort = checked_cast<UnresolvedSort*>(sort.get());
+    res                   = std::shared_ptr<UnresolvedSort>(
+        new UnresolvedSort(usort->get_symbol()));
+  }
 
   Sort ass = sort->get_associated_sort();
   assert(!ass || (!ass->is_param_sort() && !ass->is_unresolved_sort()));
-  Sort ass_orig = ass, ass_shadow = ass;
-  if (ass)
+  res->set_associated_sort(ass ? unwrap(ass, shadow) : ass);
+
+  if (sort->is_unresolved_sort())
   {
-    if (ass->is_param_sort())
-    {
-      get_param_sort_helper(ass, ass_orig, ass_shadow);
-    }
-    else if (ass->is_unresolved_sort())
-    {
-      get_unresolved_sort_helper(ass, ass_orig, ass_shadow);
-    }
-    else
+    UnresolvedSort* usort = checked_cast<UnresolvedSort*>(sort.get());
+    res->set_sorts(unwrap(usort->get_sorts(), shadow));
+  }
+  return res;
+}
+
+std::vector<Sort>
+ShadowSolver::unwrap(const std::vector<Sort>& sorts, bool shadow)
+{
+  std::vector<Sort> res;
+  for (const Sort& s : sorts)
+  {
+    res.push_back(unwrap(s, shadow));
+  }
+  return res;
+}
+
+AbsSort::DatatypeConstructorMap
+ShadowSolver::unwrap(const AbsSort::DatatypeConstructorMap& ctors, bool shadow)
+{
+  AbsSort::DatatypeConstructorMap res;
+  for (const auto& [cname, sels] : ctors)
+  {
+    auto& res_sels = res[cname];
+    for (const auto& [sname, sel_sort] : sels)
     {
-      ShadowSort* sass = checked_cast<ShadowSort*>(ass.get());
-      ass_orig         = sass->get_sort();
-      ass_shadow       = sass->get_sort_shadow();
+      /* Parameter sorts are shared between the solvers. */
+      if (sel_sort && !sel_sort->is_param_sort())
+      {
+        res_sels.emplace_back(sname, unwrap(sel_sort, shadow));
+      }
+      else
+      {
+        res_sels.emplace_back(sname, sel_sort);
+      }
     }
   }
-  sort_orig->set_associated_sort(ass_orig);
-  sort_shadow->set_associated_sort(ass_shadow);
+  return res;
 }
 
-void
-ShadowSolver::get_unresolved_sort_helper(Sort sort,
-                                         Sort& sort_orig,
-                                         Sort& sort_shadow)
+Term
+ShadowSolver::unwrap(const Term& term, bool shadow)
 {
-  UnresolvedSort* usort = checked_cast<UnresolvedSort*>(sort.get());
+  ShadowTerm* t = checked_cast<ShadowTerm*>(term.get());
+  assert(t);
+  return shadow ? t->get_term_shadow() : t->get_term();
+}
 
-  sort_orig =
-      std::shared_ptr<UnresolvedSort>(new UnresolvedSort(usort->get_symbol()));
-  sort_shadow =
-      std::shared_ptr<UnresolvedSort>(new UnresolvedSort(usort->get_symbol()));
+std::vector<Term>
+ShadowSolver::unwrap(const std::vector<Term>& terms, bool shadow)
+{
+  std::vector<Term> res;
+  for (const Term& t : terms)
+  {
+    res.push_back(unwrap(t, shadow));
+  }
+  return res;
+}
 
-  Sort ass = sort->get_associated_sort();
-  assert(!ass || (!ass->is_param_sort() && !ass->is_unresolved_sort()));
-  Sort ass_orig = ass, ass_shadow = ass;
-  if (ass)
+Sort
+ShadowSolver::snapshot(const Sort& sort, const ShadowWorker* worker)
+{
+  if (!worker || !sort
+      || (!sort->is_param_sort() && !sort->is_unresolved_sort()))
   {
-    if (ass->is_param_sort())
-    {
-      get_param_sort_helper(ass, ass_orig, ass_shadow);
-    }
-    else if (ass->is_unresolved_sort())
-    {
-      get_unresolved_sort_helper(ass, ass_orig, ass_shadow);
-    }
-    else
-    {
-      ShadowSort* sass = checked_cast<ShadowSort*>(ass.get());
-      ass_orig         = sass->get_sort();
-      ass_shadow       = sass->get_sort_shadow();
-    }
+    return sort;
+  }
+  Sort res;
+  if (sort->is_param_sort())
+  {
+    res = std::make_shared<ParamSort>(*checked_cast<ParamSort*>(sort.get()));
+  }
+  else
+  {
+    res = std::make_shared<UnresolvedSort>(
+        *checked_cast<UnresolvedSort*>(sort.get()));
+    res->set_sorts(snapshot(sort->get_sorts(), worker));
   }
-  sort_orig->set_associated_sort(ass_orig);
-  sort_shadow->set_associated_sort(ass_shadow);
+  res->set_associated_sort(snapshot(sort->get_associated_sort(), worker));
+  return res;
+}
 
-  std::vector<Sort> inst_sorts_orig, inst_sorts_shadow;
-  for (Sort isort : usort->get_sorts())
+std::vector<Sort>
+ShadowSolver::snapshot(const std::vector<Sort>& sorts,
+                       const ShadowWorker* worker)
+{
+  if (!worker)
   {
-    Sort isort_orig, isort_shadow;
-    if (isort->is_param_sort())
-    {
-      get_param_sort_helper(isort, isort_orig, isort_shadow);
-    }
-    else if (isort->is_unresolved_sort())
-    {
-      get_unresolved_sort_helper(isort, isort_orig, isort_shadow);
-    }
-    else
+    return sorts;
+  }
+  std::vector<Sort> res;
+  for (const Sort& s : sorts)
+  {
+    res.push_back(snapshot(s, worker));
+  }
+  return res;
+}
+
+AbsSort::DatatypeConstructorMap
+ShadowSolver::snapshot(const AbsSort::DatatypeConstructorMap& ctors,
+                       const ShadowWorker* worker)
+{
+  if (!worker)
+  {
+    return ctors;
+  }
+  /* Copy the map to preserve the order of the constructors. */
+  AbsSort::DatatypeConstructorMap res = ctors;
+  for (auto& [cname, sels] : res)
+  {
+    for (auto& sel : sels)
     {
-      ShadowSort* issort = checked_cast<ShadowSort*>(isort.get());
-      isort_orig         = issort->get_sort();
-      isort_shadow       = issort->get_sort_shadow();
+      sel.second = snapshot(sel.second, worker);
     }
-    inst_sorts_orig.push_back(isort_orig);
-    inst_sorts_shadow.push_back(isort_shadow);
   }
-  sort_orig->set_sorts(inst_sorts_orig);
-  sort_shadow->set_sorts(inst_sorts_shadow);
+  return res;
 }
 
 void
-ShadowSolver::get_terms_helper(const std::vector<Term>& terms,
-                               std::vector<Term>& terms_orig,
-                               std::vector<Term>& terms_shadow)
+ShadowSolver::sync_shadow() const
 {
-  for (auto t : terms)
+  if (d_worker)
   {
-    ShadowTerm* term = checked_cast<ShadowTerm*>(t.get());
-    assert(term);
-    terms_orig.push_back(term->get_term());
-    terms_shadow.push_back(term->get_term_shadow());
+    d_worker->sync();
   }
 }
 
@@ -687,23 +807,29 @@ void
 ShadowSolver::new_solver()
 {
   d_solver->new_solver();
-  d_solver_shadow->new_solver();
+  run_shadow(d_worker.get(), [this]() { d_solver_shadow->new_solver(); });
 }
 
 void
 ShadowSolver::delete_solver()
 {
   d_solver->delete_solver();
-  d_solver_shadow->delete_solver();
+  run_shadow(d_worker.get(), [this]() { d_solver_shadow->delete_solver(); });
   d_solver.reset(nullptr);
-  d_solver_shadow.reset(nullptr);
+  run_shadow(d_worker.get(), [this]() { d_solver_shadow.reset(nullptr); });
+  /* Errors of the shadow solver are reported here, not on destruction. */
+  sync_shadow();
 }
 
 bool
 ShadowSolver::is_initialized() const
 {
   bool res = d_solver->is_initialized();
-  assert(d_solver_shadow->is_initialized() == res);
+#ifndef NDEBUG
+  run_shadow(d_worker.get(), [this, res]() {
+    assert(d_solver_shadow->is_initialized() == res);
+  });
+#endif
   return res;
 }
 
@@ -711,35 +837,43 @@ const std::string
 ShadowSolver::get_name() const
 {
   return "ShadowSolver(" + d_solver->get_name() + ","
-         + d_solver_shadow->get_name() + ")";
+         + call_shadow(d_worker.get(),
+                       [this]() { return d_solver_shadow->get_name(); })
+         + ")";
 }
 
 const std::string
 ShadowSolver::get_profile() const
 {
-  return SolverProfile::merge(d_solver->get_profile(),
-                              d_solver_shadow->get_profile());
+  return SolverProfile::merge(
+      d_solver->get_profile(), call_shadow(d_worker.get(), [this]() {
+        return d_solver_shadow->get_profile();
+      }));
 }
 
 Term
 ShadowSolver::mk_var(Sort sort, const std::string& name)
 {
-  ShadowSort* s = checked_cast<ShadowSort*>(sort.get());
-  assert(s);
-  Term t        = d_solver->mk_var(s->d_sort, name);
-  Term t_shadow = d_solver_shadow->mk_var(s->d_sort_shadow, name);
-  std::shared_ptr<ShadowTerm> res(new ShadowTerm(t, t_shadow));
+  std::shared_ptr<ShadowTerm> res =
+      ShadowTerm::create(d_solver->mk_var(unwrap(sort, false), name),
+                         nullptr,
+                         d_worker);
+  run_shadow(d_worker.get(), [this, res, sort, name]() {
+    res->d_term_shadow = d_solver_shadow->mk_var(unwrap(sort, true), name);
+  });
   return res;
 }
 
 Term
 ShadowSolver::mk_const(Sort sort, const std::string& name)
 {
-  ShadowSort* s = checked_cast<ShadowSort*>(sort.get());
-  assert(s);
-  Term t        = d_solver->mk_const(s->d_sort, name);
-  Term t_shadow = d_solver_shadow->mk_const(s->d_sort_shadow, name);
-  std::shared_ptr<ShadowTerm> res(new ShadowTerm(t, t_shadow));
+  std::shared_ptr<ShadowTerm> res =
+      ShadowTerm::create(d_solver->mk_const(unwrap(sort, false), name),
+                         nullptr,
+                         d_worker);
+  run_shadow(d_worker.get(), [this, res, sort, name]() {
+    res->d_term_shadow = d_solver_shadow->mk_const(unwrap(sort, true), name);
+  });
   return res;
 }
 
@@ -748,36 +882,36 @@ ShadowSolver::mk_fun(const std::string& name,
                      const std::vector<Term>& args,
                      Term body)
 {
-  ShadowTerm* term = checked_cast<ShadowTerm*>(body.get());
-  assert(term);
-  std::vector<Term> terms_orig, terms_shadow;
-  get_terms_helper(args, terms_orig, terms_shadow);
-  Term t = d_solver->mk_fun(name, terms_orig, term->get_term());
-  Term t_shadow =
-      d_solver_shadow->mk_fun(name, terms_shadow, term->get_term_shadow());
-  std::shared_ptr<ShadowTerm> res(new ShadowTerm(t, t_shadow));
+  std::shared_ptr<ShadowTerm> res = ShadowTerm::create(
+      d_solver->mk_fun(name, unwrap(args, false), unwrap(body, false)),
+      nullptr,
+      d_worker);
+  run_shadow(d_worker.get(), [this, res, name, args, body]() {
+    res->d_term_shadow =
+        d_solver_shadow->mk_fun(name, unwrap(args, true), unwrap(body, true));
+  });
   return res;
 }
 
 Term
 ShadowSolver::mk_value(Sort sort, bool value)
 {
-  ShadowSort* s = checked_cast<ShadowSort*>(sort.get());
-  assert(s);
-  Term t        = d_solver->mk_value(s->d_sort, value);
-  Term t_shadow = d_solver_shadow->mk_value(s->d_sort_shadow, value);
-  std::shared_ptr<ShadowTerm> res(new ShadowTerm(t, t_shadow));
+  std::shared_ptr<ShadowTerm> res = ShadowTerm::create(
+      d_solver->mk_value(unwrap(sort, false), value), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res, sort, value]() {
+    res->d_term_shadow = d_solver_shadow->mk_value(unwrap(sort, true), value);
+  });
   return res;
 }
 
 Term
 ShadowSolver::mk_value(Sort sort, const std::string& value)
 {
-  ShadowSort* s = checked_cast<ShadowSort*>(sort.get());
-  assert(s);
-  Term t        = d_solver->mk_value(s->d_sort, value);
-  Term t_shadow = d_solver_shadow->mk_value(s->d_sort_shadow, value);
-  std::shared_ptr<ShadowTerm> res(new ShadowTerm(t, t_shadow));
+  std::shared_ptr<ShadowTerm> res = ShadowTerm::create(
+      d_solver->mk_value(unwrap(sort, false), value), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res, sort, value]() {
+    res->d_term_shadow = d_solver_shadow->mk_value(unwrap(sort, true), value);
+  });
   return res;
 }
 
@@ -786,22 +920,24 @@ ShadowSolver::mk_value(Sort sort,
                        const std::string& num,
                        const std::string& den)
 {
-  ShadowSort* s = checked_cast<ShadowSort*>(sort.get());
-  assert(s);
-  Term t        = d_solver->mk_value(s->d_sort, num, den);
-  Term t_shadow = d_solver_shadow->mk_value(s->d_sort_shadow, num, den);
-  std::shared_ptr<ShadowTerm> res(new ShadowTerm(t, t_shadow));
+  std::shared_ptr<ShadowTerm> res = ShadowTerm::create(
+      d_solver->mk_value(unwrap(sort, false), num, den), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res, sort, num, den]() {
+    res->d_term_shadow =
+        d_solver_shadow->mk_value(unwrap(sort, true), num, den);
+  });
   return res;
 }
 
 Term
 ShadowSolver::mk_value(Sort sort, const std::string& value, Base base)
 {
-  ShadowSort* s = checked_cast<ShadowSort*>(sort.get());
-  assert(s);
-  Term t        = d_solver->mk_value(s->d_sort, value, base);
-  Term t_shadow = d_solver_shadow->mk_value(s->d_sort_shadow, value, base);
-  std::shared_ptr<ShadowTerm> res(new ShadowTerm(t, t_shadow));
+  std::shared_ptr<ShadowTerm> res = ShadowTerm::create(
+      d_solver->mk_value(unwrap(sort, false), value, base), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res, sort, value, base]() {
+    res->d_term_shadow =
+        d_solver_shadow->mk_value(unwrap(sort, true), value, base);
+  });
   return res;
 }
 
@@ -809,58 +945,71 @@ Term
 ShadowSolver::mk_special_value(Sort sort,
                                const AbsTerm::SpecialValueKind& value)
 {
-  ShadowSort* s = checked_cast<ShadowSort*>(sort.get());
-  assert(s);
-  Term t        = d_solver->mk_special_value(s->d_sort, value);
-  Term t_shadow = d_solver_shadow->mk_special_value(s->d_sort_shadow, value);
-  std::shared_ptr<ShadowTerm> res(new ShadowTerm(t, t_shadow));
+  std::shared_ptr<ShadowTerm> res = ShadowTerm::create(
+      d_solver->mk_special_value(unwrap(sort, false), value),
+      nullptr,
+      d_worker);
+  run_shadow(d_worker.get(), [this, res, sort, value]() {
+    res->d_term_shadow =
+        d_solver_shadow->mk_special_value(unwrap(sort, true), value);
+  });
   return res;
 }
 
 Sort
 ShadowSolver::mk_sort(const std::string& name)
 {
-  Sort s        = d_solver->mk_sort(name);
-  Sort s_shadow = d_solver_shadow->mk_sort(name);
-  std::shared_ptr<ShadowSort> res(new ShadowSort(s, s_shadow));
+  std::shared_ptr<ShadowSort> res =
+      ShadowSort::create(d_solver->mk_sort(name), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res, name]() {
+    res->d_sort_shadow = d_solver_shadow->mk_sort(name);
+  });
   return res;
 }
 
 Sort
 ShadowSolver::mk_sort(SortKind kind)
 {
-  Sort s        = d_solver->mk_sort(kind);
-  Sort s_shadow = d_solver_shadow->mk_sort(kind);
-  std::shared_ptr<ShadowSort> res(new ShadowSort(s, s_shadow));
+  std::shared_ptr<ShadowSort> res =
+      ShadowSort::create(d_solver->mk_sort(kind), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res, kind]() {
+    res->d_sort_shadow = d_solver_shadow->mk_sort(kind);
+  });
   return res;
 }
 
 Sort
 ShadowSolver::mk_sort(SortKind kind, uint32_t size)
 {
-  Sort s        = d_solver->mk_sort(kind, size);
-  Sort s_shadow = d_solver_shadow->mk_sort(kind, size);
-  std::shared_ptr<ShadowSort> res(new ShadowSort(s, s_shadow));
+  std::shared_ptr<ShadowSort> res =
+      ShadowSort::create(d_solver->mk_sort(kind, size), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res, kind, size]() {
+    res->d_sort_shadow = d_solver_shadow->mk_sort(kind, size);
+  });
   return res;
 }
 
 Sort
 ShadowSolver::mk_sort(SortKind kind, uint32_t esize, uint32_t ssize)
 {
-  Sort s        = d_solver->mk_sort(kind, esize, ssize);
-  Sort s_shadow = d_solver_shadow->mk_sort(kind, esize, ssize);
-  std::shared_ptr<ShadowSort> res(new ShadowSort(s, s_shadow));
+  std::shared_ptr<ShadowSort> res = ShadowSort::create(
+      d_solver->mk_sort(kind, esize, ssize), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res, kind, esize, ssize]() {
+    res->d_sort_shadow = d_solver_shadow->mk_sort(kind, esize, ssize);
+  });
   return res;
 }
 
 Sort
 ShadowSolver::mk_sort(SortKind kind, const std::vector<Sort>& sorts)
 {
-  std::vector<Sort> sorts_orig, sorts_shadow;
-  get_sorts_helper(sorts, sorts_orig, sorts_shadow);
-  Sort s        = d_solver->mk_sort(kind, sorts_orig);
-  Sort s_shadow = d_solver_shadow->mk_sort(kind, sorts_shadow);
-  std::shared_ptr<ShadowSort> res(new ShadowSort(s, s_shadow));
+  std::shared_ptr<ShadowSort> res = ShadowSort::create(
+      d_solver->mk_sort(kind, unwrap(sorts, false)), nullptr, d_worker);
+  run_shadow(d_worker.get(),
+             [this, res, kind, s = snapshot(sorts, d_worker.get())]() {
+               res->d_sort_shadow =
+                   d_solver_shadow->mk_sort(kind, unwrap(s, true));
+             });
   return res;
 }
 
@@ -874,78 +1023,58 @@ ShadowSolver::mk_sort(
   size_t n_dt_sorts = dt_names.size();
   assert(n_dt_sorts == param_sorts.size());
   assert(n_dt_sorts == constructors.size());
-  std::vector<std::vector<Sort>> param_sorts_orig;
-  std::vector<std::vector<Sort>> param_sorts_shadow;
-  std::vector<AbsSort::DatatypeConstructorMap> constructors_orig;
-  std::vector<AbsSort::DatatypeConstructorMap> constructors_shadow;
 
-  for (size_t i = 0; i < n_dt_sorts; ++i)
+  std::vector<AbsSort::DatatypeConstructorMap> constructors_orig;
+  for (const auto& ctors : constructors)
   {
-    AbsSort::DatatypeConstructorMap ctors_orig;
-    AbsSort::DatatypeConstructorMap ctors_shadow;
-    for (const auto& c : constructors[i])
-    {
-      const auto& cname   = c.first;
-      const auto& sels    = c.second;
-      ctors_orig[cname]   = {};
-      ctors_shadow[cname] = {};
-
-      for (const auto& s : sels)
-      {
-        const auto& sname  = s.first;
-        auto& sel_sort     = s.second;
-        Sort sel_sort_orig = sel_sort, sel_sort_shadow = sel_sort;
-        if (sel_sort && !sel_sort->is_param_sort())
-        {
-          if (sel_sort->is_unresolved_sort())
-          {
-            get_unresolved_sort_helper(
-                sel_sort, sel_sort_orig, sel_sort_shadow);
-          }
-          else
-          {
-            ShadowSort* sort = checked_cast<ShadowSort*>(sel_sort.get());
-            sel_sort_orig    = sort->get_sort();
-            sel_sort_shadow  = sort->get_sort_shadow();
-          }
-        }
-        ctors_orig[cname].emplace_back(sname, sel_sort_orig);
-        ctors_shadow[cname].emplace_back(sname, sel_sort_shadow);
-      }
-    }
-    constructors_orig.push_back(ctors_orig);
-    constructors_shadow.push_back(ctors_shadow);
+    constructors_orig.push_back(unwrap(ctors, false));
   }
-
   std::vector<Sort> res_orig =
       d_solver->mk_sort(kind, dt_names, param_sorts, constructors_orig);
-  std::vector<Sort> res_shadow = d_solver_shadow->mk_sort(
-      kind, dt_names, param_sorts, constructors_shadow);
   MURXLA_TEST(res_orig.size() == n_dt_sorts);
-  MURXLA_TEST(res_orig.size() == res_shadow.size());
+
   std::vector<Sort> res;
+  for (const Sort& s : res_orig)
+  {
+    res.push_back(ShadowSort::create(s, nullptr, d_worker));
+  }
+  std::vector<std::vector<Sort>> psorts;
+  std::vector<AbsSort::DatatypeConstructorMap> ctors;
   for (size_t i = 0; i < n_dt_sorts; ++i)
   {
-    res.push_back(std::shared_ptr<ShadowSort>(
-        new ShadowSort(res_orig[i], res_shadow[i])));
+    psorts.push_back(snapshot(param_sorts[i], d_worker.get()));
+    ctors.push_back(snapshot(constructors[i], d_worker.get()));
   }
+  run_shadow(d_worker.get(), [this, res, kind, dt_names, psorts, ctors]() {
+    std::vector<AbsSort::DatatypeConstructorMap> ctors_shadow;
+    for (const auto& c : ctors)
+    {
+      ctors_shadow.push_back(unwrap(c, true));
+    }
+    std::vector<Sort> res_shadow =
+        d_solver_shadow->mk_sort(kind, dt_names, psorts, ctors_shadow);
+    MURXLA_TEST(res.size() == res_shadow.size());
+    for (size_t i = 0, n = res.size(); i < n; ++i)
+    {
+      checked_cast<ShadowSort*>(res[i].get())->d_sort_shadow = res_shadow[i];
+    }
+  });
   return res;
 }
 
 Sort
 ShadowSolver::instantiate_sort(Sort param_sort, const std::vector<Sort>& sorts)
 {
-  ShadowSort* sort       = checked_cast<ShadowSort*>(param_sort.get());
-  Sort param_sort_orig   = sort->get_sort();
-  Sort param_sort_shadow = sort->get_sort_shadow();
-
-  std::vector<Sort> sorts_orig, sorts_shadow;
-  get_sorts_helper(sorts, sorts_orig, sorts_shadow);
-
-  Sort s_orig   = d_solver->instantiate_sort(param_sort_orig, sorts_orig);
-  Sort s_shadow = d_solver->instantiate_sort(param_sort_shadow, sorts_shadow);
-
-  std::shared_ptr<ShadowSort> res(new ShadowSort(s_orig, s_shadow));
+  std::shared_ptr<ShadowSort> res = ShadowSort::create(
+      d_solver->instantiate_sort(unwrap(param_sort, false),
+                                 unwrap(sorts, false)),
+      nullptr,
+      d_worker);
+  run_shadow(d_worker.get(),
+             [this, res, param_sort, s = snapshot(sorts, d_worker.get())]() {
+               res->d_sort_shadow = d_solver_shadow->instantiate_sort(
+                   unwrap(param_sort, true), unwrap(s, true));
+             });
   return res;
 }
 
@@ -954,11 +1083,14 @@ ShadowSolver::mk_term(const Op::Kind& kind,
                       const std::vector<Term>& args,
                       const std::vector<uint32_t>& indices)
 {
-  std::vector<Term> terms_orig, terms_shadow;
-  get_terms_helper(args, terms_orig, terms_shadow);
-  Term t        = d_solver->mk_term(kind, terms_orig, indices);
-  Term t_shadow = d_solver_shadow->mk_term(kind, terms_shadow, indices);
-  std::shared_ptr<ShadowTerm> res(new ShadowTerm(t, t_shadow));
+  std::shared_ptr<ShadowTerm> res = ShadowTerm::create(
+      d_solver->mk_term(kind, unwrap(args, false), indices),
+      nullptr,
+      d_worker);
+  run_shadow(d_worker.get(), [this, res, kind, args, indices]() {
+    res->d_term_shadow =
+        d_solver_shadow->mk_term(kind, unwrap(args, true), indices);
+  });
   return res;
 }
 
@@ -967,11 +1099,14 @@ ShadowSolver::mk_term(const Op::Kind& kind,
                       const std::vector<std::string>& str_args,
                       const std::vector<Term>& args)
 {
-  std::vector<Term> terms_orig, terms_shadow;
-  get_terms_helper(args, terms_orig, terms_shadow);
-  Term t        = d_solver->mk_term(kind, str_args, terms_orig);
-  Term t_shadow = d_solver_shadow->mk_term(kind, str_args, terms_shadow);
-  std::shared_ptr<ShadowTerm> res(new ShadowTerm(t, t_shadow));
+  std::shared_ptr<ShadowTerm> res = ShadowTerm::create(
+      d_solver->mk_term(kind, str_args, unwrap(args, false)),
+      nullptr,
+      d_worker);
+  run_shadow(d_worker.get(), [this, res, kind, str_args, args]() {
+    res->d_term_shadow =
+        d_solver_shadow->mk_term(kind, str_args, unwrap(args, true));
+  });
   return res;
 }
 
@@ -981,26 +1116,27 @@ ShadowSolver::mk_term(const Op::Kind& kind,
                       const std::vector<std::string>& str_args,
                       const std::vector<Term>& args)
 {
-  ShadowSort* s_sort = checked_cast<ShadowSort*>(sort.get());
-  Sort sort_orig     = s_sort->get_sort();
-  Sort sort_shadow   = s_sort->get_sort_shadow();
-  std::vector<Term> terms_orig, terms_shadow;
-  get_terms_helper(args, terms_orig, terms_shadow);
-  Term t = d_solver->mk_term(kind, sort_orig, str_args, terms_orig);
-  Term t_shadow =
-      d_solver_shadow->mk_term(kind, sort_shadow, str_args, terms_shadow);
-  std::shared_ptr<ShadowTerm> res(new ShadowTerm(t, t_shadow));
+  std::shared_ptr<ShadowTerm> res = ShadowTerm::create(
+      d_solver->mk_term(
+          kind, unwrap(sort, false), str_args, unwrap(args, false)),
+      nullptr,
+      d_worker);
+  run_shadow(d_worker.get(), [this, res, kind, sort, str_args, args]() {
+    res->d_term_shadow = d_solver_shadow->mk_term(
+        kind, unwrap(sort, true), str_args, unwrap(args, true));
+  });
   return res;
 }
 
 Sort
 ShadowSolver::get_sort(Term term, SortKind sort_kind)
 {
-  ShadowTerm* t = checked_cast<ShadowTerm*>(term.get());
-  assert(t);
-  Sort s        = d_solver->get_sort(t->get_term(), sort_kind);
-  Sort s_shadow = d_solver_shadow->get_sort(t->get_term_shadow(), sort_kind);
-  std::shared_ptr<ShadowSort> res(new ShadowSort(s, s_shadow));
+  std::shared_ptr<ShadowSort> res = ShadowSort::create(
+      d_solver->get_sort(unwrap(term, false), sort_kind), nullptr, d_worker);
+  run_shadow(d_worker.get(), [this, res, term, sort_kind]() {
+    res->d_sort_shadow =
+        d_solver_shadow->get_sort(unwrap(term, true), sort_kind);
+  });
   return res;
 }
 
@@ -1032,58 +1168,68 @@ bool
 ShadowSolver::option_incremental_enabled() const
 {
   return d_solver->option_incremental_enabled()
-         && d_solver_shadow->option_incremental_enabled();
+         && call_shadow(d_worker.get(), [this]() {
+              return d_solver_shadow->option_incremental_enabled();
+            });
 }
 
 bool
 ShadowSolver::option_model_gen_enabled() const
 {
   return d_solver->option_model_gen_enabled()
-         && d_solver_shadow->option_model_gen_enabled();
+         && call_shadow(d_worker.get(), [this]() {
+              return d_solver_shadow->option_model_gen_enabled();
+            });
 }
 
 bool
 ShadowSolver::option_unsat_assumptions_enabled() const
 {
   return d_solver->option_unsat_assumptions_enabled()
-         && d_solver_shadow->option_unsat_assumptions_enabled();
+         && call_shadow(d_worker.get(), [this]() {
+              return d_solver_shadow->option_unsat_assumptions_enabled();
+            });
 }
 
 bool
 ShadowSolver::option_unsat_cores_enabled() const
 {
   return d_solver->option_unsat_cores_enabled()
-         && d_solver_shadow->option_unsat_cores_enabled();
+         && call_shadow(d_worker.get(), [this]() {
+              return d_solver_shadow->option_unsat_cores_enabled();
+            });
 }
 
 bool
 ShadowSolver::is_unsat_assumption(const Term& t) const
 {
-  ShadowTerm* term = checked_cast<ShadowTerm*>(t.get());
-  assert(term);
-  bool res = d_solver->is_unsat_assumption(term->get_term());
+  bool res = d_solver->is_unsat_assumption(unwrap(t, false));
+#ifndef NDEBUG
   if (d_same_solver)
   {
-    assert(res
-           == d_solver_shadow->is_unsat_assumption(term->get_term_shadow()));
+    run_shadow(d_worker.get(), [this, res, t]() {
+      assert(res == d_solver_shadow->is_unsat_assumption(unwrap(t, true)));
+    });
   }
+#endif
   return res;
 }
 
 void
 ShadowSolver::assert_formula(const Term& t)
 {
-  ShadowTerm* term = checked_cast<ShadowTerm*>(t.get());
-  assert(term);
-  d_solver->assert_formula(term->get_term());
-  d_solver_shadow->assert_formula(term->get_term_shadow());
+  d_solver->assert_formula(unwrap(t, false));
+  run_shadow(d_worker.get(), [this, t]() {
+    d_solver_shadow->assert_formula(unwrap(t, true));
+  });
 }
 
 Solver::Result
 ShadowSolver::check_sat()
 {
-  Result res_orig   = d_solver->check_sat();
-  Result res_shadow = d_solver_shadow->check_sat();
+  auto [res_orig, res_shadow] =
+      call_both([this]() { return d_solver->check_sat(); },
+                [this]() { return d_solver_shadow->check_sat(); });
   if (res_orig != Result::UNKNOWN && res_shadow != Result::UNKNOWN)
   {
     MURXLA_TEST(res_orig == res_shadow)
@@ -1096,10 +1242,13 @@ ShadowSolver::check_sat()
 Solver::Result
 ShadowSolver::check_sat_assuming(const std::vector<Term>& assumptions)
 {
-  std::vector<Term> assumptions_orig, assumptions_shadow;
-  get_terms_helper(assumptions, assumptions_orig, assumptions_shadow);
-  Result res_orig   = d_solver->check_sat_assuming(assumptions_orig);
-  Result res_shadow = d_solver_shadow->check_sat_assuming(assumptions_shadow);
+  auto [res_orig, res_shadow] = call_both(
+      [this, &assumptions]() {
+        return d_solver->check_sat_assuming(unwrap(assumptions, false));
+      },
+      [this, assumptions]() {
+        return d_solver_shadow->check_sat_assuming(unwrap(assumptions, true));
+      });
   if (res_orig != Result::UNKNOWN && res_shadow != Result::UNKNOWN)
   {
     MURXLA_TEST(res_orig == res_shadow)
@@ -1113,13 +1262,14 @@ std::vector<Term>
 ShadowSolver::get_unsat_assumptions()
 {
   assert(d_same_solver);
-  std::vector<Term> res, terms, terms_shadow;
-  auto ua_orig   = d_solver->get_unsat_assumptions();
-  auto ua_shadow = d_solver_shadow->get_unsat_assumptions();
+  std::vector<Term> res;
+  auto [ua_orig, ua_shadow] =
+      call_both([this]() { return d_solver->get_unsat_assumptions(); },
+                [this]() { return d_solver_shadow->get_unsat_assumptions(); });
   assert(ua_orig.size() == ua_shadow.size());
   for (size_t i = 0; i < ua_orig.size(); ++i)
   {
-    res.emplace_back(new ShadowTerm(ua_orig[i], ua_shadow[i]));
+    res.push_back(ShadowTerm::create(ua_orig[i], ua_shadow[i], d_worker));
   }
   return res;
 }
@@ -1128,13 +1278,14 @@ std::vector<Term>
 ShadowSolver::get_unsat_core()
 {
   assert(d_same_solver);
-  std::vector<Term> res, terms, terms_shadow;
-  auto uc_orig   = d_solver->get_unsat_core();
-  auto uc_shadow = d_solver_shadow->get_unsat_core();
+  std::vector<Term> res;
+  auto [uc_orig, uc_shadow] =
+      call_both([this]() { return d_solver->get_unsat_core(); },
+                [this]() { return d_solver_shadow->get_unsat_core(); });
   assert(uc_orig.size() == uc_shadow.size());
   for (size_t i = 0; i < uc_orig.size(); ++i)
   {
-    res.emplace_back(new ShadowTerm(uc_orig[i], uc_shadow[i]));
+    res.push_back(ShadowTerm::create(uc_orig[i], uc_shadow[i], d_worker));
   }
   return res;
 }
@@ -1143,45 +1294,51 @@ void
 ShadowSolver::push(uint32_t n_levels)
 {
   d_solver->push(n_levels);
-  d_solver_shadow->push(n_levels);
+  run_shadow(d_worker.get(),
+             [this, n_levels]() { d_solver_shadow->push(n_levels); });
 }
 
 void
 ShadowSolver::pop(uint32_t n_levels)
 {
   d_solver->pop(n_levels);
-  d_solver_shadow->pop(n_levels);
+  run_shadow(d_worker.get(),
+             [this, n_levels]() { d_solver_shadow->pop(n_levels); });
 }
 
 void
 ShadowSolver::print_model()
 {
   d_solver->print_model();
-  d_solver_shadow->print_model();
+  run_shadow(d_worker.get(), [this]() { d_solver_shadow->print_model(); });
 }
 
 void
 ShadowSolver::reset()
 {
   d_solver->reset();
-  d_solver_shadow->reset();
+  run_shadow(d_worker.get(), [this]() { d_solver_shadow->reset(); });
 }
 
 void
 ShadowSolver::reset_assertions()
 {
   d_solver->reset_assertions();
-  d_solver_shadow->reset_assertions();
+  run_shadow(d_worker.get(),
+             [this]() { d_solver_shadow->reset_assertions(); });
 }
 
 void
 ShadowSolver::set_opt(const std::string& opt, const std::string& value)
 {
+  /* Options are set synchronously, errors must be raised by this call. */
   const std::string shadow_prefix = MURXLA_CHECK_SOLVER_OPT_PREFIX;
   if (opt.find(shadow_prefix, 0) == 0)
   {
     std::string name(opt.begin() + shadow_prefix.size(), opt.end());
-    d_solver_shadow->set_opt(name, value);
+    call_shadow(d_worker.get(), [this, &name, &value]() {
+      d_solver_shadow->set_opt(name, value);
+    });
   }
   else
   {
@@ -1190,18 +1347,24 @@ ShadowSolver::set_opt(const std::string& opt, const std::string& value)
 
   if (opt == d_solver->get_option_name_incremental())
   {
-    d_solver_shadow->set_opt(d_solver_shadow->get_option_name_incremental(),
-                             value);
+    call_shadow(d_worker.get(), [this, &value]() {
+      d_solver_shadow->set_opt(d_solver_shadow->get_option_name_incremental(),
+                               value);
+    });
   }
   else if (opt == d_solver->get_option_name_model_gen())
   {
-    d_solver_shadow->set_opt(d_solver_shadow->get_option_name_model_gen(),
-                             value);
+    call_shadow(d_worker.get(), [this, &value]() {
+      d_solver_shadow->set_opt(d_solver_shadow->get_option_name_model_gen(),
+                               value);
+    });
   }
   else if (opt == d_solver->get_option_name_unsat_assumptions())
   {
-    d_solver_shadow->set_opt(
-        d_solver_shadow->get_option_name_unsat_assumptions(), value);
+    call_shadow(d_worker.get(), [this, &value]() {
+      d_solver_shadow->set_opt(
+          d_solver_shadow->get_option_name_unsat_assumptions(), value);
+    });
   }
 }
 
@@ -1210,7 +1373,9 @@ ShadowSolver::get_required_options(Theory theory) const
 {
   auto req_opts = d_solver->get_required_options(theory);
 
-  for (const auto& [name, val] : d_solver_shadow->get_required_options(theory))
+  for (const auto& [name, val] : call_shadow(d_worker.get(), [this, theory]() {
+         return d_solver_shadow->get_required_options(theory);
+       }))
   {
     req_opts.emplace(MURXLA_CHECK_SOLVER_OPT_PREFIX + name, val);
   }
@@ -1221,14 +1386,17 @@ std::vector<Term>
 ShadowSolver::get_value(const std::vector<Term>& terms)
 {
   assert(d_same_solver);
-  std::vector<Term> res, terms_orig, terms_shadow;
-  get_terms_helper(terms, terms_orig, terms_shadow);
-  auto values_orig   = d_solver->get_value(terms_orig);
-  auto values_shadow = d_solver_shadow->get_value(terms_shadow);
+  std::vector<Term> res;
+  auto [values_orig, values_shadow] = call_both(
+      [this, &terms]() { return d_solver->get_value(unwrap(terms, false)); },
+      [this, terms]() {
+        return d_solver_shadow->get_value(unwrap(terms, true));
+      });
   assert(values_orig.size() == values_shadow.size());
   for (size_t i = 0; i < values_orig.size(); ++i)
   {
-    res.emplace_back(new ShadowTerm(values_orig[i], values_shadow[i]));
+    res.push_back(
+        ShadowTerm::create(values_orig[i], values_shadow[i], d_worker));
   }
   return res;
 }
@@ -1237,7 +1405,9 @@ void
 ShadowSolver::disable_unsupported_actions(FSM* fsm) const
 {
   d_solver->disable_unsupported_actions(fsm);
-  d_solver_shadow->disable_unsupported_actions(fsm);
+  call_shadow(d_worker.get(), [this, fsm]() {
+    d_solver_shadow->disable_unsupported_actions(fsm);
+  });
 
   if (!d_same_solver)
   {
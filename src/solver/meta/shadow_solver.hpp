@@ -11,6 +11,7 @@
 #define __MURXLA__SHADOW_SOLVER_H
 
 #include "fsm.hpp"
+#include "solver/meta/shadow_worker.hpp"
 #include "solver/solver.hpp"
 #include "theory.hpp"
 
@@ -23,7 +24,24 @@ class ShadowSort : public AbsSort
   friend class ShadowSolver;
 
  public:
-  ShadowSort(Sort sort, Sort sort_shadow);
+  /**
+   * Create a shadow sort.
+   * @param sort         The sort of the solver under test.
+   * @param sort_shadow  The sort of the shadow solver, may be null if it is
+   *                     set by a task posted to the worker.
+   * @param worker       The worker running the shadow solver, null if the
+   *                     shadow solver runs in lock-step with the solver under
+   *                     test. If not null, the shadow sort is destroyed on
+   *                     the worker thread.
+   */
+  static std::shared_ptr<ShadowSort> create(
+      Sort sort,
+      Sort sort_shadow,
+      const std::shared_ptr<ShadowWorker>& worker);
+
+  ShadowSort(Sort sort,
+             Sort sort_shadow,
+             std::shared_ptr<ShadowWorker> worker = nullptr);
   ~ShadowSort() override;
   size_t hash() const override;
   bool equals(const Sort& other) const override;
@@ -69,11 +87,25 @@ class ShadowSort : public AbsSort
   void set_dt_is_instantiated(bool value) override;
 
   Sort get_sort() const { return d_sort; }
+  /**
+   * Get the sort of the shadow solver.
+   * @note  If the shadow solver runs concurrently, this must only be called
+   *        from tasks executed by the worker.
+   */
   Sort get_sort_shadow() const { return d_sort_shadow; }
 
  private:
+  /**
+   * Release all references to objects of the solver under test, which must
+   * be destroyed on the thread of the solver under test.
+   * @return  The worker, which is reset.
+   */
+  std::shared_ptr<ShadowWorker> release();
+
   Sort d_sort;
   Sort d_sort_shadow;
+  /** The worker running the shadow solver, null in lock-step mode. */
+  std::shared_ptr<ShadowWorker> d_worker;
 };
 
 class ShadowTerm : public AbsTerm
@@ -81,7 +113,24 @@ class ShadowTerm : public AbsTerm
   friend class ShadowSolver;
 
  public:
-  ShadowTerm(Term term, Term term_shadow);
+  /**
+   * Create a shadow term.
+   * @param term         The term of the solver under test.
+   * @param term_shadow  The term of the shadow solver, may be null if it is
+   *                     set by a task posted to the worker.
+   * @param worker       The worker running the shadow solver, null if the
+   *                     shadow solver runs in lock-step with the solver under
+   *                     test. If not null, the shadow term is destroyed on
+   *                     the worker thread.
+   */
+  static std::shared_ptr<ShadowTerm> create(
+      Term term,
+      Term term_shadow,
+      const std::shared_ptr<ShadowWorker>& worker);
+
+  ShadowTerm(Term term,
+             Term term_shadow,
+             std::shared_ptr<ShadowWorker> worker = nullptr);
   ~ShadowTerm() override;
   size_t hash() const override;
   bool equals(const Term& other) const override;
@@ -113,32 +162,73 @@ class ShadowTerm : public AbsTerm
   void set_leaf_kind(LeafKind kind) override;
 
   Term get_term() const { return d_term; }
+  /**
+   * Get the term of the shadow solver.
+   * @note  If the shadow solver runs concurrently, this must only be called
+   *        from tasks executed by the worker.
+   */
   Term get_term_shadow() const { return d_term_shadow; }
 
  private:
+  /**
+   * Release all references to objects of the solver under test, which must
+   * be destroyed on the thread of the solver under test.
+   * @return  The worker, which is reset.
+   */
+  std::shared_ptr<ShadowWorker> release();
+
   Term d_term;
   Term d_term_shadow;
+  /** The worker running the shadow solver, null in lock-step mode. */
+  std::shared_ptr<ShadowWorker> d_worker;
 };
 
 class ShadowSolver : public Solver
 {
  public:
-  static void get_sorts_helper(const std::vector<Sort>& sorts,
-                               std::vector<Sort>& sorts_orig,
-                               std::vector<Sort>& sorts_shadow);
-
-  static void get_param_sort_helper(Sort sort,
-                                    Sort& sort_orig,
-                                    Sort& sort_shadow);
-  static void get_unresolved_sort_helper(Sort sort,
-                                         Sort& sort_orig,
-                                         Sort& sort_shadow);
-
-  static void get_terms_helper(const std::vector<Term>& terms,
-                               std::vector<Term>& terms_orig,
-                               std::vector<Term>& terms_shadow);
-
-  ShadowSolver(SolverSeedGenerator& sng, Solver* solver, Solver* solver_shadow);
+  /**
+   * Get the sort of the solver under test (shadow = false) or of the shadow
+   * solver (shadow = true) that corresponds to given sort. Parameter sorts
+   * and unresolved sorts are copied with their associated sorts and sort
+   * parameters mapped accordingly.
+   */
+  static Sort unwrap(const Sort& sort, bool shadow);
+  static std::vector<Sort> unwrap(const std::vector<Sort>& sorts, bool shadow);
+  static AbsSort::DatatypeConstructorMap unwrap(
+      const AbsSort::DatatypeConstructorMap& ctors, bool shadow);
+  /**
+   * Get the term of the solver under test (shadow = false) or of the shadow
+   * solver (shadow = true) that corresponds to given term.
+   */
+  static Term unwrap(const Term& term, bool shadow);
+  static std::vector<Term> unwrap(const std::vector<Term>& terms, bool shadow);
+  /**
+   * Copy parameter and unresolved sorts in given sort, which may still be
+   * modified after they were passed to the solver. Sorts are passed to tasks
+   * queued to given worker as snapshots, shadow sorts are shared. Returns the
+   * given sort if the worker is null.
+   */
+  static Sort snapshot(const Sort& sort, const ShadowWorker* worker);
+  static std::vector<Sort> snapshot(const std::vector<Sort>& sorts,
+                                    const ShadowWorker* worker);
+  static AbsSort::DatatypeConstructorMap snapshot(
+      const AbsSort::DatatypeConstructorMap& ctors, const ShadowWorker* worker);
+
+  /**
+   * Constructor.
+   * @param sng            The associated solver seed generator.
+   * @param solver         The solver under test.
+   * @param solver_shadow  The solver used for checking.
+   * @param concurrent     True to run the shadow solver concurrently in a
+   *                       worker thread. Results are then only joined at
+   *                       comparison points (check-sat results, values,
+   *                       unsat cores and assumptions, and term and sort
+   *                       equality).
+   */
+  ShadowSolver(SolverSeedGenerator& sng,
+               Solver* solver,
+               Solver* solver_shadow,
+               bool concurrent = false);
   ~ShadowSolver() override;
 
   void new_solver() override;
@@ -229,6 +319,28 @@ class ShadowSolver : public Solver
   void disable_unsupported_actions(FSM* fsm) const override;
 
  protected:
+  /**
+   * Call f on the solver under test and f_shadow on the shadow solver. In
+   * concurrent mode, f_shadow is queued to the worker before f is called and
+   * both are joined after f returns.
+   * @return  The pair of results of f and f_shadow.
+   */
+  template <class F, class G>
+  auto call_both(F&& f, G&& f_shadow)
+      -> std::pair<decltype(f()), decltype(f_shadow())>
+  {
+    if (!d_worker)
+    {
+      auto res = f();
+      return {std::move(res), f_shadow()};
+    }
+    auto res_shadow = d_worker->async(std::forward<G>(f_shadow));
+    auto res        = f();
+    return {std::move(res), d_worker->get(res_shadow)};
+  }
+  /** Wait until all queued calls to the shadow solver have been executed. */
+  void sync_shadow() const;
+
   /** The solver under test. */
   std::unique_ptr<Solver> d_solver;
   /** The solver used for checking. */
@@ -236,6 +348,8 @@ class ShadowSolver : public Solver
   /** Flag that indicates whether d_solver and d_solver_shadow are instances of
    * the same solver. */
   bool d_same_solver;
+  /** The worker running d_solver_shadow, null in lock-step mode. */
+  std::shared_ptr<ShadowWorker> d_worker;
 };
 
 }  // namespace shadow
@@ -0,0 +1,120 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#include "solver/meta/shadow_worker.hpp"
+
+namespace murxla {
+namespace shadow {
+
+/* -------------------------------------------------------------------------- */
+
+ShadowWorker::ShadowWorker() : d_thread(&ShadowWorker::run, this) {}
+
+ShadowWorker::~ShadowWorker()
+{
+  {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    d_stop = true;
+  }
+  d_cv_queued.notify_one();
+  d_thread.join();
+  d_done.clear();
+}
+
+void
+ShadowWorker::post(Task task)
+{
+  std::vector<Task> done;
+  {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    d_tasks.push_back(std::move(task));
+    done.swap(d_done);
+  }
+  d_cv_queued.notify_one();
+  /* Destroying executed tasks may post further tasks, hence this must happen
+   * outside of the lock. */
+  done.clear();
+}
+
+void
+ShadowWorker::sync()
+{
+  std::vector<Task> done;
+  std::exception_ptr exception;
+  do
+  {
+    done.clear();
+    std::unique_lock<std::mutex> lock(d_mutex);
+    d_cv_idle.wait(lock, [this]() { return d_tasks.empty() && !d_busy; });
+    done.swap(d_done);
+    exception = d_exception;
+    d_exception = nullptr;
+  } while (!done.empty() && !exception);
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+void
+ShadowWorker::wait()
+{
+  std::unique_lock<std::mutex> lock(d_mutex);
+  d_cv_idle.wait(lock, [this]() { return d_tasks.empty() && !d_busy; });
+}
+
+void
+ShadowWorker::run()
+{
+  std::unique_lock<std::mutex> lock(d_mutex);
+  while (true)
+  {
+    d_cv_queued.wait(lock, [this]() { return d_stop || !d_tasks.empty(); });
+    if (d_tasks.empty())
+    {
+      break;
+    }
+    Task task = std::move(d_tasks.front());
+    d_tasks.pop_front();
+    bool skip = d_exception != nullptr;
+    d_busy    = true;
+    lock.unlock();
+
+    std::exception_ptr exception;
+    if (!skip)
+    {
+      try
+      {
+        task();
+      }
+      catch (...)
+      {
+        exception = std::current_exception();
+      }
+    }
+
+    lock.lock();
+    if (exception && !d_exception)
+    {
+      d_exception = exception;
+    }
+    d_done.push_back(std::move(task));
+    d_busy = false;
+    if (d_tasks.empty())
+    {
+      d_cv_idle.notify_all();
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace shadow
+}  // namespace murxla
@@ -0,0 +1,157 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__SHADOW_WORKER_H
+#define __MURXLA__SHADOW_WORKER_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace murxla {
+namespace shadow {
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Worker thread that executes the calls to the shadow solver of a
+ * ShadowSolver concurrently to the solver under test.
+ *
+ * Tasks are executed in the order they were posted. All interactions with the
+ * shadow solver and the objects it created, including their destruction, must
+ * go through the worker. Tasks may therefore refer to shadow objects that are
+ * created by previously posted tasks.
+ *
+ * If a task throws an exception, all subsequent tasks are skipped and the
+ * exception is rethrown by the next call to sync() on the posting thread.
+ * Executed tasks are destroyed on the posting thread (on post() and sync()),
+ * hence they may hold references to objects of the solver under test.
+ */
+class ShadowWorker
+{
+ public:
+  using Task = std::function<void()>;
+
+  ShadowWorker();
+  /** Execute the remaining tasks and join the worker thread. */
+  ~ShadowWorker();
+
+  /**
+   * Queue given task for execution on the worker thread.
+   * @param task  The task to execute.
+   */
+  void post(Task task);
+
+  /**
+   * Queue given function for execution on the worker thread.
+   * @param f  The function to execute.
+   * @return  The future result of the function, retrieve via get().
+   */
+  template <class F>
+  auto async(F&& f) -> std::future<decltype(f())>
+  {
+    using R   = decltype(f());
+    auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+    std::future<R> res = task->get_future();
+    post([task]() { (*task)(); });
+    return res;
+  }
+
+  /**
+   * Wait until all queued tasks have been executed. Rethrows the exception
+   * thrown by a task since the last call to sync(), if any.
+   */
+  void sync();
+
+  /**
+   * Wait until all queued tasks have been executed. Unlike sync(), does not
+   * rethrow the exception thrown by a task, which is kept for the next call
+   * to sync(). Executed tasks are not destroyed.
+   */
+  void wait();
+
+  /**
+   * Wait for the result of a function queued via async().
+   * @param res  The future result of the function.
+   * @return  The result of the function.
+   */
+  template <class R>
+  R get(std::future<R>& res)
+  {
+    sync();
+    return res.get();
+  }
+
+ private:
+  /** The main loop of the worker thread. */
+  void run();
+
+  std::mutex d_mutex;
+  /** Notified when a task is queued or the worker is stopped. */
+  std::condition_variable d_cv_queued;
+  /** Notified when the queue runs empty. */
+  std::condition_variable d_cv_idle;
+  /** The queued tasks. */
+  std::deque<Task> d_tasks;
+  /** The executed tasks, to be destroyed on the posting thread. */
+  std::vector<Task> d_done;
+  /** True while the worker thread executes a task. */
+  bool d_busy = false;
+  /** True if the worker thread should terminate once the queue is empty. */
+  bool d_stop = false;
+  /** The exception thrown by a task since the last call to sync(). */
+  std::exception_ptr d_exception;
+  /** The worker thread. */
+  std::thread d_thread;
+};
+
+/**
+ * Run given task on given worker, or immediately if the worker is null, i.e.,
+ * if the shadow solver runs in lock-step with the solver under test.
+ */
+template <class F>
+void
+run_shadow(ShadowWorker* worker, F&& task)
+{
+  if (worker == nullptr)
+  {
+    task();
+    return;
+  }
+  worker->post(std::forward<F>(task));
+}
+
+/**
+ * Run given function on given worker and wait for its result, or call it
+ * immediately if the worker is null.
+ */
+template <class F>
+auto
+call_shadow(ShadowWorker* worker, F&& f) -> decltype(f())
+{
+  if (worker == nullptr)
+  {
+    return f();
+  }
+  auto res = worker->async(std::forward<F>(f));
+  return worker->get(res);
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace shadow
+}  // namespace murxla
+
+#endif
@@ -9,14 +9,21 @@
  */
 #include "smt2_solver.hpp"
 
+#include <poll.h>
 #include <signal.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 #include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstring>
 #include <unordered_map>
+#include <unordered_set>
 
+#include "arena.hpp"
 #include "exit.hpp"
 #include "murxla.hpp"
 #include "solver/smt2/profile.hpp"
@@ -31,7 +38,10 @@ static pid_t s_online_solver_pid = 0;
 static void
 kill_online_solver(int32_t sig)
 {
-  kill(s_online_solver_pid, SIGKILL);
+  if (s_online_solver_pid)
+  {
+    kill(s_online_solver_pid, SIGKILL);
+  }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -160,6 +170,16 @@ get_set_sort_string(const std::vector<Sort>& sorts)
   return sort.str();
 }
 
+/* -------------------------------------------------------------------------- */
+
+const std::string*
+intern(const std::string& s)
+{
+  /* References to elements of unordered sets stay valid on insertion. */
+  static std::unordered_set<std::string> strings;
+  return &*strings.insert(s).first;
+}
+
 /* -------------------------------------------------------------------------- */
 /* Smt2Sort                                                                   */
 /* -------------------------------------------------------------------------- */
@@ -167,19 +187,19 @@ get_set_sort_string(const std::vector<Sort>& sorts)
 size_t
 Smt2Sort::hash() const
 {
-  return std::hash<std::string>{}(d_repr);
+  return std::hash<std::string>{}(*d_repr);
 }
 
 bool
 Smt2Sort::equals(const Sort& other) const
 {
-  return d_repr == static_cast<Smt2Sort*>(other.get())->get_repr();
+  return d_repr == static_cast<Smt2Sort*>(other.get())->d_repr;
 }
 
 std::string
 Smt2Sort::to_string() const
 {
-  return d_repr;
+  return *d_repr;
 }
 
 bool
@@ -293,7 +313,7 @@ Smt2Sort::get_bv_size() const
 std::string
 Smt2Sort::get_dt_name() const
 {
-  return d_repr;
+  return *d_repr;
 }
 
 std::string
@@ -317,7 +337,7 @@ Smt2Sort::get_fp_sig_size() const
 const std::string&
 Smt2Sort::get_repr() const
 {
-  return d_repr;
+  return *d_repr;
 }
 
 void
@@ -338,7 +358,7 @@ Smt2Sort::get_array_index_sort() const
   assert(is_array());
   const Smt2Sort* smt2_index_sort =
       static_cast<const Smt2Sort*>(d_sorts[0].get());
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(smt2_index_sort->get_repr()));
+  return make_arena_shared<Smt2Sort>(smt2_index_sort->get_repr());
 }
 
 Sort
@@ -347,7 +367,7 @@ Smt2Sort::get_array_element_sort() const
   assert(is_array());
   const Smt2Sort* smt2_element_sort =
       static_cast<const Smt2Sort*>(d_sorts[1].get());
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(smt2_element_sort->get_repr()));
+  return make_arena_shared<Smt2Sort>(smt2_element_sort->get_repr());
 }
 
 uint32_t
@@ -363,8 +383,7 @@ Smt2Sort::get_fun_codomain_sort() const
   assert(is_fun());
   const Smt2Sort* smt2_codomain_sort =
       static_cast<const Smt2Sort*>(d_sorts.back().get());
-  return std::shared_ptr<Smt2Sort>(
-      new Smt2Sort(smt2_codomain_sort->get_repr()));
+  return make_arena_shared<Smt2Sort>(smt2_codomain_sort->get_repr());
 }
 
 std::vector<Sort>
@@ -377,7 +396,7 @@ Smt2Sort::get_fun_domain_sorts() const
   {
     const Smt2Sort* smt2_domain_sort =
         static_cast<const Smt2Sort*>(d_sorts[i].get());
-    res.emplace_back(new Smt2Sort(smt2_domain_sort->get_repr()));
+    res.push_back(make_arena_shared<Smt2Sort>(smt2_domain_sort->get_repr()));
   }
   return res;
 }
@@ -388,7 +407,7 @@ Smt2Sort::get_bag_element_sort() const
   assert(is_bag());
   const Smt2Sort* smt2_element_sort =
       static_cast<const Smt2Sort*>(d_sorts.back().get());
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(smt2_element_sort->get_repr()));
+  return make_arena_shared<Smt2Sort>(smt2_element_sort->get_repr());
 }
 
 Sort
@@ -397,7 +416,7 @@ Smt2Sort::get_seq_element_sort() const
   assert(is_seq());
   const Smt2Sort* smt2_element_sort =
       static_cast<const Smt2Sort*>(d_sorts.back().get());
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(smt2_element_sort->get_repr()));
+  return make_arena_shared<Smt2Sort>(smt2_element_sort->get_repr());
 }
 
 Sort
@@ -406,13 +425,27 @@ Smt2Sort::get_set_element_sort() const
   assert(is_set());
   const Smt2Sort* smt2_element_sort =
       static_cast<const Smt2Sort*>(d_sorts.back().get());
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(smt2_element_sort->get_repr()));
+  return make_arena_shared<Smt2Sort>(smt2_element_sort->get_repr());
 }
 
 /* -------------------------------------------------------------------------- */
 /* Smt2Term                                                                   */
 /* -------------------------------------------------------------------------- */
 
+std::shared_ptr<Smt2Term>
+Smt2Term::create(Op::Kind kind,
+                 std::vector<std::string> str_args,
+                 std::vector<Term> args,
+                 std::vector<uint32_t> indices,
+                 const std::string& repr)
+{
+  return make_arena_shared<Smt2Term>(kind,
+                                     std::move(str_args),
+                                     std::move(args),
+                                     std::move(indices),
+                                     repr);
+}
+
 size_t
 Smt2Term::hash() const
 {
@@ -422,7 +455,7 @@ Smt2Term::hash() const
   hash_combine(h, get_leaf_kind());
   if (get_kind() == Op::UNDEFINED)
   {
-    hash_combine(h, d_repr);
+    hash_combine(h, *d_repr);
   }
   else
   {
@@ -458,8 +491,8 @@ Smt2Term::equals(const Term& other) const
   /* Leaf terms */
   if (get_kind() == Op::UNDEFINED)
   {
-    assert(!d_repr.empty());
-    assert(!smt2_term->d_repr.empty());
+    assert(d_repr);
+    assert(smt2_term->d_repr);
     return d_repr == smt2_term->d_repr;
   }
   for (size_t i = 0, n = args.size(); i < n; ++i)
@@ -489,10 +522,10 @@ Smt2Term::equals(const Term& other) const
 std::string
 Smt2Term::to_string() const
 {
-  return d_repr;
+  return d_repr ? *d_repr : "";
 }
 
-const std::string&
+const Op::Kind&
 Smt2Term::get_kind() const
 {
   return d_kind;
@@ -546,15 +579,18 @@ get_default(const std::unordered_map<std::string, std::string>& map,
 const std::string
 Smt2Term::get_repr() const
 {
-  if (!d_repr.empty())
+  if (d_repr)
   {
-    return d_repr;
+    return *d_repr;
   }
 
   std::vector<const Smt2Term*> visit;
-  std::unordered_map<const Smt2Term*, std::string> cache;
   std::unordered_map<const Smt2Term*, uint64_t> refs;
-  std::vector<std::string> lets;
+  /* Maps visited terms to true if their subterms have been visited. */
+  std::unordered_map<const Smt2Term*, bool> cache;
+  /* The let-bound terms in the order of their bindings. */
+  std::vector<const Smt2Term*> bound;
+  LetMap lets;
 
   std::unordered_set<Op::Kind> new_scope = {
       Op::FORALL, Op::EXISTS, Op::SET_COMPREHENSION, Op::DT_MATCH, Op::FUN};
@@ -566,10 +602,8 @@ Smt2Term::get_repr() const
     const Smt2Term* cur = visit.back();
     visit.pop_back();
 
-    const auto& it = cache.find(cur);
-    if (it == cache.end())
+    if (cache.emplace(cur, false).second)
     {
-      cache.emplace(cur, "");
       /* Do not go below quantifiers. */
       if (new_scope.find(cur->d_kind) != new_scope.end())
       {
@@ -580,266 +614,300 @@ Smt2Term::get_repr() const
         visit.push_back(to_smt2_term(arg));
         refs[visit.back()] += 1;
       }
-      continue;
     }
   }
 
+  /* Bind terms with more than one reference in post-order, i.e., subterms
+   * are bound before the terms they occur in. */
   cache.clear();
   visit.push_back(this);
   while (!visit.empty())
   {
     const Smt2Term* cur = visit.back();
 
-    const auto& it = cache.find(cur);
-    if (it == cache.end())
+    auto [it, inserted] = cache.emplace(cur, false);
+    if (inserted)
     {
-      cache.emplace(cur, "");
       for (const auto& arg : cur->d_args)
       {
         visit.push_back(to_smt2_term(arg));
       }
       continue;
     }
-    else
+    if (!it->second)
     {
-      std::stringstream res;
-
-      size_t i = 0;
-      if (cur->get_leaf_kind() != AbsTerm::LeafKind::NONE
-          || cur->get_kind() == Op::FUN)
+      it->second = true;
+      if (refs[cur] > 1 && cur->get_leaf_kind() == AbsTerm::LeafKind::NONE)
       {
-        assert(!cur->d_repr.empty());
-        res << cur->d_repr;
+        lets.emplace(cur, "_let" + std::to_string(bound.size()));
+        bound.push_back(cur);
       }
-      else
-      {
-        if (cur->d_kind == Op::DT_APPLY_TESTER)
-        {
-          assert(cur->d_str_args.size() == 1);
-          res << "((_ " << d_op_kind_to_str.at(cur->d_kind) << " "
-              << cur->d_str_args[0] << ")";
-        }
-        else if (cur->d_kind == Op::DT_APPLY_UPDATER)
-        {
-          assert(cur->d_str_args.size() == 2);
-          res << "((_ " << d_op_kind_to_str.at(cur->d_kind) << " "
-              << cur->d_str_args[1] << ")";
-        }
-        else if (cur->d_kind == Op::DT_MATCH)
-        {
-          res << "(" << d_op_kind_to_str.at(cur->d_kind) << " "
-              << to_smt2_term(cur->d_args[i++])->get_repr() << " (";
-          for (size_t n = cur->d_args.size(); i < n; ++i)
-          {
-            res << to_smt2_term(cur->d_args[i])->get_repr();
-          }
-          res << "))";
-        }
-        else if (cur->d_kind == Op::DT_MATCH_BIND_CASE)
-        {
-          if (cur->d_str_args.empty())
-          {
-            /* variable pattern */
-            assert(cur->d_args.size() == 2);
-            res << "(" << to_smt2_term(cur->d_args[0])->get_repr() << " "
-                << to_smt2_term(cur->d_args[1])->get_repr() << ")";
-            i = 2;
-          }
-          else
-          {
-            res << "((" << cur->d_str_args[0] << " ";
-            for (size_t n = cur->d_args.size() - 1; i < n; ++i)
-            {
-              if (i > 0) res << " ";
-              res << to_smt2_term(cur->d_args[i])->get_repr();
-            }
-            res << ") ";
-            res << to_smt2_term(cur->d_args[i++])->get_repr();
-            res << ")";
-          }
-        }
-        else if (cur->d_kind == Op::DT_MATCH_CASE)
-        {
-          assert(cur->d_str_args.size() == 1);
-          assert(cur->d_args.size() == 1);
-          res << "(" << cur->d_str_args[0] << " "
-              << to_smt2_term(cur->d_args[0])->get_repr() << ") ";
-          i = cur->d_args.size();
-        }
-        else if (cur->d_indices.empty())
-        {
-          if (!cur->d_args.empty())
-          {
-            res << "(";
-          }
-          if (cur->d_kind == Op::UF_APPLY)
-          {
-            res << to_smt2_term(cur->d_args[0])->get_repr();
-            i += 1;
-          }
-          else if (cur->d_kind == Op::DT_APPLY_CONS)
-          {
-            assert(cur->get_str_args().size() == 1);
-            res << cur->get_str_args()[0];
-          }
-          else if (cur->d_kind == Op::DT_APPLY_SEL)
-          {
-            assert(cur->get_str_args().size() == 2);
-            res << cur->get_str_args()[1];
-          }
-          else
-          {
-            res << get_default(d_op_kind_to_str, cur->d_kind, cur->d_kind);
-          }
-          if (cur->d_kind == Op::FORALL || cur->d_kind == Op::EXISTS
-              || cur->d_kind == Op::SET_COMPREHENSION)
-          {
-            assert(cur->d_args.size() > 1);
-            size_t size = cur->d_args.size() - 1;
-            if (cur->d_kind == Op::SET_COMPREHENSION)
-            {
-              assert(size >= 1);
-              size -= 1;
-            }
-            /* print bound variables, body is last argument term in d_args */
-            res << " (";
-            for (; i < size; ++i)
-            {
-              if (i > 0) res << " ";
-              const Smt2Term* smt2_term = to_smt2_term(cur->d_args[i]);
-              assert(smt2_term->get_leaf_kind() == AbsTerm::LeafKind::VARIABLE);
-              Smt2Sort* smt2_sort =
-                  static_cast<Smt2Sort*>(cur->d_args[i]->get_sort().get());
+    }
+    visit.pop_back();
+  }
+
+  /* Print the bindings and the term in one pass, each shared subterm is
+   * only printed once. */
+  std::string res;
+  for (const Smt2Term* t : bound)
+  {
+    res += "(let ((";
+    res += lets.at(t);
+    res += " ";
+    print_term(t, lets, res);
+    res += "))";
+  }
+  print(this, lets, res);
+  res.append(bound.size(), ')');
+  return res;
+}
 
-              const auto itt = cache.find(smt2_term);
-              assert(itt != cache.end());
-              assert(!itt->second.empty());
+void
+Smt2Term::print(const Smt2Term* term, const LetMap& lets, std::string& out)
+{
+  auto it = lets.find(term);
+  if (it != lets.end())
+  {
+    out += it->second;
+  }
+  else
+  {
+    print_term(term, lets, out);
+  }
+}
 
-              res << "(" << itt->second << " " << smt2_sort->get_repr() << ")";
-            }
-            res << ")";
-          }
-        }
-        else
-        {
-          res << "((_ "
-              << get_default(d_op_kind_to_str, cur->d_kind, cur->d_kind);
-          for (uint32_t p : cur->d_indices)
-          {
-            res << " " << p;
-          }
-          res << ")";
-        }
-        size_t size = cur->d_args.size();
-        if (i < size)
-        {
-          for (; i < size; ++i)
-          {
-            const auto itt = cache.find(to_smt2_term(cur->d_args[i]));
-            assert(itt != cache.end());
-            assert(!itt->second.empty());
-            res << " " << itt->second;
-          }
-          if (!cur->d_args.empty())
-          {
-            res << ")";
-          }
-        }
-      }
+void
+Smt2Term::print_term(const Smt2Term* term,
+                     const LetMap& lets,
+                     std::string& out)
+{
+  if (term->get_leaf_kind() != AbsTerm::LeafKind::NONE
+      || term->get_kind() == Op::FUN)
+  {
+    assert(term->d_repr);
+    out += *term->d_repr;
+    return;
+  }
 
-      if (it->second.empty())
+  const Op::Kind& kind          = term->d_kind;
+  const std::vector<Term>& args = term->d_args;
+  size_t i                      = 0;
+  if (kind == Op::DT_APPLY_TESTER)
+  {
+    assert(term->d_str_args.size() == 1);
+    out += "((_ " + s_op_kind_to_str.at(kind) + " " + term->d_str_args[0]
+           + ")";
+  }
+  else if (kind == Op::DT_APPLY_UPDATER)
+  {
+    assert(term->d_str_args.size() == 2);
+    out += "((_ " + s_op_kind_to_str.at(kind) + " " + term->d_str_args[1]
+           + ")";
+  }
+  else if (kind == Op::DT_MATCH)
+  {
+    out += "(" + s_op_kind_to_str.at(kind) + " "
+           + to_smt2_term(args[i++])->get_repr() + " (";
+    for (size_t n = args.size(); i < n; ++i)
+    {
+      out += to_smt2_term(args[i])->get_repr();
+    }
+    out += "))";
+  }
+  else if (kind == Op::DT_MATCH_BIND_CASE)
+  {
+    if (term->d_str_args.empty())
+    {
+      /* variable pattern */
+      assert(args.size() == 2);
+      out += "(" + to_smt2_term(args[0])->get_repr() + " "
+             + to_smt2_term(args[1])->get_repr() + ")";
+      i = 2;
+    }
+    else
+    {
+      out += "((" + term->d_str_args[0] + " ";
+      for (size_t n = args.size() - 1; i < n; ++i)
       {
-        uint64_t nrefs = refs[cur];
-
-        if (nrefs > 1 && cur->get_leaf_kind() == AbsTerm::LeafKind::NONE)
-        {
-          std::stringstream let;
-          let << "_let" << lets.size() / 2;
-          lets.push_back(let.str());
-          lets.push_back(res.str());
-          it->second = let.str();
-        }
-        else
-        {
-          it->second = res.str();
-        }
+        if (i > 0) out += " ";
+        out += to_smt2_term(args[i])->get_repr();
       }
+      out += ") " + to_smt2_term(args[i++])->get_repr() + ")";
     }
-    visit.pop_back();
   }
-
-  auto itt = cache.find(this);
-  assert(itt != cache.end());
-  assert(!itt->second.empty());
-  std::string t = itt->second;
-
-  std::stringstream res;
-  if (!lets.empty())
+  else if (kind == Op::DT_MATCH_CASE)
+  {
+    assert(term->d_str_args.size() == 1);
+    assert(args.size() == 1);
+    out += "(" + term->d_str_args[0] + " " + to_smt2_term(args[0])->get_repr()
+           + ") ";
+    i = args.size();
+  }
+  else if (term->d_indices.empty())
   {
-    std::stringstream close;
-    for (size_t i = 0; i < lets.size(); i += 2)
+    if (!args.empty())
     {
-      res << "(let ((" << lets[i] << " " << lets[i + 1] << "))";
-      close << ")";
+      out += "(";
+    }
+    if (kind == Op::UF_APPLY)
+    {
+      out += to_smt2_term(args[0])->get_repr();
+      i += 1;
+    }
+    else if (kind == Op::DT_APPLY_CONS)
+    {
+      assert(term->d_str_args.size() == 1);
+      out += term->d_str_args[0];
+    }
+    else if (kind == Op::DT_APPLY_SEL)
+    {
+      assert(term->d_str_args.size() == 2);
+      out += term->d_str_args[1];
+    }
+    else
+    {
+      out += get_default(s_op_kind_to_str, kind, kind);
+    }
+    if (kind == Op::FORALL || kind == Op::EXISTS
+        || kind == Op::SET_COMPREHENSION)
+    {
+      assert(args.size() > 1);
+      size_t size = args.size() - 1;
+      if (kind == Op::SET_COMPREHENSION)
+      {
+        assert(size >= 1);
+        size -= 1;
+      }
+      /* print bound variables, body is last argument term in d_args */
+      out += " (";
+      for (; i < size; ++i)
+      {
+        if (i > 0) out += " ";
+        const Smt2Term* smt2_term = to_smt2_term(args[i]);
+        assert(smt2_term->get_leaf_kind() == AbsTerm::LeafKind::VARIABLE);
+        Smt2Sort* smt2_sort = static_cast<Smt2Sort*>(args[i]->get_sort().get());
+        out += "(" + *smt2_term->d_repr + " " + smt2_sort->get_repr() + ")";
+      }
+      out += ")";
     }
-    res << itt->second << close.str();
   }
   else
   {
-    res << itt->second;
+    out += "((_ " + get_default(s_op_kind_to_str, kind, kind);
+    for (uint32_t p : term->d_indices)
+    {
+      out += " " + std::to_string(p);
+    }
+    out += ")";
   }
 
-  return res.str();
+  if (i < args.size())
+  {
+    for (size_t n = args.size(); i < n; ++i)
+    {
+      out += " ";
+      print(to_smt2_term(args[i]), lets, out);
+    }
+    out += ")";
+  }
 }
 
 /* -------------------------------------------------------------------------- */
 /* Smt2Solver                                                                 */
 /* -------------------------------------------------------------------------- */
 
-/* Trim whitespaces (in place) from given str. */
-static void
-trim_str(std::string& s)
+/* Trim whitespaces from given str. */
+static std::string_view
+trim_str(std::string_view s)
 {
-  /* trim from left */
-  s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](int ch) {
-            return !std::isspace(ch);
-          }));
-  /* trim from right */
-  s.erase(std::find_if(
-              s.rbegin(), s.rend(), [](int ch) { return !std::isspace(ch); })
-              .base(),
-          s.end());
+  while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front())))
+  {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back())))
+  {
+    s.remove_suffix(1);
+  }
+  return s;
 }
 
 void
 Smt2Solver::push_to_external(std::string s, ResponseKind expected)
 {
-  assert(d_file_to);
-  assert(d_file_from);
-  fputs(s.c_str(), d_file_to);
-  fputc('\n', d_file_to);
-  fflush(d_file_to);
-  std::string res = get_from_external();
-  trim_str(res);
+  assert(d_fd_to >= 0);
+  assert(d_fd_from >= 0);
+  write_to_external(std::move(s));
+  if (d_pipelined && expected == ResponseKind::SMT2_SUCCESS)
+  {
+    if (d_num_commands - d_num_responses >= SMT2_MAX_PENDING)
+    {
+      sync_with_external(d_num_commands);
+    }
+    return;
+  }
+  sync_with_external(d_num_commands - 1);
+  check_response(get_from_external(), expected);
+}
+
+void
+Smt2Solver::write_to_external(std::string s)
+{
+  s.push_back('\n');
+  const char* buf = s.data();
+  size_t size     = s.size();
+  double deadline = d_timeout > 0 ? get_cur_wall_time() + d_timeout : 0;
+  while (size > 0)
+  {
+    wait_for_external(d_fd_to, POLLOUT, deadline);
+    /* A pipe that is ready for writing accepts at least PIPE_BUF bytes
+     * without blocking. */
+    ssize_t n = write(
+        d_fd_to, buf, deadline > 0 ? std::min<size_t>(size, PIPE_BUF) : size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0)
+    {
+      /* The online solver terminated, report the response of the pending
+       * commands (end of file) if there are any. */
+      if (errno == EPIPE)
+      {
+        sync_with_external(d_num_commands);
+      }
+      std::cerr << "[murxla] SMT2: Error: writing to online solver failed: "
+                << std::strerror(errno) << std::endl;
+      exit(EXIT_ERROR);
+    }
+    buf += n;
+    size -= static_cast<size_t>(n);
+  }
+  ++d_num_commands;
+}
+
+void
+Smt2Solver::sync_with_external(uint64_t seq)
+{
+  while (d_num_responses < seq)
+  {
+    check_response(get_from_external(), ResponseKind::SMT2_SUCCESS);
+  }
+}
+
+void
+Smt2Solver::check_response(std::string_view res, ResponseKind expected)
+{
+  ++d_num_responses;
+  res = trim_str(res);
+
+  std::stringstream error;
   switch (expected)
   {
     case ResponseKind::SMT2_SUCCESS:
       if (res != "success")
       {
-        std::cerr << "[murxla] SMT2: Error: expected 'success' response from "
-                     "online solver but got '"
-                  << res << "'" << std::endl;
-        exit(EXIT_ERROR);
+        error << "expected 'success' response from online solver but got '"
+              << res << "'";
       }
       break;
     case ResponseKind::SMT2_SAT:
-      if (res != "sat" && res != "unsat" && res != "unknown")
-      {
-        std::cerr << "[murxla] SMT2: Error: expected 'sat', 'unsat' or "
-                     "'unknown' response from online solver but got '"
-                  << res << "'" << std::endl;
-        exit(EXIT_ERROR);
-      }
       if (res == "sat")
       {
         d_last_result = Solver::Result::SAT;
@@ -852,69 +920,148 @@ Smt2Solver::push_to_external(std::string s, ResponseKind expected)
       {
         d_last_result = Solver::Result::UNKNOWN;
       }
+      else
+      {
+        error << "expected 'sat', 'unsat' or 'unknown' response from online "
+                 "solver but got '"
+              << res << "'";
+      }
       break;
     default:
       assert(expected == ResponseKind::SMT2_SEXPR);
-      if (res[0] != '(' || res.find("error") != std::string::npos
-          || res.find("Error") != std::string::npos
-          || res.find("ERROR") != std::string::npos)
+      if (res.empty() || res[0] != '(' || res.find("error") != res.npos
+          || res.find("Error") != res.npos || res.find("ERROR") != res.npos)
       {
-        std::cerr << "[murxla] SMT2: Error: expected S-expression response "
-                     "from online solver but got '"
-                  << res << "'" << std::endl;
-        exit(EXIT_ERROR);
+        error << "expected S-expression response from online solver but got '"
+              << res << "'";
       }
   }
+
+  if (error.tellp() > 0)
+  {
+    std::cerr << "[murxla] SMT2: Error: " << error.str();
+    if (d_pipelined)
+    {
+      std::cerr << " for command " << d_num_responses;
+    }
+    std::cerr << std::endl;
+    exit(EXIT_ERROR);
+  }
 }
 
 /**
  * Either parses one line or an s-expression if the first character of the
- * stream is '('.
+ * response is '('. Parentheses in string literals and quoted symbols of an
+ * s-expression are ignored. The response is scanned incrementally while it
+ * is read from the online solver, characters are never rescanned.
  */
-std::string
-Smt2Solver::get_from_external() const
+std::string_view
+Smt2Solver::get_from_external()
 {
-  std::vector<std::string> lines;
-  std::stringstream ss;
+  /* Move the unconsumed output of the online solver to the front. */
+  if (d_response_begin > 0)
+  {
+    std::memmove(d_response_buf.data(),
+                 d_response_buf.data() + d_response_begin,
+                 d_response_end - d_response_begin);
+    d_response_end -= d_response_begin;
+    d_response_begin = 0;
+  }
+
+  double deadline = d_timeout > 0 ? get_cur_wall_time() + d_timeout : 0;
   size_t in_sexpr = 0;
-  size_t nchars   = 0;
-  while (true)
+  bool in_string = false, in_symbol = false;
+  size_t i = 0;
+  for (;;)
   {
-    int32_t c = fgetc(d_file_from);
-    ++nchars;
-    if (c == EOF)
-    {
-      return "[EOF]";
-    }
-    else if (c == '(' && (in_sexpr || nchars == 1))
+    for (; i < d_response_end; ++i)
     {
-      ++in_sexpr;
+      char c = d_response_buf[i];
+      if (in_string)
+      {
+        /* Escaped quotes ("") toggle twice. */
+        if (c == '"') in_string = false;
+      }
+      else if (in_symbol)
+      {
+        if (c == '|') in_symbol = false;
+      }
+      else if (c == '(' && (in_sexpr || i == 0))
+      {
+        ++in_sexpr;
+      }
+      else if (in_sexpr)
+      {
+        if (c == ')')
+          --in_sexpr;
+        else if (c == '"')
+          in_string = true;
+        else if (c == '|')
+          in_symbol = true;
+      }
+      else if (c == '\n')
+      {
+        d_response_begin = i + 1;
+        std::string_view res(d_response_buf.data(), d_response_begin);
+        for (size_t pos = 0, eol; pos < res.size(); pos = eol + 1)
+        {
+          eol = res.find('\n', pos);
+          d_out << "; " << res.substr(pos, eol + 1 - pos);
+        }
+        d_out << std::flush;
+        return res;
+      }
     }
-    else if (c == ')' && in_sexpr)
+    if (!read_from_external(deadline))
     {
-      --in_sexpr;
+      return "[EOF]";
     }
+  }
+}
 
-    ss << ((char) c);
-    if (c == '\n')
-    {
-      lines.push_back(ss.str());
-      ss.str("");
-      ss.clear();
-    }
-    if (c == '\n' && !in_sexpr)
-    {
-      break;
-    }
+bool
+Smt2Solver::read_from_external(double deadline)
+{
+  if (d_response_end == d_response_buf.size())
+  {
+    d_response_buf.resize(
+        std::max(SMT2_READ_BUFFER_SIZE, 2 * d_response_buf.size()));
   }
-  std::string res;
-  for (auto& line : lines)
+
+  for (;;)
   {
-    d_out << "; " << line;
-    res += line;
+    wait_for_external(d_fd_from, POLLIN, deadline);
+    ssize_t n = read(d_fd_from,
+                     d_response_buf.data() + d_response_end,
+                     d_response_buf.size() - d_response_end);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    d_response_end += static_cast<size_t>(n);
+    return true;
+  }
+}
+
+void
+Smt2Solver::wait_for_external(int32_t fd, int16_t events, double deadline)
+{
+  if (deadline <= 0) return;
+  for (;;)
+  {
+    double left = deadline - get_cur_wall_time();
+    int32_t ms  = left > 0 ? static_cast<int32_t>(std::ceil(left * 1000)) : 0;
+    struct pollfd pfd = {fd, events, 0};
+    int32_t n         = poll(&pfd, 1, ms);
+    if (n < 0 && errno == EINTR) continue;
+    if (n == 0)
+    {
+      /* A hung online solver is a timeout of the test run, not an error. */
+      kill(d_online_pid, SIGKILL);
+      MURXLA_EXIT_TIMEOUT_FORK(true, true)
+          << "[murxla] SMT2: no response from online solver within "
+          << d_timeout << "s";
+    }
+    return;
   }
-  d_out << std::flush;
-  return res;
 }
 
 void
@@ -926,28 +1073,35 @@ Smt2Solver::dump_smt2(std::string s, ResponseKind expected)
 
 Smt2Solver::Smt2Solver(SolverSeedGenerator& sng,
                        std::ostream& out,
-                       const std::string& solver_binary)
+                       const std::string& solver_binary,
+                       double timeout,
+                       bool pipelined)
     : Solver(sng),
       d_out(out),
       d_online(!solver_binary.empty()),
-      d_file_to(nullptr),
-      d_file_from(nullptr),
+      d_timeout(timeout),
+      d_pipelined(pipelined),
       d_solver_call(solver_binary)
 {
 }
 
 Smt2Solver::~Smt2Solver()
 {
+  if (d_fd_to >= 0) close(d_fd_to);
+  if (d_fd_from >= 0) close(d_fd_from);
   if (d_online_pid)
   {
     assert(d_online);
     waitpid(d_online_pid, nullptr, 0);
+    s_online_solver_pid = 0;
   }
 }
 
 void
 Smt2Solver::new_solver()
 {
+  Smt2Sort::reset_symbol_cnt();
+
   if (d_online)
   {
     int32_t fd_to[2], fd_from[2];
@@ -1001,13 +1155,17 @@ Smt2Solver::new_solver()
 
     close(fd_to[SMT2_READ_END]);
     close(fd_from[SMT2_WRITE_END]);
-    d_file_to   = fdopen(fd_to[SMT2_WRITE_END], "w");
-    d_file_from = fdopen(fd_from[SMT2_READ_END], "r");
+    d_fd_to   = fd_to[SMT2_WRITE_END];
+    d_fd_from = fd_from[SMT2_READ_END];
+    d_response_buf.resize(SMT2_READ_BUFFER_SIZE);
+    d_response_begin = 0;
+    d_response_end   = 0;
+    d_num_commands   = 0;
+    d_num_responses  = 0;
 
-    MURXLA_EXIT_ERROR_FORK(d_file_to == nullptr, true)
-        << "opening read channel to external solver failed";
-    MURXLA_EXIT_ERROR_FORK(d_file_from == nullptr, true)
-        << "opening write channel to external solver failed";
+    /* Writing to the online solver after it terminated must not kill this
+     * process, the termination is reported via its (missing) responses. */
+    signal(SIGPIPE, SIG_IGN);
   }
 
   d_initialized = true;
@@ -1024,6 +1182,11 @@ void
 Smt2Solver::delete_solver()
 {
   dump_smt2("(exit)");
+  /* Check the responses of all pending commands in pipelined mode. */
+  if (d_online)
+  {
+    sync_with_external(d_num_commands);
+  }
 }
 
 bool
@@ -1038,6 +1201,12 @@ Smt2Solver::get_name() const
   return "Smt2";
 }
 
+bool
+Smt2Solver::is_reentrant() const
+{
+  return true;
+}
+
 const std::string
 Smt2Solver::get_profile() const
 {
@@ -1054,8 +1223,7 @@ Smt2Solver::mk_var(Sort sort, const std::string& name)
     ss << "_v" << d_n_unnamed_vars++;
     symbol = ss.str();
   }
-  return std::shared_ptr<Smt2Term>(
-      new Smt2Term(Op::UNDEFINED, {}, {}, {}, symbol));
+  return Smt2Term::create(Op::UNDEFINED, {}, {}, {}, symbol);
 }
 
 Term
@@ -1087,8 +1255,7 @@ Smt2Solver::mk_const(Sort sort, const std::string& name)
     smt2 << "(declare-const " << symbol << " " << smt2_sort->get_repr() << ")";
   }
   dump_smt2(smt2.str());
-  return std::shared_ptr<Smt2Term>(
-      new Smt2Term(Op::UNDEFINED, {}, {}, {}, symbol));
+  return Smt2Term::create(Op::UNDEFINED, {}, {}, {}, symbol);
 }
 
 Term
@@ -1121,8 +1288,7 @@ Smt2Solver::mk_fun(const std::string& name,
   dump_smt2(smt2.str());
   std::vector<Term> smt2_args(args.begin(), args.end());
   smt2_args.push_back(body);
-  return std::shared_ptr<Smt2Term>(
-      new Smt2Term(Op::FUN, {}, smt2_args, {}, name));
+  return Smt2Term::create(Op::FUN, {}, smt2_args, {}, name);
 }
 
 Term
@@ -1130,8 +1296,7 @@ Smt2Solver::mk_value(Sort sort, bool value)
 {
   assert(sort->is_bool());
   std::string val = value ? "true" : "false";
-  return std::shared_ptr<Smt2Term>(
-      new Smt2Term(Op::UNDEFINED, {}, {}, {}, val));
+  return Smt2Term::create(Op::UNDEFINED, {}, {}, {}, val);
 }
 
 const std::string add_dot(const std::string& s)
@@ -1194,8 +1359,7 @@ Smt2Solver::mk_value(Sort sort, const std::string& value)
 
     default: assert(false);
   }
-  return std::shared_ptr<Smt2Term>(
-      new Smt2Term(Op::UNDEFINED, {}, {}, {}, val.str()));
+  return Smt2Term::create(Op::UNDEFINED, {}, {}, {}, val.str());
 }
 
 Term
@@ -1204,8 +1368,7 @@ Smt2Solver::mk_value(Sort sort, const std::string& num, const std::string& den)
   assert(sort->is_real());
   std::stringstream val;
   val << "(/ " << num << " " << den << ")";
-  return std::shared_ptr<Smt2Term>(
-      new Smt2Term(Op::UNDEFINED, {}, {}, {}, val.str()));
+  return Smt2Term::create(Op::UNDEFINED, {}, {}, {}, val.str());
 }
 
 Term
@@ -1239,8 +1402,7 @@ Smt2Solver::mk_value(Sort sort, const std::string& value, Base base)
       val << "#b" << value;
       break;
   }
-  return std::shared_ptr<Smt2Term>(
-      new Smt2Term(Op::UNDEFINED, {}, {}, {}, val.str()));
+  return Smt2Term::create(Op::UNDEFINED, {}, {}, {}, val.str());
 }
 
 Term
@@ -1370,8 +1532,7 @@ Smt2Solver::mk_special_value(Sort sort, const AbsTerm::SpecialValueKind& value)
 
     default: assert(false);
   }
-  return std::shared_ptr<Smt2Term>(
-      new Smt2Term(Op::UNDEFINED, {}, {}, {}, val.str()));
+  return Smt2Term::create(Op::UNDEFINED, {}, {}, {}, val.str());
 }
 
 Sort
@@ -1380,7 +1541,7 @@ Smt2Solver::mk_sort(const std::string& name)
   std::stringstream smt2;
   smt2 << "(declare-sort " << name << " 0)";
   dump_smt2(smt2.str());
-  return std::make_shared<Smt2Sort>(name);
+  return make_arena_shared<Smt2Sort>(name);
 }
 
 Sort
@@ -1397,7 +1558,7 @@ Smt2Solver::mk_sort(SortKind kind)
     case SORT_REGLAN: sort = get_reglan_sort_string(); break;
     default: assert(false);
   }
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(sort));
+  return make_arena_shared<Smt2Sort>(sort);
 }
 
 Sort
@@ -1409,7 +1570,7 @@ Smt2Solver::mk_sort(SortKind kind, const std::string& size)
     case SORT_FF: sort = get_ff_sort_string(size); break;
     default: assert(false);
   }
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(sort, size));
+  return make_arena_shared<Smt2Sort>(sort, size);
 }
 
 Sort
@@ -1421,7 +1582,7 @@ Smt2Solver::mk_sort(SortKind kind, uint32_t size)
     case SORT_BV: sort = get_bv_sort_string(size); break;
     default: assert(false);
   }
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(sort, size));
+  return make_arena_shared<Smt2Sort>(sort, size);
 }
 
 Sort
@@ -1433,7 +1594,7 @@ Smt2Solver::mk_sort(SortKind kind, uint32_t esize, uint32_t ssize)
     case SORT_FP: sort = get_fp_sort_string(esize, ssize); break;
     default: assert(false);
   }
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(sort, esize, ssize));
+  return make_arena_shared<Smt2Sort>(sort, esize, ssize);
 }
 
 Sort
@@ -1449,7 +1610,7 @@ Smt2Solver::mk_sort(SortKind kind, const std::vector<Sort>& sorts)
     case SORT_FUN: sort = get_fun_sort_string(sorts); break;
     default: assert(false);
   }
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(sort));
+  return make_arena_shared<Smt2Sort>(sort);
 }
 
 std::vector<Sort>
@@ -1584,7 +1745,7 @@ Smt2Solver::mk_sort(
     {
       smt2 << " )";
     }
-    res.push_back(std::shared_ptr<Smt2Sort>(new Smt2Sort(name)));
+    res.push_back(make_arena_shared<Smt2Sort>(name));
   }
 
   if (n_dt_sorts > 1)
@@ -1608,7 +1769,7 @@ Smt2Solver::instantiate_sort(Sort param_sort, const std::vector<Sort>& sorts)
     sort << " " << smt2_sort->get_repr();
   }
   sort << ")";
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(sort.str()));
+  return make_arena_shared<Smt2Sort>(sort.str());
 }
 
 Term
@@ -1616,7 +1777,7 @@ Smt2Solver::mk_term(const Op::Kind& kind,
                     const std::vector<Term>& args,
                     const std::vector<uint32_t>& idxs)
 {
-  Smt2Term* res;
+  std::shared_ptr<Smt2Term> res;
   if (kind == Op::BAG_COUNT || kind == Op::BAG_MAP)
   {
     /* given as { bag, element } resp. { bag, function } but we print it in
@@ -1624,7 +1785,7 @@ Smt2Solver::mk_term(const Op::Kind& kind,
     auto aargs = args;
     assert(aargs.size() == 2);
     std::swap(aargs[0], aargs[1]);
-    res = new Smt2Term(kind, {}, aargs, idxs, "");
+    res = Smt2Term::create(kind, {}, aargs, idxs, "");
   }
   else if (kind == Op::SET_COMPREHENSION)
   {
@@ -1633,7 +1794,7 @@ Smt2Solver::mk_term(const Op::Kind& kind,
     std::vector<Term> aargs{args.begin() + 2, args.end()};
     aargs.push_back(args[0]);
     aargs.push_back(args[1]);
-    res = new Smt2Term(kind, {}, aargs, idxs, "");
+    res = Smt2Term::create(kind, {}, aargs, idxs, "");
   }
   else if (kind == Op::SET_INSERT || kind == Op::SET_MEMBER)
   {
@@ -1641,13 +1802,13 @@ Smt2Solver::mk_term(const Op::Kind& kind,
      * { elem_1, ..., elem_n, set }  */
     std::vector<Term> aargs{args.begin() + 1, args.end()};
     aargs.push_back(args[0]);
-    res = new Smt2Term(kind, {}, aargs, idxs, "");
+    res = Smt2Term::create(kind, {}, aargs, idxs, "");
   }
   else
   {
-    res = new Smt2Term(kind, {}, args, idxs, "");
+    res = Smt2Term::create(kind, {}, args, idxs, "");
   }
-  return std::shared_ptr<Smt2Term>(res);
+  return res;
 }
 
 Term
@@ -1655,7 +1816,7 @@ Smt2Solver::mk_term(const Op::Kind& kind,
                     const std::vector<std::string>& str_args,
                     const std::vector<Term>& args)
 {
-  return std::shared_ptr<Smt2Term>(new Smt2Term(kind, str_args, args, {}, ""));
+  return Smt2Term::create(kind, str_args, args, {}, "");
 }
 
 Term
@@ -1664,9 +1825,10 @@ Smt2Solver::mk_term(const Op::Kind& kind,
                     const std::vector<std::string>& str_args,
                     const std::vector<Term>& args)
 {
-  Smt2Term* res = new Smt2Term(kind, str_args, args, {}, "");
+  std::shared_ptr<Smt2Term> res =
+      Smt2Term::create(kind, str_args, args, {}, "");
   if (kind == Op::DT_APPLY_CONS) res->set_sort(sort);
-  return std::shared_ptr<Smt2Term>(res);
+  return res;
 }
 
 Sort
@@ -1691,7 +1853,7 @@ Smt2Solver::get_sort(Term term, SortKind sort_kind)
 
 #ifdef MURXLA_USE_BITWUZLA
   /* bitwuzla solver-specific operators */
-  if (kind.rfind("bitwuzla-", 0) == 0)
+  if (kind.str().rfind("bitwuzla-", 0) == 0)
   {
     if (kind == bitwuzla::BitwuzlaTerm::OP_BV_DEC
         || kind == bitwuzla::BitwuzlaTerm::OP_BV_INC
@@ -1723,12 +1885,12 @@ Smt2Solver::get_sort(Term term, SortKind sort_kind)
     }
     MURXLA_EXIT_ERROR_CONFIG(sort.empty())
         << "operator " << kind << " not configured for SMT2 translation";
-    return std::shared_ptr<Smt2Sort>(new Smt2Sort(sort, bv_size, sig_size));
+    return make_arena_shared<Smt2Sort>(sort, bv_size, sig_size);
   }
 #endif
 #ifdef MURXLA_USE_CVC5
   /* cvc5 solver-specific operators */
-  if (kind.rfind("cvc5-", 0) == 0)
+  if (kind.str().rfind("cvc5-", 0) == 0)
   {
     if (kind == cvc5::Cvc5Term::OP_BV_REDAND
         || kind == cvc5::Cvc5Term::OP_BV_REDOR)
@@ -1749,7 +1911,7 @@ Smt2Solver::get_sort(Term term, SortKind sort_kind)
     }
     MURXLA_EXIT_ERROR_CONFIG(sort.empty())
         << "operator " << kind << " not configured for SMT2 translation";
-    return std::shared_ptr<Smt2Sort>(new Smt2Sort(sort, bv_size, sig_size));
+    return make_arena_shared<Smt2Sort>(sort, bv_size, sig_size);
   }
 #endif
 
@@ -1899,7 +2061,7 @@ Smt2Solver::get_sort(Term term, SortKind sort_kind)
         bv_size = idxs[0];
         sort    = get_bv_sort_string(bv_size);
       }
-      else if (kind.rfind("OP_BV_", 0) == 0)
+      else if (kind.str().rfind("OP_BV_", 0) == 0)
       {
         // return sort of first operand for non-solver-specific bv operators
         return args[0]->get_sort();
@@ -2017,7 +2179,7 @@ Smt2Solver::get_sort(Term term, SortKind sort_kind)
 
   MURXLA_EXIT_ERROR_CONFIG(sort.empty())
       << "operator " << kind << " not configured for SMT2 translation";
-  return std::shared_ptr<Smt2Sort>(new Smt2Sort(sort, bv_size, sig_size));
+  return make_arena_shared<Smt2Sort>(sort, bv_size, sig_size);
 }
 
 void
@@ -10,6 +10,9 @@
 #ifndef __MURXLA__SMT2_SOLVER_H
 #define __MURXLA__SMT2_SOLVER_H
 
+#include <string_view>
+#include <vector>
+
 #include "fsm.hpp"
 #ifdef MURXLA_USE_CVC5
 #include "solver/cvc5/cvc5_solver.hpp"
@@ -25,6 +28,16 @@
 namespace murxla {
 namespace smt2 {
 
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Intern given string, i.e., get the unique instance of all strings equal to
+ * it. Interned strings can be compared via their address and are never freed.
+ * Used for the representations of sorts and leaf terms, which are created
+ * over and over again for the same sort or symbol.
+ */
+const std::string* intern(const std::string& s);
+
 /* -------------------------------------------------------------------------- */
 /* Smt2Sort                                                                   */
 /* -------------------------------------------------------------------------- */
@@ -35,12 +48,12 @@ class Smt2Sort : public AbsSort
   /** Get a fresh sort symbol. Only used for function sorts. */
   static std::string get_next_symbol();
 
-  Smt2Sort(std::string repr, uint32_t bv_size = 0, uint32_t sig_size = 0)
-      : d_repr(repr), d_bv_size(bv_size), d_sig_size(sig_size)
+  Smt2Sort(const std::string& repr, uint32_t bv_size = 0, uint32_t sig_size = 0)
+      : d_repr(intern(repr)), d_bv_size(bv_size), d_sig_size(sig_size)
   {
   }
-  Smt2Sort(std::string repr, const std::string& ff_size)
-      : d_repr(repr), d_ff_size(ff_size)
+  Smt2Sort(const std::string& repr, const std::string& ff_size)
+      : d_repr(intern(repr)), d_ff_size(ff_size)
   {
   }
   ~Smt2Sort(){};
@@ -81,14 +94,20 @@ class Smt2Sort : public AbsSort
   const std::string& get_repr() const;
   void set_symbol(const std::string& symbol);
 
+  /**
+   * Reset the counter of freshly introduced sort symbols. Called when a new
+   * solver is created, which may happen more than once per process.
+   */
+  static void reset_symbol_cnt() { s_symbol_cnt = 0; }
+
  private:
   /**
    * The counter of sort symbols that have been freshly introduced. Used to
    * generate a unique sort string for function sorts.
    */
   inline static uint32_t s_symbol_cnt = 0;
-  /** The representation of this sort. */
-  std::string d_repr;
+  /** The representation of this sort, interned. */
+  const std::string* d_repr;
   /**
    * The bit-vector size of this sort.
    * Doubles as exponent size for FP sorts.
@@ -109,16 +128,23 @@ class Smt2Sort : public AbsSort
 class Smt2Term : public AbsTerm
 {
  public:
+  /** Create a new term, allocated in the Arena. */
+  static std::shared_ptr<Smt2Term> create(Op::Kind kind,
+                                          std::vector<std::string> str_args,
+                                          std::vector<Term> args,
+                                          std::vector<uint32_t> indices,
+                                          const std::string& repr);
+
   Smt2Term(Op::Kind kind,
            std::vector<std::string> str_args,
            std::vector<Term> args,
            std::vector<uint32_t> indices,
-           std::string repr)
+           const std::string& repr)
       : d_kind(kind),
-        d_str_args(str_args),
-        d_args(args),
-        d_indices(indices),
-        d_repr(repr)
+        d_str_args(std::move(str_args)),
+        d_args(std::move(args)),
+        d_indices(std::move(indices)),
+        d_repr(repr.empty() ? nullptr : intern(repr))
   {
   }
   ~Smt2Term(){};
@@ -126,14 +152,34 @@ class Smt2Term : public AbsTerm
   bool equals(const Term& other) const override;
   std::string to_string() const override;
 
-  const std::string& get_kind() const override;
+  const Op::Kind& get_kind() const override;
   std::vector<Term> get_children() const override;
   const std::vector<Term>& get_args() const;
   const std::vector<std::string>& get_str_args() const;
   const std::vector<uint32_t>& get_indices_uint32() const;
+  /**
+   * Get the SMT-LIB representation of this term. Subterms that occur more
+   * than once are let-bound and only printed once.
+   */
   const std::string get_repr() const;
 
  private:
+  /** Map term to the name of the let binding of the term. */
+  using LetMap = std::unordered_map<const Smt2Term*, std::string>;
+
+  /**
+   * Append the representation of given term to 'out', let-bound terms are
+   * referred to by their names.
+   */
+  static void print(const Smt2Term* term, const LetMap& lets, std::string& out);
+  /**
+   * Append the representation of given term to 'out', without referring to
+   * the term itself by its let binding.
+   */
+  static void print_term(const Smt2Term* term,
+                         const LetMap& lets,
+                         std::string& out);
+
   /** The operator kind of this term. */
   Op::Kind d_kind;
   /** The string arguments of this term. Only needed for DT operator kinds. */
@@ -142,10 +188,15 @@ class Smt2Term : public AbsTerm
   std::vector<Term> d_args;
   /** The indices of this term. */
   std::vector<uint32_t> d_indices;
-  /** The smt2 representation of this term. */
-  std::string d_repr;
+  /**
+   * The smt2 representation of this term, interned. Only for leaf terms and
+   * functions, nullptr otherwise.
+   */
+  const std::string* d_repr;
 
-  std::unordered_map<std::string, std::string> d_op_kind_to_str = {
+  /** Map operator kind to its SMT-LIB operator (if different). */
+  inline static const std::unordered_map<std::string, std::string>
+      s_op_kind_to_str = {
       {Op::DISTINCT, "distinct"},
       {Op::EQUAL, "="},
       {Op::ITE, "ite"},
@@ -426,15 +477,28 @@ class Smt2Term : public AbsTerm
 class Smt2Solver : public Solver
 {
  public:
+  /**
+   * Constructor.
+   * sng          : The associated solver seed generator.
+   * out          : The output stream for the SMT-LIB output.
+   * solver_binary: The call of the online solver, empty for no online solver.
+   * timeout      : The time limit for a response of the online solver in
+   *                seconds, 0 for no limit.
+   * pipelined    : True to not wait for the response of commands that only
+   *                respond with 'success' (see d_pipelined).
+   */
   Smt2Solver(SolverSeedGenerator& sng,
              std::ostream& out,
-             const std::string& solver_binary);
+             const std::string& solver_binary,
+             double timeout = 0,
+             bool pipelined = false);
   ~Smt2Solver() override;
 
   void new_solver() override;
   void delete_solver() override;
   bool is_initialized() const override;
   const std::string get_name() const override;
+  bool is_reentrant() const override;
   const std::string get_profile() const override;
 
   Term mk_var(Sort sort, const std::string& name) override;
@@ -523,14 +587,72 @@ class Smt2Solver : public Solver
     SMT2_SEXPR,
   };
 
+  /**
+   * Send command to the online solver and check its response. In pipelined
+   * mode, commands that expect 'success' are sent without waiting for the
+   * response, which is checked when synchronizing with the online solver.
+   */
   void push_to_external(std::string s, ResponseKind expected);
-  std::string get_from_external() const;
+  /**
+   * Write command to the online solver. Waits at most d_timeout seconds (if
+   * set) for the online solver to accept the command.
+   */
+  void write_to_external(std::string s);
+  /**
+   * Wait until the given file descriptor to or from the online solver is
+   * ready for the given poll events. If it is not ready before the given
+   * deadline (0 for no limit), the online solver is considered hung and the
+   * test run exits with a timeout.
+   */
+  void wait_for_external(int32_t fd, int16_t events, double deadline);
+  /**
+   * Read and check the responses of the pending commands up to the command
+   * with given sequence number, which all expect 'success'.
+   */
+  void sync_with_external(uint64_t seq);
+  /**
+   * Check the response to the next command that has not been responded to.
+   * Errors are attributed to the command via its sequence number in
+   * pipelined mode.
+   */
+  void check_response(std::string_view res, ResponseKind expected);
+  /**
+   * Read the next response of the online solver, i.e., one line, or an
+   * s-expression if the response starts with '('.
+   * The returned view into the response buffer is valid until the next call.
+   */
+  std::string_view get_from_external();
+  /**
+   * Read available output of the online solver into the response buffer.
+   * Waits at most until the given deadline (0 for no limit) for output.
+   * Returns false if the end of file was reached.
+   */
+  bool read_from_external(double deadline);
   void dump_smt2(std::string s,
                  ResponseKind expected = ResponseKind::SMT2_SUCCESS);
   std::ostream& d_out = std::cout;
   bool d_online       = false;
-  FILE* d_file_to     = nullptr;
-  FILE* d_file_from   = nullptr;
+  int32_t d_fd_to     = -1;
+  int32_t d_fd_from   = -1;
+  /** The time limit for a response of the online solver, 0 for no limit. */
+  double d_timeout = 0;
+  /**
+   * True if commands that expect 'success' are streamed to the online solver
+   * and their responses are only checked before the next query (pipelined
+   * mode). Responses arrive in the order of the commands, which allows to
+   * attribute errors to commands via their sequence numbers.
+   */
+  bool d_pipelined = false;
+  /** The number of commands sent to the online solver. */
+  uint64_t d_num_commands = 0;
+  /** The number of responses read from the online solver. */
+  uint64_t d_num_responses = 0;
+  /** The buffer of the output read from the online solver. */
+  std::vector<char> d_response_buf;
+  /** The position of the first character not consumed by a response. */
+  size_t d_response_begin = 0;
+  /** The end of the output read into d_response_buf. */
+  size_t d_response_end = 0;
 
   bool d_initialized               = false;
   bool d_incremental               = false;
@@ -545,6 +667,14 @@ class Smt2Solver : public Solver
 
   static constexpr int32_t SMT2_READ_END  = 0;
   static constexpr int32_t SMT2_WRITE_END = 1;
+  /** The initial size of the response buffer. */
+  static constexpr size_t SMT2_READ_BUFFER_SIZE = 1 << 16;
+  /**
+   * The maximum number of pending commands in pipelined mode. The online
+   * solver blocks when the pipe of its responses is full, hence they must be
+   * read regularly.
+   */
+  static constexpr uint64_t SMT2_MAX_PENDING = 1024;
 
   pid_t d_online_pid = 0;
   std::string d_solver_call;
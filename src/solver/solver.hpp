@@ -1243,6 +1243,13 @@ class Solver
    * @return  The solver name.
    */
   virtual const std::string get_name() const = 0;
+  /**
+   * Determine if the wrapped solver is reentrant, i.e., if instances of the
+   * solver do not share process-global state with instances of other solvers
+   * and can thus be used on another thread (see --check-concurrent).
+   * @return True if the wrapped solver is reentrant.
+   */
+  virtual bool is_reentrant() const { return false; }
 
   /**
    * Create variable.
@@ -293,6 +293,26 @@ SolverProfile::get_unsupported_sort_param_sort_kinds() const
   return get_sort_kinds({KEY_SORTS, "sort-param", "exclude"});
 }
 
+void
+SolverProfile::precompute() const
+{
+  get_unsupported_sort_kinds();
+  get_unsupported_var_sort_kinds();
+  get_unsupported_array_index_sort_kinds();
+  get_unsupported_array_element_sort_kinds();
+  get_unsupported_bag_element_sort_kinds();
+  get_unsupported_dt_match_sort_kinds();
+  get_unsupported_dt_sel_codomain_sort_kinds();
+  get_unsupported_fun_codomain_sort_kinds();
+  get_unsupported_fun_domain_sort_kinds();
+  get_unsupported_fun_sort_codomain_sort_kinds();
+  get_unsupported_fun_sort_domain_sort_kinds();
+  get_unsupported_get_value_sort_kinds();
+  get_unsupported_seq_element_sort_kinds();
+  get_unsupported_set_element_sort_kinds();
+  get_unsupported_sort_param_sort_kinds();
+}
+
 std::vector<std::string>
 SolverProfile::get_excluded_errors() const
 {
@@ -405,11 +425,18 @@ SortKindSet
 SolverProfile::get_sort_kinds(const std::vector<std::string>& keys,
                               bool required) const
 {
+  std::string key = join(keys, "::");
+  auto it         = d_sort_kinds_cache.find(key);
+  if (it != d_sort_kinds_cache.end())
+  {
+    return it->second;
+  }
   SortKindSet kinds;
   for (const auto& k : get_array(keys, required))
   {
     kinds.insert(to_sort_kind(k));
   }
+  d_sort_kinds_cache.emplace(key, kinds);
   return kinds;
 }
 
@@ -200,6 +200,15 @@ class SolverProfile
    */
   SortKindSet get_unsupported_sort_param_sort_kinds() const;
 
+  /**
+   * Pre-compute and cache the results of all sort kind queries.
+   *
+   * Sort kind restrictions are queried whenever an FSM is configured. Calling
+   * this once before forking test runs allows the forked processes to inherit
+   * the cached results instead of re-querying the JSON profile in each run.
+   */
+  void precompute() const;
+
   /** Get list of errors to be filtered out (ignored).*/
   std::vector<std::string> get_excluded_errors() const;
 
@@ -239,6 +248,9 @@ class SolverProfile
 
   std::unordered_map<std::string, Theory> d_str_to_theory;
   std::unordered_map<std::string, SortKind> d_str_to_sort_kind;
+
+  /** Cache for get_sort_kinds(), maps joined keys to the queried sort kinds. */
+  mutable std::unordered_map<std::string, SortKindSet> d_sort_kinds_cache;
 };
 
 }  // namespace murxla
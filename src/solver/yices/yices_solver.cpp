@@ -303,6 +303,14 @@ YicesSolver::get_name() const
   return "Yices";
 }
 
+bool
+YicesSolver::is_reentrant() const
+{
+  /* Yices is initialized and reset globally (yices_init(), yices_exit(),
+   * yices_reset()), which affects all Yices contexts of the process. */
+  return false;
+}
+
 const std::string
 YicesSolver::get_profile() const
 {
@@ -144,6 +144,7 @@ class YicesSolver : public Solver
   void delete_solver() override;
   bool is_initialized() const override;
   const std::string get_name() const override;
+  bool is_reentrant() const override;
   const std::string get_profile() const override;
 
   void disable_unsupported_actions(FSM* fsm) const override;
@@ -10,7 +10,9 @@
 #include "solver_manager.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <functional>
 #include <iterator>
 #include <sstream>
 
@@ -93,9 +95,208 @@ SolverManager::clear()
 void
 SolverManager::reset_op_cache()
 {
-  const auto& kinds = d_opmgr->get_op_kinds();
-  d_available_op_kinds.insert(kinds.begin(), kinds.end());
-  d_enabled_op_kinds.clear();
+  d_op_index.clear();
+  d_op_index_by_sort_kind.clear();
+  d_ops_by_sort_kind.clear();
+  d_ops_by_sort_kind.resize(SORT_ANY + 1);
+  d_enabled_ops.clear();
+  d_enabled_ops.resize(SORT_ANY + 1);
+  for (auto& ops : d_enabled_ops)
+  {
+    ops.resize(THEORY_ALL + 1);
+  }
+  d_quant_ops.clear();
+
+  /* Index operators in the order of their kinds, which makes the order of
+   * enabled operators, and thus picking operators, independent of the layout
+   * of the (unordered) operator kind map. */
+  std::vector<const Op*> ops;
+  for (const auto& p : d_opmgr->get_op_kinds())
+  {
+    ops.push_back(&p.second);
+  }
+  std::sort(ops.begin(), ops.end(), [](const Op* a, const Op* b) {
+    return a->d_kind < b->d_kind;
+  });
+
+  for (const Op* pop : ops)
+  {
+    const Op& op         = *pop;
+    const Op::Kind& kind = op.d_kind;
+
+    size_t idx = d_op_index.size();
+    IndexedOp& iop = d_op_index.emplace_back();
+    iop.d_op       = &op;
+    iop.d_quant    = kind == Op::FORALL || kind == Op::EXISTS
+                  || kind == Op::SET_COMPREHENSION;
+    iop.d_sort_kinds.push_back(SORT_ANY);
+    for (SortKind sort_kind : op.d_sort_kinds)
+    {
+      if (sort_kind != SORT_ANY) iop.d_sort_kinds.push_back(sort_kind);
+    }
+    iop.d_pos.fill(-1);
+    for (SortKind sort_kind : iop.d_sort_kinds)
+    {
+      d_ops_by_sort_kind[sort_kind].push_back(idx);
+    }
+    iop.d_weight = compute_op_weight(idx);
+
+    /* Collect the distinct sets of argument sort kinds. Operators with
+     * arbitrary arity require terms for their first argument only. */
+    std::vector<SortKindSet> args;
+    int32_t n = op.d_arity < 0 ? 1 : op.d_arity;
+    for (int32_t i = 0; i < n; ++i)
+    {
+      SortKindSet arg = op.get_arg_sort_kind(i);
+      if (std::find(args.begin(), args.end(), arg) == args.end())
+      {
+        args.push_back(arg);
+      }
+    }
+
+    iop.d_num_args_with_terms.resize(args.size(), 0);
+    iop.d_num_args_missing = static_cast<uint32_t>(args.size());
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+      for (SortKind sort_kind : args[i])
+      {
+        d_op_index_by_sort_kind[sort_kind].emplace_back(idx, i);
+        if (d_term_db.has_term(sort_kind)
+            && iop.d_num_args_with_terms[i]++ == 0)
+        {
+          iop.d_num_args_missing -= 1;
+        }
+      }
+    }
+
+    if (iop.d_quant)
+    {
+      d_quant_ops.push_back(idx);
+    }
+    else if (iop.d_num_args_missing == 0)
+    {
+      enable_op(idx);
+    }
+  }
+}
+
+void
+SolverManager::enable_op(size_t idx)
+{
+  IndexedOp& iop = d_op_index[idx];
+  assert(iop.d_pos[SORT_ANY] < 0);
+  for (SortKind sort_kind : iop.d_sort_kinds)
+  {
+    EnabledOps& ops      = d_enabled_ops[sort_kind][iop.d_op->d_theory];
+    iop.d_pos[sort_kind] = static_cast<int64_t>(ops.d_ops.size());
+    ops.d_ops.push_back(idx);
+    ops.d_weights.push_back(iop.d_weight);
+  }
+}
+
+void
+SolverManager::disable_op(size_t idx)
+{
+  IndexedOp& iop = d_op_index[idx];
+  assert(iop.d_pos[SORT_ANY] >= 0);
+  for (SortKind sort_kind : iop.d_sort_kinds)
+  {
+    EnabledOps& ops = d_enabled_ops[sort_kind][iop.d_op->d_theory];
+    size_t pos      = static_cast<size_t>(iop.d_pos[sort_kind]);
+    size_t last     = ops.d_ops.back();
+    ops.d_ops.pop_back();
+    ops.d_weights.pop_back();
+    if (last != idx)
+    {
+      IndexedOp& iop_last = d_op_index[last];
+      ops.d_ops[pos]      = last;
+      if (iop_last.d_weight > iop.d_weight)
+      {
+        ops.d_weights.add(pos, iop_last.d_weight - iop.d_weight);
+      }
+      else
+      {
+        ops.d_weights.sub(pos, iop.d_weight - iop_last.d_weight);
+      }
+      iop_last.d_pos[sort_kind] = iop.d_pos[sort_kind];
+    }
+    iop.d_pos[sort_kind] = -1;
+  }
+}
+
+uint64_t
+SolverManager::compute_op_weight(size_t idx) const
+{
+  const IndexedOp& iop = d_op_index[idx];
+  /* The weight factor is given in percent, scale by another 100 to retain
+   * the precision of the coverage feedback factor. */
+  double res = 100;
+  auto it    = d_op_weight_factors.find(iop.d_op->d_kind.str());
+  if (it != d_op_weight_factors.end())
+  {
+    res = it->second;
+  }
+  if (d_coverage_feedback)
+  {
+    res *= d_coverage_feedback->get_op_factor(iop.d_op->d_id);
+  }
+  return static_cast<uint64_t>(std::llround(res * 100));
+}
+
+void
+SolverManager::update_op_weights()
+{
+  for (size_t idx = 0, n = d_op_index.size(); idx < n; ++idx)
+  {
+    d_op_index[idx].d_weight = compute_op_weight(idx);
+  }
+  for (auto& ops_by_theory : d_enabled_ops)
+  {
+    for (EnabledOps& ops : ops_by_theory)
+    {
+      ops.d_weights.clear();
+      for (size_t idx : ops.d_ops)
+      {
+        ops.d_weights.push_back(d_op_index[idx].d_weight);
+      }
+    }
+  }
+}
+
+void
+SolverManager::add_term_sort_kind(SortKind sort_kind)
+{
+  auto it = d_op_index_by_sort_kind.find(sort_kind);
+  if (it == d_op_index_by_sort_kind.end()) return;
+  for (const auto& [idx, arg] : it->second)
+  {
+    IndexedOp& iop = d_op_index[idx];
+    if (iop.d_num_args_with_terms[arg]++ > 0) continue;
+    assert(iop.d_num_args_missing > 0);
+    iop.d_num_args_missing -= 1;
+    if (iop.d_num_args_missing == 0 && !iop.d_quant)
+    {
+      enable_op(idx);
+    }
+  }
+}
+
+void
+SolverManager::remove_term_sort_kind(SortKind sort_kind)
+{
+  auto it = d_op_index_by_sort_kind.find(sort_kind);
+  if (it == d_op_index_by_sort_kind.end()) return;
+  for (const auto& [idx, arg] : it->second)
+  {
+    IndexedOp& iop = d_op_index[idx];
+    assert(iop.d_num_args_with_terms[arg] > 0);
+    if (--iop.d_num_args_with_terms[arg] > 0) continue;
+    iop.d_num_args_missing += 1;
+    if (iop.d_pos[SORT_ANY] >= 0)
+    {
+      disable_op(idx);
+    }
+  }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -391,9 +592,8 @@ SolverManager::pick_sort_kind(bool with_terms)
   {
     return d_term_db.pick_sort_kind();
   }
-  return d_rng
-      .pick_key_from_map<std::unordered_map<SortKind, SortSet>, SortKind>(
-          d_sort_kind_to_sorts);
+  return d_rng.pick_key_from_map<decltype(d_sort_kind_to_sorts), SortKind>(
+      d_sort_kind_to_sorts);
 }
 
 SortKind
@@ -456,90 +656,62 @@ SolverManager::pick_op_kind(bool with_terms, SortKind sort_kind)
 {
   if (with_terms)
   {
-    std::unordered_map<Theory, OpKindSet> kinds(d_enabled_op_kinds);
-    std::vector<Op::Kind> remove;
-    for (const auto& [kind, op] : d_available_op_kinds)
+    /* Quantifiers can only be created if we already have variables and
+     * Boolean terms in the current scope. */
+    std::vector<size_t> quant_ops;
+    if (!d_quant_ops.empty() && d_term_db.has_var()
+        && d_term_db.has_quant_body()
+        && (d_term_db.get_num_terms(d_term_db.max_level())
+            >= MURXLA_MIN_N_QUANT_TERMS))
     {
-      /* Quantifiers can only be created if we already have variables and
-       * Boolean terms in the current scope. */
-      if ((op.d_kind == Op::FORALL || op.d_kind == Op::EXISTS
-           || op.d_kind == Op::SET_COMPREHENSION)
-          && (!d_term_db.has_var() || !d_term_db.has_quant_body()
-              || (d_term_db.get_num_terms(d_term_db.max_level())
-                  < MURXLA_MIN_N_QUANT_TERMS)))
-      {
-        continue;
-      }
-
-      bool has_terms = true;
-
-      /* Check if we already have terms that can be used with this operator. */
-      if (op.d_arity < 0)
-      {
-        has_terms = has_term(op.get_arg_sort_kind(0));
-      }
-      else
+      for (size_t idx : d_quant_ops)
       {
-        for (int32_t i = 0; i < op.d_arity; ++i)
-        {
-          if (!has_term(op.get_arg_sort_kind(i)))
-          {
-            has_terms = false;
-            break;
-          }
-        }
-      }
-      if (has_terms)
-      {
-        /* In general if a term was added to the term db it will always be
-         * available. However, for quantifiers, terms get "consumed" and
-         * therefore we always have to check whether we can create a quantified
-         * term and therefore the FORALL and EXISTS kinds can't be cached. */
-        if (op.d_kind != Op::FORALL && op.d_kind != Op::EXISTS)
-        {
-          d_enabled_op_kinds[op.d_theory].insert(op.d_kind);
-          remove.push_back(op.d_kind);
-        }
-        kinds[op.d_theory].insert(op.d_kind);
+        if (d_op_index[idx].d_num_args_missing == 0) quant_ops.push_back(idx);
       }
     }
 
-    /* Remove the enabled kinds from d_available_op_kinds since these kinds now
-     * can be constructed with terms in the db. */
-    for (const auto& k : remove)
+    /* The enabled operators that create terms of given sort kind. */
+    const std::vector<EnabledOps>& enabled_ops = d_enabled_ops[sort_kind];
+    if (sort_kind != SORT_ANY)
     {
-      d_available_op_kinds.erase(k);
+      auto has_sort_kind = [this, sort_kind](size_t idx) {
+        const SortKindSet& sort_kinds = d_op_index[idx].d_op->d_sort_kinds;
+        return sort_kinds.find(sort_kind) != sort_kinds.end();
+      };
+      quant_ops.erase(std::remove_if(quant_ops.begin(),
+                                     quant_ops.end(),
+                                     std::not_fn(has_sort_kind)),
+                      quant_ops.end());
     }
 
-    /* Filter operator kinds based on sort kind. */
-    if (sort_kind != SORT_ANY)
-    {
-      const auto& enabled_ops = d_opmgr->get_op_kinds();
-      for (const auto& [kind, op] : enabled_ops)
+    /* The operators of a theory are the enabled operators of that theory,
+     * followed by the quantifier operators of that theory. */
+    auto get_num_ops = [this, &enabled_ops, &quant_ops](Theory theory) {
+      size_t res = enabled_ops[theory].d_ops.size();
+      for (size_t idx : quant_ops)
       {
-        if (op.d_sort_kinds.find(sort_kind) == op.d_sort_kinds.end())
-        {
-          const auto it = kinds.find(op.d_theory);
-          if (it != kinds.end())
-          {
-            it->second.erase(kind);
-            if (it->second.empty())
-            {
-              kinds.erase(op.d_theory);
-            }
-          }
-        }
+        if (d_op_index[idx].d_op->d_theory == theory) res += 1;
       }
+      return res;
+    };
+
+    std::vector<Theory> theories;
+    for (size_t i = 0, n = enabled_ops.size(); i < n; ++i)
+    {
+      Theory theory = static_cast<Theory>(i);
+      if (get_num_ops(theory) > 0) theories.push_back(theory);
     }
 
-    if (kinds.size() > 0)
+    if (theories.size() > 0)
     {
       /* First pick theory and then operator kind (avoids bias against theories
        * with many operators). However, we pick THEORY_BOOL and THEORY_ALL with
        * lower probability (10% each) to generate more theory terms. */
 
-      bool have_bool  = kinds.find(THEORY_BOOL) != kinds.end();
-      bool have_all   = kinds.find(THEORY_ALL) != kinds.end();
+      bool have_bool = std::find(theories.begin(), theories.end(), THEORY_BOOL)
+                       != theories.end();
+      bool have_all = std::find(theories.begin(), theories.end(), THEORY_ALL)
+                      != theories.end();
       size_t min_size = have_all ? 1 : 0;
       uint32_t prob   = have_all ? 900 : 1000;
       if (have_bool)
@@ -549,42 +721,78 @@ SolverManager::pick_op_kind(bool with_terms, SortKind sort_kind)
       }
 
       Theory theory = THEORY_ALL;
-      if (kinds.size() > min_size && d_rng.pick_with_prob(prob))
+      if (theories.size() > min_size && d_rng.pick_with_prob(prob))
       {
         do
         {
-          theory = d_rng.pick_key_from_map<decltype(kinds), Theory>(kinds);
+          theory = d_rng.pick_from_set<std::vector<Theory>, Theory>(theories);
         } while (theory == THEORY_ALL || theory == THEORY_BOOL);
       }
-      else if (have_bool && d_rng.flip_coin())
+      else if (have_bool && (!have_all || d_rng.flip_coin()))
       {
         theory = THEORY_BOOL;
       }
 
-      auto& op_kinds  = kinds[theory];
-      return d_rng.pick_from_set<decltype(op_kinds), Op::Kind>(op_kinds);
+      const EnabledOps& ops = enabled_ops[theory];
+      size_t n_ops          = ops.d_ops.size();
+      size_t pos            = n_ops;
+      if (d_coverage_feedback || !d_op_weight_factors.empty())
+      {
+        /* Pick by weight. The weights of the quantifier operators of the
+         * theory follow the weights of the enabled operators. */
+        uint64_t sum   = ops.d_weights.sum();
+        uint64_t total = sum;
+        for (size_t idx : quant_ops)
+        {
+          if (d_op_index[idx].d_op->d_theory != theory) continue;
+          total += d_op_index[idx].d_weight;
+        }
+        assert(total > 0);
+        uint64_t value = d_rng.pick<uint64_t>(0, total - 1);
+        if (value < sum)
+        {
+          pos = FenwickTree<uint64_t>::search(
+              n_ops, value, [&ops](size_t node) {
+                return ops.d_weights.node(node);
+              });
+        }
+        else
+        {
+          value -= sum;
+          for (size_t idx : quant_ops)
+          {
+            const IndexedOp& iop = d_op_index[idx];
+            if (iop.d_op->d_theory != theory) continue;
+            if (value < iop.d_weight) break;
+            value -= iop.d_weight;
+            pos += 1;
+          }
+        }
+      }
+      else
+      {
+        pos = d_rng.pick_index(get_num_ops(theory));
+      }
+      if (pos < n_ops)
+      {
+        return d_op_index[ops.d_ops[pos]].d_op->d_kind;
+      }
+      pos -= n_ops;
+      for (size_t idx : quant_ops)
+      {
+        if (d_op_index[idx].d_op->d_theory != theory) continue;
+        if (pos-- == 0) return d_op_index[idx].d_op->d_kind;
+      }
+      assert(false);
     }
 
     /* We cannot create any operation with the current set of terms. */
     return Op::UNDEFINED;
   }
 
-  if (sort_kind == SORT_ANY)
-  {
-    return d_rng.pick_key_from_map<OpKindMap, Op::Kind>(
-        d_opmgr->get_op_kinds());
-  }
-
-  std::vector<Op::Kind> kinds;
-  const auto& enabled_ops = d_opmgr->get_op_kinds();
-  for (const auto& op : enabled_ops)
-  {
-    if (op.second.d_sort_kinds.find(sort_kind) != op.second.d_sort_kinds.end())
-    {
-      kinds.push_back(op.first);
-    }
-  }
-  return d_rng.pick_from_set<decltype(kinds), Op::Kind>(kinds);
+  const std::vector<size_t>& ops = d_ops_by_sort_kind[sort_kind];
+  assert(!ops.empty());
+  return d_op_index[ops[d_rng.pick_index(ops.size())]].d_op->d_kind;
 }
 
 Op&
@@ -593,6 +801,20 @@ SolverManager::get_op(const Op::Kind& kind)
   return d_opmgr->get_op(kind);
 }
 
+void
+SolverManager::set_op_weight_factors(const adaptive::WeightMap& factors)
+{
+  d_op_weight_factors = factors;
+  update_op_weights();
+}
+
+void
+SolverManager::set_coverage_feedback(const coverage::Feedback* feedback)
+{
+  d_coverage_feedback = feedback;
+  update_op_weights();
+}
+
 /* -------------------------------------------------------------------------- */
 
 Theory
@@ -715,7 +937,6 @@ void
 SolverManager::remove_var(const Term& var)
 {
   d_term_db.remove_var(var);
-  reset_op_cache();
 }
 
 Term
@@ -1140,7 +1361,7 @@ Sort
 SolverManager::pick_sort_bv(uint32_t bw, bool with_terms)
 {
   assert(has_sort_bv(bw, with_terms));
-  const SortSet sorts = with_terms ? d_term_db.get_sorts() : d_sorts;
+  const SortSet& sorts = with_terms ? d_term_db.get_sorts() : d_sorts;
   for (const auto& sort : sorts)
   {
     if (sort->is_bv() && sort->get_bv_size() == bw)
@@ -1159,7 +1380,7 @@ SolverManager::pick_sort_bv_max(uint32_t bw_max, bool with_terms)
   assert(has_sort_bv_max(bw_max, with_terms));
   std::vector<Sort> bv_sorts;
 
-  const SortSet sorts = with_terms ? d_term_db.get_sorts() : d_sorts;
+  const SortSet& sorts = with_terms ? d_term_db.get_sorts() : d_sorts;
   for (const auto& sort : sorts)
   {
     if (sort->is_bv() && sort->get_bv_size() <= bw_max)
@@ -1330,7 +1551,7 @@ SolverManager::has_sort_bv(uint32_t bw, bool with_terms) const
 bool
 SolverManager::has_sort_bv_max(uint32_t bw_max, bool with_terms) const
 {
-  const SortSet sorts = with_terms ? d_term_db.get_sorts() : d_sorts;
+  const SortSet& sorts = with_terms ? d_term_db.get_sorts() : d_sorts;
   for (const auto& sort : sorts)
   {
     if (sort->is_bv() && sort->get_bv_size() <= bw_max)
@@ -1494,7 +1715,7 @@ SolverManager::pick_kind(TKindMap& map)
 {
   assert(!map.empty());
   typename TKindMap::iterator it = map.begin();
-  std::advance(it, d_rng.pick<uint32_t>() % map.size());
+  std::advance(it, d_rng.pick_index(map.size()));
   return it->second;
 }
 
@@ -1511,7 +1732,7 @@ SolverManager::pick_kind(TKindMap& map,
   assert(kinds1 || kinds2);
   size_t sz1 = kinds1 ? kinds1->size() : 0;
   size_t sz2 = kinds2 ? kinds2->size() : 0;
-  uint32_t n = d_rng.pick<uint32_t>() % (sz1 + sz2);
+  size_t n = d_rng.pick_index(sz1 + sz2);
   typename TKindVector::iterator it;
 
   assert(sz1 || sz2);
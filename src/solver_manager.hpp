@@ -10,12 +10,17 @@
 #ifndef __MURXLA__SOLVER_MANAGER_H
 #define __MURXLA__SOLVER_MANAGER_H
 
+#include <array>
 #include <cassert>
 #include <iostream>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "adaptive_weights.hpp"
+#include "coverage.hpp"
+#include "fenwick_tree.hpp"
+#include "indexed_set.hpp"
 #include "solver/solver.hpp"
 #include "solver/solver_profile.hpp"
 #include "solver_option.hpp"
@@ -38,7 +43,7 @@ class SolverManager
   friend class DD;
 
  public:
-  using SortSet = std::unordered_set<Sort>;
+  using SortSet = IndexedSet<Sort>;
 
   /* Statistics. */
   struct Stats
@@ -105,6 +110,14 @@ class SolverManager
    */
   std::ostream& get_trace();
 
+  /**
+   * Determine if the API trace is recorded. If not (trace mode NONE), the
+   * trace stream has no stream buffer and MURXLA_TRACE skips formatting the
+   * trace line entirely.
+   * @return True if the API trace is recorded.
+   */
+  bool is_tracing() const { return d_trace.rdbuf() != nullptr; }
+
   /**
    * Return true if given option has already been configured.
    * @param opt The option to query.
@@ -150,6 +163,19 @@ class SolverManager
                 bool parametric   = false,
                 bool well_founded = true);
 
+  /**
+   * Update the operator index used by pick_op_kind after the first term of
+   * given sort kind was added to the term database.
+   * @param sort_kind The sort kind that now has terms.
+   */
+  void add_term_sort_kind(SortKind sort_kind);
+  /**
+   * Update the operator index used by pick_op_kind after the last term of
+   * given sort kind was removed from the term database.
+   * @param sort_kind The sort kind that has no terms anymore.
+   */
+  void remove_term_sort_kind(SortKind sort_kind);
+
   /**
    * Add value to term database.
    * @param term The term to add to the database.
@@ -302,6 +328,25 @@ class SolverManager
    */
   Op& get_op(const Op::Kind& kind);
 
+  /**
+   * Set the factors to scale the weights of operators with in pick_op_kind.
+   * @param factors  The weight factors of operators in percent, by kind.
+   */
+  void set_op_weight_factors(const adaptive::WeightMap& factors);
+
+  /**
+   * Set the coverage feedback to weight operators with in pick_op_kind.
+   * @param feedback  The coverage feedback, nullptr to not weight operators
+   *                  by coverage.
+   */
+  void set_coverage_feedback(const coverage::Feedback* feedback);
+
+  /** @return  The coverage feedback, nullptr if not set. */
+  const coverage::Feedback* get_coverage_feedback() const
+  {
+    return d_coverage_feedback;
+  }
+
   /**
    * Pick a value of any sort.
    *
@@ -908,6 +953,20 @@ class SolverManager
    * Reset op caches used by pick_op_kind;
    */
   void reset_op_cache();
+  /** Add operator with given index to the set of enabled operators. */
+  void enable_op(size_t idx);
+  /** Remove operator with given index from the set of enabled operators. */
+  void disable_op(size_t idx);
+  /**
+   * Compute the weight of the operator with given index from its weight
+   * factor and the coverage feedback.
+   */
+  uint64_t compute_op_weight(size_t idx) const;
+  /**
+   * Recompute the weights of all operators in the op index. Must be called
+   * whenever the weight factors or the coverage feedback change.
+   */
+  void update_op_weights();
 
   /**
    * Pick any of the enabled theories.
@@ -1054,16 +1113,16 @@ class SolverManager
   SortSet d_sorts_dt_non_well_founded;
 
   /** Map sort kind -> sorts. */
-  std::unordered_map<SortKind, SortSet> d_sort_kind_to_sorts;
+  IndexedMap<SortKind, SortSet> d_sort_kind_to_sorts;
 
   /** The set of already assumed formulas. */
-  std::unordered_set<Term> d_assumptions;
+  IndexedSet<Term> d_assumptions;
 
   /** Term database */
   TermDb d_term_db;
 
   /** Set of currently created string values with length 1. */
-  std::unordered_set<Term> d_string_char_values;
+  IndexedSet<Term> d_string_char_values;
 
   /** Map untraced ids to corresponding Terms. */
   std::unordered_map<uint64_t, Term> d_untraced_terms;
@@ -1071,17 +1130,90 @@ class SolverManager
   /** Map untraced ids to corresponding Sorts. */
   std::unordered_map<uint64_t, Sort> d_untraced_sorts;
 
+  /** An operator in the operator index used by pick_op_kind. */
+  struct IndexedOp
+  {
+    /** The operator. */
+    const Op* d_op;
+    /**
+     * The number of sort kinds with terms for each distinct set of argument
+     * sort kinds of the operator.
+     */
+    std::vector<uint32_t> d_num_args_with_terms;
+    /** The number of argument sort kind sets without any terms. */
+    uint32_t d_num_args_missing = 0;
+    /** True if the operator is a quantifier, see d_quant_ops. */
+    bool d_quant = false;
+    /**
+     * The sort kinds of the lists in d_enabled_ops the operator is added to
+     * when it is enabled: SORT_ANY and the sort kinds of the operator.
+     */
+    std::vector<SortKind> d_sort_kinds;
+    /**
+     * The position in the list of each sort kind in d_enabled_ops, or -1 if
+     * not enabled.
+     */
+    std::array<int64_t, SORT_ANY + 1> d_pos;
+    /**
+     * The weight of the operator in pick_op_kind, 10000 if it is not scaled
+     * by a weight factor or coverage feedback.
+     */
+    uint64_t d_weight = 10000;
+  };
+
+  /** A list of enabled operators in d_enabled_ops. */
+  struct EnabledOps
+  {
+    /** The operators, indices into d_op_index. */
+    std::vector<size_t> d_ops;
+    /** The weights of the operators, for weighted picks in pick_op_kind. */
+    FenwickTree<uint64_t> d_weights;
+  };
+
+  /**
+   * The factors (in percent) to scale the weights of operators with in
+   * pick_op_kind, by operator kind.
+   */
+  adaptive::WeightMap d_op_weight_factors;
+  /**
+   * The coverage feedback to weight operators with in pick_op_kind, nullptr
+   * to not weight operators by coverage.
+   */
+  const coverage::Feedback* d_coverage_feedback = nullptr;
+
+  /**
+   * Operator index used by pick_op_kind. Contains all operators reported by
+   * opmgr and tracks if terms for all of their arguments exist.
+   */
+  std::vector<IndexedOp> d_op_index;
+
+  /**
+   * Maps sort kind to the operators in d_op_index (and the index of the
+   * argument sort kind set) that accept terms of that sort kind.
+   */
+  std::unordered_map<SortKind, std::vector<std::pair<size_t, size_t>>>
+      d_op_index_by_sort_kind;
+
+  /**
+   * The operators in d_op_index, indexed by the sort kind of the terms they
+   * create. The operators of sort kind SORT_ANY are all operators.
+   */
+  std::vector<std::vector<size_t>> d_ops_by_sort_kind;
+
   /**
-   * Cache used by pick_op_kind. Caches operator kinds that are currently
-   * safe to pick since the required terms to create an operator already exist.
+   * The operators in d_op_index that can be created with the currently
+   * existing terms, indexed by sort kind and theory. The operators of sort
+   * kind SORT_ANY are all enabled operators, the operators of any other sort
+   * kind are the enabled operators that create terms of that sort kind.
    */
-  std::unordered_map<Theory, OpKindSet> d_enabled_op_kinds;
+  std::vector<std::vector<EnabledOps>> d_enabled_ops;
 
   /**
-   * Cache used by pick_op_kind. Caches available operator kinds reported
-   * by opmgr, but cannot be constructed yet due to missing terms.
+   * The quantifier operators in d_op_index. Creating quantifiers consumes
+   * terms and requires a scope with variables, hence these operators are
+   * never added to d_enabled_ops but checked on every call to pick_op_kind.
    */
-  OpKindMap d_available_op_kinds;
+  std::vector<size_t> d_quant_ops;
 
   /** Is this solver manager already initialized? */
   bool d_initialized = false;
@@ -9,12 +9,204 @@
  */
 #include "statistics.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <vector>
+
 #include "op.hpp"
 #include "solver/solver.hpp"
 
 namespace murxla {
 namespace statistics {
 
+namespace {
+
+/**
+ * Get the index of the entry with given kind in table 'kinds'. If no such
+ * entry exists yet, 'kind' is added at the first free index. Returns the
+ * maximum number of entries 'size' if the table is full.
+ */
+uint32_t
+get_kind_index(char kinds[][MURXLA_MAX_KIND_LEN],
+               uint32_t size,
+               const char* kind)
+{
+  uint32_t i = 0;
+  for (; i < size && kinds[i][0]; ++i)
+  {
+    if (strncmp(kinds[i], kind, MURXLA_MAX_KIND_LEN) == 0) return i;
+  }
+  if (i < size)
+  {
+    strncpy(kinds[i], kind, MURXLA_MAX_KIND_LEN);
+  }
+  return i;
+}
+
+/** Add the counts of latency histogram 'src' to latency histogram 'dst'. */
+void
+add_latencies(uint64_t* dst, const uint64_t* src)
+{
+  for (uint32_t i = 0; i < MURXLA_N_LATENCY_BUCKETS; ++i)
+  {
+    dst[i] += src[i];
+  }
+}
+
+/** @return  The number of latencies recorded in given latency histogram. */
+uint64_t
+get_num_latencies(const uint64_t* latencies)
+{
+  uint64_t res = 0;
+  for (uint32_t i = 0; i < MURXLA_N_LATENCY_BUCKETS; ++i)
+  {
+    res += latencies[i];
+  }
+  return res;
+}
+
+/**
+ * Get the given percentile of the latencies recorded in given latency
+ * histogram, as the upper bound of the bucket it falls into.
+ * @param latencies  The latency histogram, must not be empty.
+ * @param p          The percentile in (0, 1].
+ * @return  The latency in nanoseconds.
+ */
+uint64_t
+get_latency_percentile(const uint64_t* latencies, double p)
+{
+  uint64_t n = get_num_latencies(latencies);
+  uint64_t rank =
+      static_cast<uint64_t>(std::ceil(p * static_cast<double>(n)));
+  uint64_t count = 0;
+  uint32_t i     = 0;
+  for (; i < MURXLA_N_LATENCY_BUCKETS - 1; ++i)
+  {
+    count += latencies[i];
+    if (count >= rank) break;
+  }
+  return uint64_t(1) << (i + 1);
+}
+
+/** The latency percentiles reported by Statistics::print(). */
+const std::vector<std::pair<const char*, double>> s_percentiles = {
+    {"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}};
+
+/**
+ * Print the latency percentiles of the entries with recorded latencies.
+ * @param kinds      The kinds of the entries, terminated by an empty kind if
+ *                   less than 'size'.
+ * @param latencies  The latency histograms of the entries.
+ * @param size       The maximum number of entries.
+ */
+void
+print_latencies(const char kinds[][MURXLA_MAX_KIND_LEN],
+                const uint64_t latencies[][MURXLA_N_LATENCY_BUCKETS],
+                uint32_t size)
+{
+  for (uint32_t i = 0; i < size && kinds[i][0]; ++i)
+  {
+    if (get_num_latencies(latencies[i]) == 0) continue;
+    std::cout << "  " << kinds[i] << ":";
+    for (const auto& [name, p] : s_percentiles)
+    {
+      uint64_t ns = get_latency_percentile(latencies[i], p);
+      std::cout << " " << name << " " << static_cast<double>(ns) / 1000;
+    }
+    std::cout << std::endl;
+  }
+}
+
+/**
+ * Get the latency histogram and percentiles of an entry in JSON format.
+ * @param latencies  The latency histogram of the entry.
+ * @return  The JSON object.
+ */
+nlohmann::json
+latencies_to_json(const uint64_t* latencies)
+{
+  nlohmann::json res;
+  res["buckets"] =
+      std::vector<uint64_t>(latencies, latencies + MURXLA_N_LATENCY_BUCKETS);
+  if (get_num_latencies(latencies))
+  {
+    for (const auto& [name, p] : s_percentiles)
+    {
+      res[std::string(name) + "_ns"] = get_latency_percentile(latencies, p);
+    }
+  }
+  return res;
+}
+
+/** @return  The string representation of given value. */
+template <class T>
+std::string
+to_string(const T& value)
+{
+  std::stringstream ss;
+  ss << value;
+  return ss.str();
+}
+
+}  // namespace
+
+uint32_t
+Statistics::get_op_index(const char* kind)
+{
+  return get_kind_index(d_op_kinds, MURXLA_MAX_N_OPS, kind);
+}
+
+void
+Statistics::merge(const Statistics& other)
+{
+  for (uint32_t i = 0; i < 3; ++i)
+  {
+    d_results[i] += other.d_results[i];
+  }
+  for (uint32_t i = 0; i < MURXLA_MAX_N_OPS && other.d_op_kinds[i][0]; ++i)
+  {
+    uint32_t idx =
+        get_kind_index(d_op_kinds, MURXLA_MAX_N_OPS, other.d_op_kinds[i]);
+    if (idx == MURXLA_MAX_N_OPS) break;
+    d_ops[idx] += other.d_ops[i];
+    d_ops_ok[idx] += other.d_ops_ok[i];
+    add_latencies(d_op_latencies[idx], other.d_op_latencies[i]);
+  }
+  for (uint32_t i = 0; i < SORT_ANY; ++i)
+  {
+    d_sorts[i] += other.d_sorts[i];
+    d_sorts_ok[i] += other.d_sorts_ok[i];
+  }
+  for (uint32_t i = 0; i < MURXLA_MAX_N_STATES && other.d_state_kinds[i][0];
+       ++i)
+  {
+    uint32_t idx = get_kind_index(
+        d_state_kinds, MURXLA_MAX_N_STATES, other.d_state_kinds[i]);
+    if (idx == MURXLA_MAX_N_STATES) break;
+    d_states[idx] += other.d_states[i];
+  }
+  for (uint32_t i = 0; i < MURXLA_MAX_N_ACTIONS && other.d_action_kinds[i][0];
+       ++i)
+  {
+    uint32_t idx = get_kind_index(
+        d_action_kinds, MURXLA_MAX_N_ACTIONS, other.d_action_kinds[i]);
+    if (idx == MURXLA_MAX_N_ACTIONS) break;
+    d_actions[idx] += other.d_actions[i];
+    d_actions_ok[idx] += other.d_actions_ok[i];
+    add_latencies(d_action_latencies[idx], other.d_action_latencies[i]);
+  }
+  d_runs += other.d_runs;
+  d_runs_wall_time += other.d_runs_wall_time;
+  d_runs_max_wall_time =
+      std::max(d_runs_max_wall_time, other.d_runs_max_wall_time);
+  d_runs_cpu_time += other.d_runs_cpu_time;
+  d_runs_max_rss = std::max(d_runs_max_rss, other.d_runs_max_rss);
+}
+
 void
 Statistics::print() const
 {
@@ -72,6 +264,73 @@ Statistics::print() const
     sum_ok += d_sorts_ok[i];
   }
   std::cout << "  Total: " << sum << " (" << sum_ok << ")" << std::endl;
+
+  std::ios_base::fmtflags flags = std::cout.flags();
+  std::cout << std::fixed << std::setprecision(3);
+
+  std::cout << "Action latencies [us]:" << std::endl;
+  print_latencies(d_action_kinds, d_action_latencies, MURXLA_MAX_N_ACTIONS);
+  std::cout << "Op latencies [us]:" << std::endl;
+  print_latencies(d_op_kinds, d_op_latencies, MURXLA_MAX_N_OPS);
+
+  std::cout << "Runs:" << std::endl;
+  std::cout << "  Total: " << d_runs << std::endl;
+  if (d_runs)
+  {
+    double runs          = static_cast<double>(d_runs);
+    double wall_time     = static_cast<double>(d_runs_wall_time) / 1000000;
+    double max_wall_time = static_cast<double>(d_runs_max_wall_time) / 1000000;
+    double cpu_time      = static_cast<double>(d_runs_cpu_time) / 1000000;
+    std::cout << "  Wall time [s]: " << wall_time
+              << " (avg: " << wall_time / runs << ", max: " << max_wall_time
+              << ")" << std::endl;
+    std::cout << "  CPU time [s]: " << cpu_time
+              << " (avg: " << cpu_time / runs << ")" << std::endl;
+    std::cout << "  Max. RSS [kB]: " << d_runs_max_rss << std::endl;
+  }
+  std::cout.flags(flags);
+}
+
+void
+Statistics::print_json(std::ostream& out) const
+{
+  nlohmann::json j;
+
+  for (uint32_t i = 0; i < MURXLA_MAX_N_STATES && d_state_kinds[i][0]; ++i)
+  {
+    j["states"][d_state_kinds[i]] = d_states[i];
+  }
+  for (uint32_t i = 0; i < MURXLA_MAX_N_ACTIONS && d_action_kinds[i][0]; ++i)
+  {
+    nlohmann::json& a = j["actions"][d_action_kinds[i]];
+    a["total"]        = d_actions[i];
+    a["ok"]           = d_actions_ok[i];
+    a["latency"]      = latencies_to_json(d_action_latencies[i]);
+  }
+  for (uint32_t i = 0; i < 3; ++i)
+  {
+    j["results"][to_string(static_cast<Solver::Result>(i))] = d_results[i];
+  }
+  for (uint32_t i = 0; i < MURXLA_MAX_N_OPS && d_op_kinds[i][0]; ++i)
+  {
+    nlohmann::json& o = j["ops"][d_op_kinds[i]];
+    o["total"]        = d_ops[i];
+    o["ok"]           = d_ops_ok[i];
+    o["latency"]      = latencies_to_json(d_op_latencies[i]);
+  }
+  for (uint32_t i = 0; i < SORT_ANY; ++i)
+  {
+    nlohmann::json& s = j["sorts"][to_string(static_cast<SortKind>(i))];
+    s["total"]        = d_sorts[i];
+    s["ok"]           = d_sorts_ok[i];
+  }
+  j["runs"]["total"]            = d_runs;
+  j["runs"]["wall_time_us"]     = d_runs_wall_time;
+  j["runs"]["max_wall_time_us"] = d_runs_max_wall_time;
+  j["runs"]["cpu_time_us"]      = d_runs_cpu_time;
+  j["runs"]["max_rss_kb"]       = d_runs_max_rss;
+
+  out << std::setw(2) << j << std::endl;
 }
 
 }  // namespace statistics
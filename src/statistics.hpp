@@ -10,6 +10,9 @@
 #ifndef __MURXLA__STATISTICS_H
 #define __MURXLA__STATISTICS_H
 
+#include <chrono>
+#include <ostream>
+
 #include "config.hpp"
 #include "op.hpp"
 
@@ -17,6 +20,15 @@ namespace murxla {
 
 namespace statistics {
 
+/** @return  The current time of a monotonic clock in nanoseconds. */
+inline uint64_t
+get_time_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 /**
  * Statistics.
  *
@@ -36,8 +48,82 @@ struct Statistics
   char d_action_kinds[MURXLA_MAX_N_ACTIONS][MURXLA_MAX_KIND_LEN];
   uint64_t d_actions[MURXLA_MAX_N_ACTIONS];
   uint64_t d_actions_ok[MURXLA_MAX_N_ACTIONS];
+  /**
+   * The latency histograms of actions (calls to Action::generate()) and
+   * operators (calls to Solver::mk_term()), see MURXLA_N_LATENCY_BUCKETS.
+   */
+  uint64_t d_action_latencies[MURXLA_MAX_N_ACTIONS][MURXLA_N_LATENCY_BUCKETS];
+  uint64_t d_op_latencies[MURXLA_MAX_N_OPS][MURXLA_N_LATENCY_BUCKETS];
+  /** The number of forked test runs with recorded resource usage. */
+  uint64_t d_runs;
+  /** The accumulated wall clock time of test runs in microseconds. */
+  uint64_t d_runs_wall_time;
+  /** The maximum wall clock time of a test run in microseconds. */
+  uint64_t d_runs_max_wall_time;
+  /** The accumulated CPU time (user + system) of test runs in microseconds. */
+  uint64_t d_runs_cpu_time;
+  /** The maximum peak resident set size of a test run in kB. */
+  uint64_t d_runs_max_rss;
+
+  /**
+   * Add the counts of given statistics object to this statistics object.
+   *
+   * This is used to aggregate the statistics of worker processes when
+   * running multiple jobs in parallel. Since operator, state and action ids
+   * are not necessarily the same across test runs, the entries are matched by
+   * their kind.
+   */
+  void merge(const Statistics& other);
+
+  /**
+   * Get the index of the entry of given operator kind. If no such entry
+   * exists yet, it is added at the first free index.
+   *
+   * Operator ids are used as indices into the operator entries. Since the set
+   * of operators depends on the theories that are enabled in a test run, ids
+   * are assigned via this function rather than in order of creation, to keep
+   * the entry of an operator kind stable across test runs.
+   *
+   * @param kind  The operator kind.
+   * @return  The index of the entry, MURXLA_MAX_N_OPS if the table is full.
+   */
+  uint32_t get_op_index(const char* kind);
+
+  /**
+   * Record the latency of a call to the action with given id.
+   * @param id  The action id.
+   * @param ns  The latency in nanoseconds.
+   */
+  void add_action_latency(uint64_t id, uint64_t ns)
+  {
+    ++d_action_latencies[id][get_latency_bucket(ns)];
+  }
+  /**
+   * Record the latency of creating a term of the operator with given id.
+   * @param id  The operator id.
+   * @param ns  The latency in nanoseconds.
+   */
+  void add_op_latency(uint64_t id, uint64_t ns)
+  {
+    ++d_op_latencies[id][get_latency_bucket(ns)];
+  }
 
   void print() const;
+
+  /**
+   * Print statistics in JSON format. Latency percentiles are given as the
+   * upper bound of the histogram bucket they fall into.
+   * @param out  The output stream to print to.
+   */
+  void print_json(std::ostream& out) const;
+
+ private:
+  /** @return  The index of the latency histogram bucket of given latency. */
+  static uint32_t get_latency_bucket(uint64_t ns)
+  {
+    uint32_t res = ns ? 63 - __builtin_clzll(ns) : 0;
+    return res < MURXLA_N_LATENCY_BUCKETS ? res : MURXLA_N_LATENCY_BUCKETS - 1;
+  }
 };
 
 }  // namespace statistics
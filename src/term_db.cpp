@@ -17,15 +17,7 @@
 
 namespace murxla {
 
-const static size_t MURXLA_PICK_MAX_WEIGHT = std::numeric_limits<size_t>::max();
-
-TermRefs::TermRefs(size_t level)
-{
-  for (size_t i = 0; i < level; ++i)
-  {
-    d_levels.push_back(0);
-  }
-}
+TermRefs::TermRefs(size_t level) : d_levels(level) {}
 
 void
 TermRefs::add(const Term& t, size_t level)
@@ -34,18 +26,16 @@ TermRefs::add(const Term& t, size_t level)
 
   if (d_idx.find(t) == d_idx.end())
   {
-    d_idx.emplace(t, d_refs.size());
-
-    size_t end = get_level_end(level);
+    d_idx.emplace(t, level);
 
-    ++d_levels[level];
-    d_terms.insert(d_terms.begin() + end, t);
-    d_refs.insert(d_refs.begin() + end, 0);
-
-    /* Initialize weight to maximum weight for new terms. Will be recomputed as
-     * soon as term is picked once. This ensures that new terms are picked with
-     * a very high probability. */
-    d_weights.insert(d_weights.begin() + end, MURXLA_PICK_MAX_WEIGHT);
+    /* New terms are fresh until they are picked for the first time. This
+     * ensures that new terms are picked with a very high probability. */
+    Level& l = d_levels[level];
+    l.d_terms.push_back(t);
+    l.d_refs.push_back(0);
+    l.d_fresh.push_back(1);
+    ++l.d_num_fresh;
+    ++d_num_fresh;
   }
 }
 
@@ -69,45 +59,61 @@ TermRefs::get(const Term& t) const
 Term
 TermRefs::pick(RNGenerator& rng, size_t level)
 {
-  assert(!d_terms.empty());
+  assert(!d_idx.empty());
+
+  size_t lbegin = 0, lend = d_levels.size();
+  /* Pick from specified level only. */
+  if (level != MAX_LEVEL)
+  {
+    assert(level < d_levels.size());
+    assert(!d_levels[level].d_terms.empty());
+    lbegin = level;
+    lend   = level + 1;
+  }
 
-  /* Terms with higher reference count have lower probability to be picked. */
-  if (d_refs_sum % 100 == 25)
+  /* Prefer terms that were not picked yet, else terms with higher reference
+   * count have lower probability to be picked. */
+  bool fresh     = false;
+  uint64_t total = 0;
+  for (size_t i = lbegin; i < lend; ++i)
   {
-    assert(d_weights.size() == d_refs.size());
-    for (size_t i = 0; i < d_weights.size(); ++i)
+    if (d_levels[i].d_num_fresh)
     {
-      d_weights[i] = d_refs_sum - d_refs[i] + 1;
+      fresh = true;
+      break;
     }
   }
-
-  size_t idx;
-  /* No specifc level requested, pick from any level. */
-  if (level == MAX_LEVEL)
+  for (size_t i = lbegin; i < lend; ++i)
   {
-    idx = rng.pick_weighted(d_weights);
+    const Level& l = d_levels[i];
+    total += fresh ? l.d_num_fresh : get_weight(l);
   }
-  /* Pick from specified level only. */
-  else
+  assert(total > 0);
+
+  uint64_t value = rng.pick<uint64_t>(0, total - 1);
+  size_t lidx    = lbegin;
+  for (;; ++lidx)
   {
-    size_t begin = get_level_begin(level);
-    size_t end   = get_level_end(level);
-    assert(end - begin > 0);
-    auto it = d_weights.begin();
-    idx     = rng.pick_weighted<size_t>(it + begin, it + end);
-    idx += begin;
-    assert(begin <= idx);
-    assert(idx < end);
+    assert(lidx < lend);
+    const Level& l = d_levels[lidx];
+    uint64_t w     = fresh ? l.d_num_fresh : get_weight(l);
+    if (value < w) break;
+    value -= w;
   }
 
-  Term t     = d_terms[idx];
-  d_refs[idx] += 1;  // increment reference count
-  d_refs_sum += 1;
+  Level& l   = d_levels[lidx];
+  size_t idx = pick_index(l, fresh, value);
+  Term t     = l.d_terms[idx];
 
-  /* d_terms[idx] was freshly added before, now compute new weight. */
-  if (d_weights[idx] == MURXLA_PICK_MAX_WEIGHT)
+  /* Increment reference count. */
+  l.d_refs.add(idx, 1);
+  l.d_refs_sum += 1;
+  d_refs_sum += 1;
+  if (fresh)
   {
-    d_weights[idx] = d_refs_sum - d_refs[idx] + 1;
+    l.d_fresh.sub(idx, 1);
+    --l.d_num_fresh;
+    --d_num_fresh;
   }
 
   return t;
@@ -122,7 +128,7 @@ TermRefs::size() const
 void
 TermRefs::push()
 {
-  d_levels.push_back(0);
+  d_levels.emplace_back();
 }
 
 void
@@ -130,22 +136,13 @@ TermRefs::pop()
 {
   assert(d_levels.size() > 1);
 
-  /* Find start of current level. */
-  size_t begin = get_level_begin(d_levels.size() - 1);
-
   /* Erase all terms from current level. */
-  std::vector<Term> removed;
-  for (auto it = d_terms.begin() + begin; it != d_terms.end(); ++it)
+  const Level& l = d_levels.back();
+  for (const auto& t : l.d_terms)
   {
-    d_idx.erase(*it);
-    removed.push_back(*it);
+    d_idx.erase(t);
   }
-  d_terms.erase(d_terms.begin() + begin, d_terms.end());
-  d_refs.erase(d_refs.begin() + begin, d_refs.end());
-  d_weights.erase(d_weights.begin() + begin, d_weights.end());
-  assert(d_idx.size() == d_terms.size());
-  assert(d_terms.size() == d_refs.size());
-  assert(d_refs.size() == d_weights.size());
+  d_num_fresh -= l.d_num_fresh;
 
   d_levels.pop_back();
   // TODO: restore d_refs_sum
@@ -155,33 +152,30 @@ size_t
 TermRefs::get_num_terms(size_t level) const
 {
   assert(level < d_levels.size());
-  return d_levels[level];
+  return d_levels[level].d_terms.size();
 }
 
-size_t
-TermRefs::get_level_begin(size_t level)
+uint64_t
+TermRefs::get_weight(const Level& level) const
 {
-  assert(level < d_levels.size());
-
-  size_t offset = 0;
-  for (size_t i = 0; i < level; ++i)
-  {
-    offset += d_levels[i];
-  }
-  return offset;
+  assert(level.d_num_fresh == 0);
+  /* The weight of each term is d_refs_sum - refs + 1 >= 1. */
+  return (d_refs_sum + 1) * level.d_terms.size() - level.d_refs_sum;
 }
 
 size_t
-TermRefs::get_level_end(size_t level)
+TermRefs::pick_index(const Level& level, bool fresh, uint64_t value) const
 {
-  assert(level < d_levels.size());
-
-  size_t offset = 0;
-  for (size_t i = 0; i <= level; ++i)
+  size_t n = level.d_terms.size();
+  if (fresh)
   {
-    offset += d_levels[i];
+    return FenwickTree<uint64_t>::search(
+        n, value, [&level](size_t node) { return level.d_fresh.node(node); });
   }
-  return offset;
+  uint64_t c = d_refs_sum + 1;
+  return FenwickTree<uint64_t>::search(n, value, [&level, c](size_t node) {
+    return c * FenwickTree<uint64_t>::range(node) - level.d_refs.node(node);
+  });
 }
 
 /* -------------------------------------------------------------------------- */
@@ -283,8 +277,9 @@ TermDb::add_term(Term& term,
   }
   else
   {
-    SortMap& map = d_term_db[sort_kind];
-    auto it      = map.find(sort);
+    bool new_sort_kind = d_term_db.find(sort_kind) == d_term_db.end();
+    SortMap& map       = d_term_db[sort_kind];
+    auto it            = map.find(sort);
 
     if (it == map.end())
     {
@@ -307,6 +302,11 @@ TermDb::add_term(Term& term,
         size_t arity = term->get_sort()->get_sorts().size() - 1;
         d_funs[arity].insert(term);
       }
+
+      if (new_sort_kind)
+      {
+        d_smgr.add_term_sort_kind(sort_kind);
+      }
     }
     else
     {
@@ -370,7 +370,7 @@ TermDb::get_term(uint64_t id) const
   return nullptr;
 }
 
-const TermDb::SortSet
+const TermDb::SortSet&
 TermDb::get_sorts() const
 {
   return d_term_sorts;
@@ -767,7 +767,7 @@ TermDb::pick_sort_kind(size_t level,
 {
   assert(has_term());
 
-  std::unordered_set<SortKind> kinds;
+  SortKindVector kinds;
   for (const auto& p : d_term_db)
   {
     if (exclude_sort_kinds.find(p.first) == exclude_sort_kinds.end())
@@ -776,13 +776,13 @@ TermDb::pick_sort_kind(size_t level,
       {
         if (pp.second.get_num_terms(level) > 0)
         {
-          kinds.insert(p.first);
+          kinds.push_back(p.first);
           break;
         }
       }
     }
   }
-  return d_rng.pick_from_set<SortKindSet, SortKind>(kinds);
+  return d_rng.pick_from_set<SortKindVector, SortKind>(kinds);
 }
 
 SortKind
@@ -790,12 +790,12 @@ TermDb::pick_sort_kind(const SortKindSet& sort_kinds) const
 {
   assert(has_term());
 
-  std::unordered_set<SortKind> kinds;
+  SortKindVector kinds;
   for (const auto& p : d_term_db)
   {
-    if (sort_kinds.find(p.first) != sort_kinds.end()) kinds.insert(p.first);
+    if (sort_kinds.find(p.first) != sort_kinds.end()) kinds.push_back(p.first);
   }
-  return d_rng.pick_from_set<SortKindSet, SortKind>(kinds);
+  return d_rng.pick_from_set<SortKindVector, SortKind>(kinds);
 }
 
 SortKind
@@ -803,15 +803,15 @@ TermDb::pick_sort_kind_excluding(const SortKindSet& exclude_sort_kinds) const
 {
   assert(has_term());
 
-  std::unordered_set<SortKind> kinds;
+  SortKindVector kinds;
   for (const auto& p : d_term_db)
   {
     if (exclude_sort_kinds.find(p.first) == exclude_sort_kinds.end())
     {
-      kinds.insert(p.first);
+      kinds.push_back(p.first);
     }
   }
-  return d_rng.pick_from_set<SortKindSet, SortKind>(kinds);
+  return d_rng.pick_from_set<SortKindVector, SortKind>(kinds);
 }
 
 Sort
@@ -912,29 +912,35 @@ TermDb::pop(const Term& var)
   /* Pop current level from d_term_db and cleanup. */
   for (auto it = d_term_db.begin(); it != d_term_db.end();)
   {
-    auto& skind = it->first;
-    auto& skmap = it->second;
-    ++it;
+    SortKind skind = it->first;
+    auto& skmap    = it->second;
 
     for (auto iit = skmap.begin(); iit != skmap.end();)
     {
-      auto& tref       = iit->second;
-      const auto& sort = iit->first;
-      ++iit;
+      auto& tref = iit->second;
 
       tref.pop();
 
       /* Remove sorts without terms. */
       if (tref.size() == 0)
       {
-        skmap.erase(sort);
+        iit = skmap.erase(iit);
+      }
+      else
+      {
+        ++iit;
       }
     }
 
     /* Remove sort kinds without terms. */
     if (skmap.empty())
     {
-      d_term_db.erase(skind);
+      d_smgr.remove_term_sort_kind(skind);
+      it = d_term_db.erase(it);
+    }
+    else
+    {
+      ++it;
     }
   }
 
@@ -13,6 +13,8 @@
 #include <cstddef>
 #include <iterator>
 
+#include "fenwick_tree.hpp"
+#include "indexed_set.hpp"
 #include "solver/solver.hpp"
 
 namespace murxla {
@@ -24,6 +26,12 @@ class RNGenerator;
  * This class manages term references and random picking of terms based on
  * the number of references where terms with higher reference counts have lower
  * probability to be picked.
+ *
+ * Terms that have not been picked yet are always preferred. Else, a term t is
+ * picked with weight 'refs_sum - refs(t) + 1', where refs_sum is the sum of
+ * all references. Reference counts and weights are maintained incrementally
+ * in Fenwick trees (one per level), which allows to add and pick terms in
+ * O(log n).
  */
 class TermRefs
 {
@@ -41,6 +49,7 @@ class TermRefs
   /**
    * Pick random term based on reference counts.
    * Terms with higher reference count have lower probability to be picked.
+   * If a level is given, only terms of that level are considered.
    */
   Term pick(RNGenerator& rng, size_t level = MAX_LEVEL);
   /** Return number of stored terms. */
@@ -90,31 +99,55 @@ class TermRefs
   size_t get_num_terms(size_t level) const;
 
  private:
-  size_t get_level_begin(size_t level);
-  size_t get_level_end(size_t level);
+  /** The terms of a level. */
+  struct Level
+  {
+    /** Maps term index to term. */
+    std::vector<Term> d_terms;
+    /** Maps term index to references. */
+    FenwickTree<uint64_t> d_refs;
+    /** Maps term index to 1 if the term was not picked yet, else 0. */
+    FenwickTree<uint64_t> d_fresh;
+    /** The sum of all references of the terms in this level. */
+    uint64_t d_refs_sum = 0;
+    /** The number of terms in this level that were not picked yet. */
+    uint64_t d_num_fresh = 0;
+  };
+
+  /**
+   * Get the sum of the pick weights of all terms of given level.
+   * Only valid if the level does not contain any fresh terms.
+   */
+  uint64_t get_weight(const Level& level) const;
 
-  /** Map term to term index. */
+  /**
+   * Pick the index of a term of given level.
+   * @param level  The level to pick from.
+   * @param fresh  True to pick from the fresh terms only.
+   * @param value  A random value less than the number of fresh terms if
+   *               'fresh' is true, and less than the weight of the level
+   *               (see get_weight()), else.
+   */
+  size_t pick_index(const Level& level, bool fresh, uint64_t value) const;
+
+  /** Map term to the level it was added to. */
   std::unordered_map<Term, size_t> d_idx;
-  /** Maps term index to term. */
-  std::vector<Term> d_terms;
-  /** Maps term index to references. */
-  std::vector<size_t> d_refs;
-  /** Maps term index to pick weight (used by pick()). */
-  std::vector<size_t> d_weights;
-  /** Sum of all references d_refs, used to compute weights in pick(). */
-  size_t d_refs_sum = 0;
-
-  /* Maps level to number of corresponding terms. */
-  std::vector<size_t> d_levels;
+  /** Sum of all references, used to compute weights in pick(). */
+  uint64_t d_refs_sum = 0;
+  /** The number of terms (in all levels) that were not picked yet. */
+  uint64_t d_num_fresh = 0;
+
+  /* The terms of each level. */
+  std::vector<Level> d_levels;
 };
 
 class TermDb
 {
  public:
-  using SortMap     = std::unordered_map<Sort, TermRefs>;
-  using SortSet     = std::unordered_set<Sort>;
+  using SortMap     = IndexedMap<Sort, TermRefs>;
+  using SortSet     = IndexedSet<Sort>;
   using SortKindSet = std::unordered_set<SortKind>;
-  using SortTermMap = std::unordered_map<SortKind, SortMap>;
+  using SortTermMap = IndexedMap<SortKind, SortMap>;
 
   TermDb(SolverManager& smgr, RNGenerator& rng);
 
@@ -170,7 +203,7 @@ class TermDb
   Term get_term(uint64_t id) const;
 
   /** Returns all term sorts currently in the database. */
-  const SortSet get_sorts() const;
+  const SortSet& get_sorts() const;
 
   /** Return true if term database has a value. */
   bool has_value() const;
@@ -380,7 +413,7 @@ class TermDb
   std::unordered_map<uint64_t, Term> d_terms_intermediate;
 
   /** Maps function term arity to function terms. */
-  std::unordered_map<size_t, std::unordered_set<Term>> d_funs;
+  IndexedMap<size_t, IndexedSet<Term>> d_funs;
 
   /** Maps scope level to variable that opened the scope. */
   std::vector<Term> d_vars;
@@ -0,0 +1,118 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#include "trace_buffer.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "except.hpp"
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+TraceBuffer::TraceBuffer(const std::string& file_name)
+{
+  d_fd = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  MURXLA_EXIT_ERROR(d_fd < 0) << "unable to open file '" << file_name << "'";
+}
+
+TraceBuffer::~TraceBuffer() { close(); }
+
+void
+TraceBuffer::close()
+{
+  if (d_fd < 0) return;
+  if (d_data)
+  {
+    set_length();
+    munmap(d_data, d_size);
+    d_data = nullptr;
+    setp(nullptr, nullptr);
+  }
+  ::close(d_fd);
+  d_fd = -1;
+}
+
+void
+TraceBuffer::truncate(const std::string& file_name)
+{
+  int32_t fd = open(file_name.c_str(), O_RDWR | O_CLOEXEC);
+  if (fd < 0) return;
+
+  struct stat st;
+  uint64_t length;
+  if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(length))
+  {
+    size_t size = static_cast<size_t>(st.st_size);
+    off_t pos   = static_cast<off_t>(size - sizeof(length));
+    ssize_t n   = pread(fd, &length, sizeof(length), pos);
+    MURXLA_EXIT_ERROR(n != static_cast<ssize_t>(sizeof(length))
+                      || length > size - sizeof(length))
+        << "unable to read length of trace file";
+    MURXLA_EXIT_ERROR(ftruncate(fd, static_cast<off_t>(length)) < 0)
+        << "unable to truncate trace file";
+  }
+  ::close(fd);
+}
+
+int32_t
+TraceBuffer::sync()
+{
+  if (d_data) set_length();
+  return 0;
+}
+
+TraceBuffer::int_type
+TraceBuffer::overflow(int_type c)
+{
+  if (traits_type::eq_int_type(c, traits_type::eof()))
+  {
+    return traits_type::not_eof(c);
+  }
+  map(d_size + CHUNK_SIZE);
+  *pptr() = traits_type::to_char_type(c);
+  pbump(1);
+  return c;
+}
+
+void
+TraceBuffer::map(size_t size)
+{
+  size_t pos = d_data ? static_cast<size_t>(pptr() - pbase()) : 0;
+  if (d_data)
+  {
+    munmap(d_data, d_size);
+  }
+  MURXLA_EXIT_ERROR(ftruncate(d_fd, static_cast<off_t>(size)) < 0)
+      << "unable to grow trace file";
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, d_fd, 0);
+  MURXLA_EXIT_ERROR(data == MAP_FAILED) << "unable to map trace file";
+  d_data = static_cast<char*>(data);
+  d_size = size;
+  setp(d_data, d_data + d_size - sizeof(uint64_t));
+  pbump(static_cast<int32_t>(pos));
+  set_length();
+}
+
+void
+TraceBuffer::set_length()
+{
+  uint64_t length = static_cast<uint64_t>(pptr() - pbase());
+  std::memcpy(d_data + d_size - sizeof(length), &length, sizeof(length));
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
@@ -0,0 +1,94 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__TRACE_BUFFER_H
+#define __MURXLA__TRACE_BUFFER_H
+
+#include <cstdint>
+#include <streambuf>
+#include <string>
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Stream buffer that writes the API trace of a forked test run into a shared
+ * memory mapping of the trace file.
+ *
+ * Written characters end up in the (memory) file immediately, without a
+ * system call per trace line. The file is grown in chunks, the last word of
+ * the mapping holds the length of the trace, which is updated whenever the
+ * stream is flushed (i.e., after each trace line) and when the buffer is
+ * closed. The trace is thus complete up to the last flushed line no matter
+ * how the child process terminates (exit, abort, crash signal, or _exit() in
+ * sanitizers). The parent truncates the file to the recorded length via
+ * truncate() after the child terminated. Unlike stripping trailing zero
+ * bytes, this preserves traces that end in zero bytes (binary traces).
+ *
+ * A trace buffer is created in the parent before forking but only maps the
+ * file when the child writes to it. Closing the unused instance of the parent
+ * does not modify the file.
+ */
+class TraceBuffer : public std::streambuf
+{
+ public:
+  /**
+   * Constructor.
+   * @param file_name  The name of the file to write the trace to. The file is
+   *                   created if it does not exist and truncated otherwise.
+   */
+  TraceBuffer(const std::string& file_name);
+  ~TraceBuffer();
+
+  /**
+   * Record the length of the trace, unmap and close the trace file. Must be
+   * called explicitly by a child process before it exits.
+   */
+  void close();
+
+  /**
+   * Truncate given trace file to the length of the trace recorded in its last
+   * word, i.e., remove the unwritten part of the last chunk and the length
+   * word. Must be called in the parent process after the child terminated.
+   * Files that were not written to are not modified.
+   * @param file_name  The name of the trace file.
+   */
+  static void truncate(const std::string& file_name);
+
+ protected:
+  int_type overflow(int_type c) override;
+  /**
+   * Record the length of the trace. Characters are written to the mapping,
+   * no system call is required.
+   */
+  int32_t sync() override;
+
+ private:
+  /** The size of the chunks the file is grown by. */
+  static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+  /** Grow the file and its mapping to given size. */
+  void map(size_t size);
+  /** Store the length of the trace in the last word of the mapping. */
+  void set_length();
+
+  /** The file descriptor of the trace file. */
+  int32_t d_fd = -1;
+  /** The mapping of the trace file, nullptr if not mapped. */
+  char* d_data = nullptr;
+  /** The size of the mapping. */
+  size_t d_size = 0;
+};
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
+
+#endif
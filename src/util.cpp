@@ -640,6 +640,7 @@ tokenize(const std::string& line)
     else if (token[0] == '"' && token[token.size() - 1] != '"')
     {
       open_str = true;
+      ss.str("");
       ss << token;
     }
     else
@@ -0,0 +1,258 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#include "watchdog.hpp"
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#endif
+
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+#include "except.hpp"
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** The interval in milliseconds in which children without pidfd are polled. */
+constexpr int32_t POLL_INTERVAL_MS = 1;
+
+/** Get the current time of the steady clock in seconds. */
+double
+get_steady_time()
+{
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/** Convert given timeval to seconds. */
+double
+to_seconds(const struct timeval& tv)
+{
+  return (double) tv.tv_sec + (double) tv.tv_usec / 1000000;
+}
+
+/** Get the CPU time and peak memory usage of given resource usage. */
+ResourceUsage
+to_usage(const struct rusage& ru)
+{
+  ResourceUsage usage;
+  usage.d_cpu_time = to_seconds(ru.ru_utime) + to_seconds(ru.ru_stime);
+#ifdef __APPLE__
+  /* On macOS, ru_maxrss is given in bytes rather than kilobytes. */
+  usage.d_max_rss = static_cast<uint64_t>(ru.ru_maxrss) / 1024;
+#else
+  usage.d_max_rss = static_cast<uint64_t>(ru.ru_maxrss);
+#endif
+  return usage;
+}
+
+}  // namespace
+
+/* -------------------------------------------------------------------------- */
+
+std::ostream&
+operator<<(std::ostream& out, const ResourceUsage& usage)
+{
+  std::ios_base::fmtflags flags = out.flags();
+  out << std::fixed << std::setprecision(3) << "wall: " << usage.d_wall_time
+      << "s, cpu: " << usage.d_cpu_time << "s, rss: " << usage.d_max_rss
+      << "kB";
+  out.flags(flags);
+  return out;
+}
+
+ResourceUsage
+get_self_usage()
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  ResourceUsage usage = to_usage(ru);
+  /* Include the CPU time of terminated child processes, as wait4() does. */
+  getrusage(RUSAGE_CHILDREN, &ru);
+  usage.d_cpu_time += to_usage(ru).d_cpu_time;
+  return usage;
+}
+
+/* -------------------------------------------------------------------------- */
+
+Watchdog::Watchdog(TimeoutCallback on_timeout) : d_on_timeout(on_timeout)
+{
+#ifdef __linux__
+  d_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+#endif
+}
+
+Watchdog::~Watchdog()
+{
+  /* Kill and collect all children that are still watched. */
+  Event event;
+  while (!d_children.empty())
+  {
+    kill(d_children.back().d_pid, SIGKILL);
+    collect(d_children.size() - 1, true, true, event);
+  }
+  if (d_epoll_fd >= 0)
+  {
+    close(d_epoll_fd);
+  }
+}
+
+void
+Watchdog::watch(pid_t pid, double time)
+{
+  assert(pid > 0);
+  assert(time >= 0);
+
+  double now    = get_steady_time();
+  int32_t pidfd = -1;
+#if defined(__linux__) && defined(SYS_pidfd_open)
+  if (d_epoll_fd >= 0)
+  {
+    pidfd = static_cast<int32_t>(syscall(SYS_pidfd_open, pid, 0));
+    if (pidfd >= 0)
+    {
+      struct epoll_event ev = {};
+      ev.events             = EPOLLIN;
+      ev.data.fd            = pidfd;
+      if (epoll_ctl(d_epoll_fd, EPOLL_CTL_ADD, pidfd, &ev) < 0)
+      {
+        close(pidfd);
+        pidfd = -1;
+      }
+    }
+  }
+#endif
+  d_children.push_back({pid, pidfd, now, time > 0 ? now + time : 0});
+}
+
+Watchdog::Event
+Watchdog::wait()
+{
+  assert(!d_children.empty());
+
+  Event event;
+  for (;;)
+  {
+    double now         = get_steady_time();
+    int32_t timeout_ms = -1;
+    bool use_polling   = d_epoll_fd < 0;
+
+    for (const auto& child : d_children)
+    {
+      if (child.d_pidfd < 0) use_polling = true;
+    }
+
+    for (size_t i = 0; i < d_children.size(); ++i)
+    {
+      const Child& child = d_children[i];
+      if (use_polling && collect(i, false, false, event)) return event;
+      if (child.d_deadline == 0) continue;
+
+      if (now >= child.d_deadline)
+      {
+        /* Do not report a timeout if the child terminated in time. */
+        if (collect(i, false, false, event)) return event;
+        if (d_on_timeout)
+        {
+          d_on_timeout(child.d_pid);
+        }
+        kill(child.d_pid, SIGKILL);
+        collect(i, true, true, event);
+        return event;
+      }
+      int32_t ms =
+          static_cast<int32_t>(std::ceil((child.d_deadline - now) * 1000));
+      if (timeout_ms < 0 || ms < timeout_ms) timeout_ms = ms;
+    }
+
+    if (use_polling && (timeout_ms < 0 || timeout_ms > POLL_INTERVAL_MS))
+    {
+      timeout_ms = POLL_INTERVAL_MS;
+    }
+
+#ifdef __linux__
+    if (!use_polling)
+    {
+      struct epoll_event ev;
+      int32_t n = epoll_wait(d_epoll_fd, &ev, 1, timeout_ms);
+      MURXLA_EXIT_ERROR(n < 0 && errno != EINTR)
+          << "failed to wait for child processes";
+      if (n <= 0) continue;
+      for (size_t i = 0; i < d_children.size(); ++i)
+      {
+        if (d_children[i].d_pidfd == ev.data.fd)
+        {
+          collect(i, true, false, event);
+          return event;
+        }
+      }
+      continue;
+    }
+#endif
+    assert(timeout_ms >= 0);
+    usleep(static_cast<useconds_t>(timeout_ms * 1000));
+  }
+}
+
+bool
+Watchdog::collect(size_t idx, bool block, bool timeout, Event& event)
+{
+  assert(idx < d_children.size());
+
+  Child child = d_children[idx];
+  int32_t status;
+  struct rusage ru;
+  pid_t res;
+  do
+  {
+    res = wait4(child.d_pid, &status, block ? 0 : WNOHANG, &ru);
+  } while (res < 0 && errno == EINTR);
+
+  if (res == 0)
+  {
+    assert(!block);
+    return false;
+  }
+  MURXLA_EXIT_ERROR(res < 0)
+      << "failed to collect child process " << child.d_pid;
+
+  event.d_pid               = child.d_pid;
+  event.d_status            = status;
+  event.d_timeout           = timeout;
+  event.d_usage             = to_usage(ru);
+  event.d_usage.d_wall_time = get_steady_time() - child.d_start;
+
+  if (child.d_pidfd >= 0)
+  {
+#ifdef __linux__
+    epoll_ctl(d_epoll_fd, EPOLL_CTL_DEL, child.d_pidfd, nullptr);
+#endif
+    close(child.d_pidfd);
+  }
+  d_children.erase(d_children.begin() + idx);
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
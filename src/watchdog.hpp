@@ -0,0 +1,137 @@
+/***
+ * Murxla: A Model-Based API Fuzzer for SMT solvers.
+ *
+ * This file is part of Murxla.
+ *
+ * Copyright (C) 2019-2022 by the authors listed in the AUTHORS file.
+ *
+ * See LICENSE for more information on using this software.
+ */
+#ifndef __MURXLA__WATCHDOG_H
+#define __MURXLA__WATCHDOG_H
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace murxla {
+
+/* -------------------------------------------------------------------------- */
+
+/** The resources used by a terminated child process. */
+struct ResourceUsage
+{
+  /** The wall clock time in seconds. */
+  double d_wall_time = 0;
+  /** The CPU time (user + system) in seconds. */
+  double d_cpu_time = 0;
+  /** The peak resident set size in kB. */
+  uint64_t d_max_rss = 0;
+};
+
+std::ostream& operator<<(std::ostream& out, const ResourceUsage& usage);
+
+/**
+ * Get the resources used by the calling process and its terminated children
+ * so far. The wall clock time is not tracked and always 0.
+ */
+ResourceUsage get_self_usage();
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Watchdog for forked child processes.
+ *
+ * Tracks the deadlines of any number of child processes from a single event
+ * loop in the calling process. On Linux, children are monitored via process
+ * file descriptors (pidfd_open) and epoll, with the epoll timeout set to the
+ * nearest deadline. If process file descriptors are not supported, children
+ * are polled instead.
+ *
+ * Children that exceed their time limit are killed. Terminated children are
+ * collected via wait4(), which provides their resource usage.
+ */
+class Watchdog
+{
+ public:
+  /** Callback that is called before a timed out child is killed. */
+  using TimeoutCallback = std::function<void(pid_t)>;
+
+  /** The result of waiting for a watched child process. */
+  struct Event
+  {
+    /** The pid of the terminated child. */
+    pid_t d_pid = 0;
+    /** The status of the child as returned by wait4(). */
+    int32_t d_status = 0;
+    /** True if the child was killed because it exceeded its time limit. */
+    bool d_timeout = false;
+    /** The resources used by the child. */
+    ResourceUsage d_usage;
+  };
+
+  /**
+   * Constructor.
+   * @param on_timeout  The callback to call before killing a timed out child
+   *                    with SIGKILL, e.g., to give the child the chance to
+   *                    clean up.
+   */
+  Watchdog(TimeoutCallback on_timeout = nullptr);
+  ~Watchdog();
+
+  /**
+   * Start watching given child process.
+   * @param pid   The pid of the child process.
+   * @param time  The time limit in seconds, 0 for no time limit.
+   */
+  void watch(pid_t pid, double time);
+
+  /**
+   * Wait until the next watched child terminates or exceeds its time limit.
+   * The child is collected and not watched anymore afterwards.
+   * @return  The event describing the terminated child.
+   */
+  Event wait();
+
+  /** @return  True if no child is currently watched. */
+  bool empty() const { return d_children.empty(); }
+
+ private:
+  /** A watched child process. */
+  struct Child
+  {
+    pid_t d_pid;
+    /** The process file descriptor, -1 if not supported. */
+    int32_t d_pidfd;
+    /** The (steady clock) time when the child started being watched. */
+    double d_start;
+    /** The deadline, 0 for no time limit. */
+    double d_deadline;
+  };
+
+  /**
+   * Collect given child and remove it from the set of watched children.
+   * @param idx      The index of the child in d_children.
+   * @param block    True if wait4() should block.
+   * @param timeout  True if the child was killed due to a timeout.
+   * @param event    The event to fill.
+   * @return  False if block is false and the child did not terminate yet.
+   */
+  bool collect(size_t idx, bool block, bool timeout, Event& event);
+
+  /** The callback to call before killing timed out children. */
+  TimeoutCallback d_on_timeout;
+  /** The epoll instance, -1 if not supported. */
+  int32_t d_epoll_fd = -1;
+  /** The watched children. */
+  std::vector<Child> d_children;
+};
+
+/* -------------------------------------------------------------------------- */
+
+}  // namespace murxla
+
+#endif
@@ -0,0 +1,235 @@
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "arena.hpp"
+#include "gtest/gtest.h"
+
+using namespace murxla;
+
+namespace {
+
+/** @return  The start address of the chunk that contains given address. */
+uintptr_t
+chunk_of(const void* ptr)
+{
+  return reinterpret_cast<uintptr_t>(ptr) & ~(Arena::CHUNK_SIZE - 1);
+}
+
+/** An object that records its destruction. */
+struct Object
+{
+  Object(uint64_t value, size_t* destroyed)
+      : d_value(value), d_destroyed(destroyed)
+  {
+  }
+  ~Object() { *d_destroyed += 1; }
+  uint64_t d_value;
+  size_t* d_destroyed;
+};
+
+}  // namespace
+
+TEST(arena, alignment)
+{
+  std::vector<std::pair<void*, size_t>> ptrs;
+  for (size_t size : {1, 3, 8, 17, 33, 100, 255, 1000})
+  {
+    void* ptr = Arena::allocate(size);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t),
+              0u);
+    ptrs.emplace_back(ptr, size);
+  }
+  for (const auto& [ptr, size] : ptrs)
+  {
+    Arena::deallocate(ptr, size);
+  }
+
+  struct alignas(std::max_align_t) Aligned
+  {
+    char d_c;
+  };
+  std::vector<std::shared_ptr<Aligned>> objs;
+  for (size_t i = 0; i < 10; ++i)
+  {
+    objs.push_back(make_arena_shared<Aligned>());
+    ASSERT_EQ(
+        reinterpret_cast<uintptr_t>(objs.back().get()) % alignof(Aligned), 0u);
+  }
+}
+
+TEST(arena, reuse)
+{
+  /* The current chunk is reused from the start once all of its objects have
+   * been deallocated. */
+  void* ptr = Arena::allocate(64);
+  Arena::deallocate(ptr, 64);
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < 100; ++i)
+  {
+    ptrs.push_back(Arena::allocate(64));
+  }
+  ASSERT_EQ(ptrs[0], ptr);
+  for (void* p : ptrs)
+  {
+    Arena::deallocate(p, 64);
+  }
+  void* reused = Arena::allocate(64);
+  ASSERT_EQ(reused, ptr);
+
+  /* The current chunk is not reused while any of its objects is live. */
+  void* next = Arena::allocate(64);
+  Arena::deallocate(reused, 64);
+  void* other = Arena::allocate(64);
+  ASSERT_NE(other, ptr);
+  ASSERT_NE(other, next);
+  Arena::deallocate(next, 64);
+  Arena::deallocate(other, 64);
+}
+
+TEST(arena, span_chunks)
+{
+  /* Allocate enough objects to fill several chunks. */
+  size_t size = Arena::MAX_SIZE - 8;
+  size_t n    = 5 * (Arena::CHUNK_SIZE / Arena::MAX_SIZE);
+  std::vector<unsigned char*> ptrs;
+  for (size_t i = 0; i < n; ++i)
+  {
+    unsigned char* ptr = static_cast<unsigned char*>(Arena::allocate(size));
+    /* Objects are never split across chunks. */
+    ASSERT_EQ(chunk_of(ptr), chunk_of(ptr + size - 1));
+    std::memset(ptr, static_cast<int>(i % 256), size);
+    ptrs.push_back(ptr);
+  }
+  ASSERT_NE(chunk_of(ptrs.front()), chunk_of(ptrs.back()));
+
+  /* Objects do not overlap. */
+  for (size_t i = 0; i < n; ++i)
+  {
+    for (size_t j = 0; j < size; ++j)
+    {
+      ASSERT_EQ(ptrs[i][j], i % 256);
+    }
+  }
+
+  /* The previous chunks are freed with their last object. */
+  for (size_t i = 0; i < n; ++i)
+  {
+    Arena::deallocate(ptrs[i], size);
+  }
+}
+
+TEST(arena, large)
+{
+  size_t size = Arena::MAX_SIZE + 1;
+  void* ptr   = Arena::allocate(size);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t), 0u);
+  std::memset(ptr, 0xff, size);
+  Arena::deallocate(ptr, size);
+}
+
+TEST(arena, shared)
+{
+  size_t destroyed = 0;
+  {
+    std::vector<std::shared_ptr<Object>> objs;
+    for (uint64_t i = 0; i < 10000; ++i)
+    {
+      objs.push_back(make_arena_shared<Object>(i, &destroyed));
+    }
+    for (uint64_t i = 0; i < 10000; ++i)
+    {
+      ASSERT_EQ(objs[i]->d_value, i);
+    }
+  }
+  ASSERT_EQ(destroyed, 10000u);
+}
+
+TEST(arena, release_other_thread)
+{
+  /* Objects are deleted by another thread than the one that created them,
+   * as done by the deleters of the shadow solver. */
+  size_t n         = 10 * (Arena::CHUNK_SIZE / sizeof(Object));
+  size_t destroyed = 0;
+  std::vector<Object*> objs;
+  for (uint64_t i = 0; i < n; ++i)
+  {
+    objs.push_back(arena_new<Object>(i, &destroyed));
+  }
+  uintptr_t last       = reinterpret_cast<uintptr_t>(objs.back());
+  uintptr_t last_chunk = chunk_of(objs.back());
+  std::thread t([&objs]() {
+    for (Object* o : objs)
+    {
+      arena_delete(o);
+    }
+  });
+  t.join();
+  ASSERT_EQ(destroyed, n);
+
+  /* The current chunk is reused from the start after its objects were
+   * released by the other thread. */
+  Object* obj = arena_new<Object>(0, &destroyed);
+  ASSERT_EQ(chunk_of(obj), last_chunk);
+  ASSERT_LT(reinterpret_cast<uintptr_t>(obj), last);
+  arena_delete(obj);
+}
+
+TEST(arena, release_after_thread_exit)
+{
+  /* Objects outlive the thread that created them, the chunks are released
+   * with their last object. */
+  size_t destroyed = 0;
+  std::vector<std::shared_ptr<Object>> objs;
+  std::thread t([&objs, &destroyed]() {
+    for (uint64_t i = 0; i < 10000; ++i)
+    {
+      objs.push_back(make_arena_shared<Object>(i, &destroyed));
+    }
+  });
+  t.join();
+  for (uint64_t i = 0; i < 10000; ++i)
+  {
+    ASSERT_EQ(objs[i]->d_value, i);
+  }
+  objs.clear();
+  ASSERT_EQ(destroyed, 10000u);
+}
+
+TEST(arena, concurrent)
+{
+  /* Threads concurrently release objects allocated by other threads. */
+  std::vector<std::thread> threads;
+  std::vector<std::vector<void*>> ptrs(4);
+  for (size_t i = 0; i < ptrs.size(); ++i)
+  {
+    threads.emplace_back([&ptrs, i]() {
+      for (size_t j = 0; j < 20000; ++j)
+      {
+        ptrs[i].push_back(Arena::allocate(32));
+      }
+    });
+  }
+  for (auto& t : threads)
+  {
+    t.join();
+  }
+  threads.clear();
+  for (size_t i = 0; i < ptrs.size(); ++i)
+  {
+    threads.emplace_back([&ptrs, i]() {
+      /* Release the objects of the next thread, while that thread releases
+       * the objects of another one. */
+      for (void* ptr : ptrs[(i + 1) % ptrs.size()])
+      {
+        Arena::deallocate(ptr, 32);
+      }
+    });
+  }
+  for (auto& t : threads)
+  {
+    t.join();
+  }
+}
@@ -0,0 +1,165 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "binary_trace.hpp"
+#include "except.hpp"
+#include "gtest/gtest.h"
+#include "test_helpers.hpp"
+#include "util.hpp"
+
+using namespace murxla;
+using namespace murxla::test;
+
+namespace {
+
+/** A text trace that exercises all piece encodings. */
+const std::string s_trace =
+    "set-murxla-options --smt2 -s 1234\n"
+    "1 new\n"
+    "2 mk-sort SORT_BV 32\n"
+    "return s1\n"
+    "3 mk-const s1 \"x\"\n"
+    "return t1\n"
+    "4 mk-value s1 \"a b  c\"\n"
+    "return t2\n"
+    "5 mk-term OP_BV_ADD SORT_BV 2 t1 t2\n"
+    "return t3 s1\n"
+    "\n"
+    "# comment  with  spaces\n"
+    " 6 mk-value s1 007 18446744073709551615 123456789012345678 300\n"
+    "return t127 s128 t16384\n"
+    "7 check-sat";
+
+}  // namespace
+
+TEST(binary_trace, varint_encoding)
+{
+  std::stringstream ss;
+  BinaryTraceWriter writer(ss);
+  writer.write_line("1 300");
+  writer.write_line("t0 s1", false);
+
+  std::string expected = BinaryTrace::MAGIC;
+  /* 2 pieces, terminated by newline. */
+  expected.push_back(2 << 1 | 1);
+  expected.push_back(1 << 3 | BinaryTrace::UINT);
+  /* 300 << 3 | UINT = 2401 = 0x961, encoded in two bytes. */
+  expected.push_back(static_cast<char>(0x61 | 0x80));
+  expected.push_back(0x12);
+  /* 2 pieces, not terminated by newline. */
+  expected.push_back(2 << 1);
+  expected.push_back(0 << 3 | BinaryTrace::TERM);
+  expected.push_back(1 << 3 | BinaryTrace::SORT);
+  ASSERT_EQ(ss.str(), expected);
+}
+
+TEST(binary_trace, string_table)
+{
+  std::stringstream ss;
+  BinaryTraceWriter writer(ss);
+  writer.write_line("new  new");
+  writer.write_line("007");
+
+  std::string expected = BinaryTrace::MAGIC;
+  expected.push_back(3 << 1 | 1);
+  /* First occurrence is stored inline and gets index 0. */
+  expected.push_back(3 << 3 | BinaryTrace::STR_NEW);
+  expected.append("new");
+  expected.push_back(BinaryTrace::EMPTY);
+  /* Later occurrences reference the string table. */
+  expected.push_back(0 << 3 | BinaryTrace::STR);
+  /* Numbers with leading zeros are not encoded as varints. */
+  expected.push_back(1 << 1 | 1);
+  expected.push_back(3 << 3 | BinaryTrace::STR_NEW);
+  expected.append("007");
+  ASSERT_EQ(ss.str(), expected);
+}
+
+TEST(binary_trace, roundtrip)
+{
+  std::string bin_file_name = tmp_file("roundtrip.bin");
+  {
+    std::ofstream out(bin_file_name, std::ios::binary | std::ios::trunc);
+    BinaryTraceWriter writer(out);
+    std::vector<std::string> lines = split(s_trace, '\n');
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+      writer.write_line(lines[i], i + 1 < lines.size());
+    }
+  }
+  ASSERT_TRUE(BinaryTrace::is_binary_trace(bin_file_name));
+
+  std::string text_file_name = tmp_file("roundtrip.txt");
+  write_file(text_file_name, s_trace);
+  ASSERT_FALSE(BinaryTrace::is_binary_trace(text_file_name));
+
+  /* Both readers yield the same lines, tokens and newline flags. */
+  auto bin_reader  = TraceReader::open(bin_file_name);
+  auto text_reader = TraceReader::open(text_file_name);
+  ASSERT_NE(bin_reader, nullptr);
+  ASSERT_NE(text_reader, nullptr);
+  std::string bin_line, text_line;
+  bool bin_newline, text_newline;
+  std::string text;
+  while (text_reader->next_text(text_line, text_newline))
+  {
+    ASSERT_TRUE(bin_reader->next_text(bin_line, bin_newline));
+    ASSERT_EQ(bin_line, text_line);
+    ASSERT_EQ(bin_newline, text_newline);
+    ASSERT_EQ(bin_reader->line_number(), text_reader->line_number());
+    text += bin_line;
+    if (bin_newline) text += "\n";
+  }
+  ASSERT_FALSE(bin_reader->next_text(bin_line, bin_newline));
+  ASSERT_EQ(text, s_trace);
+
+  bin_reader  = TraceReader::open(bin_file_name);
+  text_reader = TraceReader::open(text_file_name);
+  TraceLine bin_tline, text_tline;
+  while (text_reader->next(text_tline))
+  {
+    ASSERT_TRUE(bin_reader->next(bin_tline));
+    ASSERT_EQ(bin_tline.d_ignore, text_tline.d_ignore);
+    if (text_tline.d_ignore) continue;
+    ASSERT_EQ(bin_tline.d_seed, text_tline.d_seed);
+    ASSERT_EQ(bin_tline.d_id, text_tline.d_id);
+    ASSERT_EQ(bin_tline.d_tokens, text_tline.d_tokens);
+  }
+  ASSERT_FALSE(bin_reader->next(bin_tline));
+}
+
+TEST(binary_trace, convert_trace)
+{
+  std::string text_file_name = tmp_file("convert.txt");
+  std::string bin_file_name  = tmp_file("convert.bin");
+  std::string out_file_name  = tmp_file("convert.out");
+
+  for (const std::string& trace : {s_trace, s_trace + "\n"})
+  {
+    write_file(text_file_name, trace);
+    convert_trace(text_file_name, bin_file_name);
+    ASSERT_TRUE(BinaryTrace::is_binary_trace(bin_file_name));
+    ASSERT_LT(read_file(bin_file_name).size(), trace.size());
+    convert_trace(bin_file_name, out_file_name);
+    ASSERT_EQ(read_file(out_file_name), trace);
+  }
+}
+
+TEST(binary_trace, corrupted)
+{
+  std::string file_name = tmp_file("corrupted.bin");
+  std::stringstream ss;
+  {
+    BinaryTraceWriter writer(ss);
+    writer.write_line("1 mk-term OP_AND");
+  }
+  std::string bin = ss.str();
+  /* Truncate within the inline string. */
+  write_file(file_name, bin.substr(0, bin.size() - 2));
+  auto reader = TraceReader::open(file_name);
+  std::string line;
+  bool newline;
+  ASSERT_THROW(reader->next_text(line, newline), MurxlaUntraceException);
+}
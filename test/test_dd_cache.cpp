@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "dd_cache.hpp"
+#include "gtest/gtest.h"
+#include "test_helpers.hpp"
+
+using namespace murxla;
+using namespace murxla::test;
+
+TEST(dd_cache, key)
+{
+  /* FNV-1a test vectors. */
+  ASSERT_EQ(DDCache::get_key("").d_hash, 0xcbf29ce484222325u);
+  ASSERT_EQ(DDCache::get_key("a").d_hash, 0xaf63dc4c8601ec8cu);
+  ASSERT_EQ(DDCache::get_key("foobar").d_hash, 0x85944171f73967e8u);
+  ASSERT_EQ(DDCache::get_key("foobar").d_size, 6u);
+
+  /* Adding data in pieces yields the same key. */
+  DDCache::Key key;
+  key.add("foo");
+  key.add("");
+  key.add("bar");
+  ASSERT_EQ(key, DDCache::get_key("foobar"));
+
+  /* Keys with the same hash but different sizes are different. */
+  DDCache::Key other = key;
+  other.d_size += 1;
+  ASSERT_FALSE(key == other);
+}
+
+TEST(dd_cache, file_key)
+{
+  std::string file_name = tmp_file("file-key");
+  /* Larger than the read buffer, includes NUL bytes. */
+  std::string contents;
+  for (size_t i = 0; i < 10000; ++i)
+  {
+    contents.push_back(static_cast<char>(i % 256));
+  }
+  write_file(file_name, contents);
+  ASSERT_EQ(DDCache::get_file_key(file_name), DDCache::get_key(contents));
+}
+
+TEST(dd_cache, find_add)
+{
+  DDCache cache;
+  cache.init(DDCache::get_key("golden"), "");
+  DDCache::Key key = DDCache::get_key("trace");
+  ASSERT_EQ(cache.find(key), nullptr);
+  cache.add(key, {RESULT_ERROR, true});
+  ASSERT_NE(cache.find(key), nullptr);
+  ASSERT_EQ(cache.find(key)->d_exit, RESULT_ERROR);
+  ASSERT_TRUE(cache.find(key)->d_match);
+  ASSERT_EQ(cache.find(DDCache::get_key("other")), nullptr);
+  ASSERT_EQ(cache.size(), 1u);
+
+  /* Re-initializing clears the cache. */
+  cache.init(DDCache::get_key("golden"), "");
+  ASSERT_EQ(cache.size(), 0u);
+}
+
+TEST(dd_cache, persist)
+{
+  std::string file_name = tmp_file("persist");
+  std::remove(file_name.c_str());
+
+  DDCache::Key fp1  = DDCache::get_key("golden 1");
+  DDCache::Key fp2  = DDCache::get_key("golden 2");
+  DDCache::Key key1 = DDCache::get_key("trace 1");
+  DDCache::Key key2 = DDCache::get_key("trace 2");
+  {
+    DDCache cache;
+    cache.init(fp1, file_name);
+    cache.add(key1, {RESULT_OK, false});
+    cache.add(key2, {RESULT_ERROR, true});
+    cache.init(fp2, file_name);
+    cache.add(key1, {RESULT_ERROR, true});
+  }
+  {
+    /* Old and malformed entries are skipped. */
+    std::ofstream out(file_name, std::ios::app);
+    out << std::hex << fp1.d_hash << " " << key1.d_hash << " 0 1" << std::endl;
+    out << "garbage" << std::endl;
+    out << std::hex << fp1.d_hash << std::dec << " " << fp1.d_size << " "
+        << std::hex << key1.d_hash << std::dec << " " << key1.d_size
+        << " 42 1" << std::endl;
+  }
+
+  DDCache cache;
+  cache.init(fp1, file_name);
+  ASSERT_EQ(cache.size(), 2u);
+  ASSERT_EQ(cache.find(key1)->d_exit, RESULT_OK);
+  ASSERT_FALSE(cache.find(key1)->d_match);
+  ASSERT_EQ(cache.find(key2)->d_exit, RESULT_ERROR);
+  ASSERT_TRUE(cache.find(key2)->d_match);
+
+  cache.init(fp2, file_name);
+  ASSERT_EQ(cache.size(), 1u);
+  ASSERT_EQ(cache.find(key1)->d_exit, RESULT_ERROR);
+  ASSERT_EQ(cache.find(key2), nullptr);
+
+  /* Same hash, different size. */
+  DDCache::Key fp3 = fp1;
+  fp3.d_size += 1;
+  cache.init(fp3, file_name);
+  ASSERT_EQ(cache.size(), 0u);
+}
@@ -0,0 +1,135 @@
+#include <string>
+
+#include "error_index.hpp"
+#include "gtest/gtest.h"
+
+using namespace murxla;
+
+namespace {
+
+/** @return  An AddressSanitizer report for given address and process id. */
+std::string
+asan_report(const std::string& address, const std::string& pid)
+{
+  return "==" + pid
+         + "==ERROR: AddressSanitizer: heap-use-after-free on address "
+         + address + " at pc 0x55d4c2 bp 0x7ffd sp 0x7ffe\n"
+         + "READ of size 8 at " + address + " thread T0\n"
+         + "    #0 0x55d4c2 in Node::get_child(size_t) node.cpp:42\n"
+         + "    #1 0x55d4c3 in Rewriter::rewrite(Node) rewriter.cpp:128\n"
+         + "    #2 0x55d4c4 in Solver::check_sat() solver.cpp:314\n"
+         + "    #3 0x55d4c5 in main main.cpp:7\n";
+}
+
+}  // namespace
+
+TEST(error_index, fingerprint)
+{
+  ASSERT_EQ(ErrorIndex::fingerprint(
+                "murxla: src/node.cpp:42: void f(): Assertion `x' failed."),
+            "src/node.cpp:42");
+  ASSERT_EQ(ErrorIndex::fingerprint(
+                "src/bv.cpp:17:9: runtime error: signed integer overflow"),
+            "src/bv.cpp:17");
+  /* Only the top-most stack frames are included. */
+  ASSERT_EQ(ErrorIndex::fingerprint(asan_report("0x6020000000f0", "4711")),
+            "heap-use-after-free Node::get_child(size_t) "
+            "Rewriter::rewrite(Node) Solver::check_sat()");
+  ASSERT_EQ(ErrorIndex::fingerprint("unexpected exception"), "");
+}
+
+TEST(error_index, empty)
+{
+  ErrorIndex index;
+  ASSERT_EQ(index.find("unexpected exception"), nullptr);
+  ASSERT_EQ(index.find(""), nullptr);
+}
+
+TEST(error_index, canonical)
+{
+  ErrorIndex index;
+  index.add("invalid term id 42 in call to mk_term with 3 arguments");
+
+  /* Messages that only differ in numbers are duplicates. */
+  const std::string* dup =
+      index.find("invalid term id 1337 in call to mk_term with 2 arguments");
+  ASSERT_NE(dup, nullptr);
+  ASSERT_EQ(*dup, "invalid term id 42 in call to mk_term with 3 arguments");
+  ASSERT_NE(
+      index.find("invalid term id 42 in call to mk_term with 3 arguments"),
+      nullptr);
+
+  /* Different words are not ignored. */
+  ASSERT_EQ(index.find("invalid sort id 42 in call to mk_sort with 3 kinds"),
+            nullptr);
+}
+
+TEST(error_index, fingerprint_match)
+{
+  ErrorIndex index;
+  std::string err = asan_report("0x6020000000f0", "4711");
+  index.add(err);
+
+  /* Same location, different process id and addresses. */
+  const std::string* dup = index.find(asan_report("0x6030000001a8", "815"));
+  ASSERT_NE(dup, nullptr);
+  ASSERT_EQ(*dup, err);
+
+  /* Same location, but the messages differ in more than MAX_DIFF. */
+  index.add("murxla: src/node.cpp:42: void f(): Assertion `x' failed.");
+  ASSERT_EQ(index.find("murxla: src/node.cpp:42: Node g(Node, Kind): "
+                       "Assertion `kind != UNDEFINED' failed."),
+            nullptr);
+}
+
+TEST(error_index, near_duplicate)
+{
+  std::string err =
+      "Fatal failure within void Solver::check_model() at solver.cpp: the "
+      "model computed by the solver for the current set of assertions does "
+      "not satisfy the assertion with the given id, which was asserted at "
+      "the top level before the last call to check-sat with assumptions";
+  std::string near =
+      "Fatal failure within void Solver::check_model() at solver.cpp: the "
+      "model computed by the solver for the current set of assertions does "
+      "not satisfy the assertion with the given id, which was asserted at "
+      "the first level before the last call to check-sat with assumptions";
+
+  ErrorIndex index;
+  index.add(err);
+
+  /* A single different word within a long message is within MAX_DIFF, even
+   * though the canonical forms and fingerprints (none) do not match. */
+  ASSERT_EQ(ErrorIndex::fingerprint(near), "");
+  const std::string* dup = index.find(near);
+  ASSERT_NE(dup, nullptr);
+  ASSERT_EQ(*dup, err);
+}
+
+TEST(error_index, near_miss)
+{
+  ErrorIndex index;
+  index.add("unsupported sort kind for operator");
+
+  /* One different word in a short message exceeds MAX_DIFF. */
+  ASSERT_EQ(index.find("unsupported term kind for operator"), nullptr);
+  /* Additional words count as difference. */
+  ASSERT_EQ(index.find("unsupported sort kind for operator in theory BV"),
+            nullptr);
+  ASSERT_EQ(index.find("unsupported sort kind"), nullptr);
+}
+
+TEST(error_index, first_added)
+{
+  ErrorIndex index;
+  index.add("check-sat returned unknown in round 1");
+  index.add("check-sat returned unknown in round 2");
+  index.add("check-sat returned unsat in round 1");
+
+  const std::string* dup = index.find("check-sat returned unknown in round 3");
+  ASSERT_NE(dup, nullptr);
+  ASSERT_EQ(*dup, "check-sat returned unknown in round 1");
+  dup = index.find("check-sat returned unsat in round 7");
+  ASSERT_NE(dup, nullptr);
+  ASSERT_EQ(*dup, "check-sat returned unsat in round 1");
+}
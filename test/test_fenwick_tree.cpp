@@ -0,0 +1,157 @@
+#include <cstdint>
+#include <vector>
+
+#include "fenwick_tree.hpp"
+#include "gtest/gtest.h"
+
+using namespace murxla;
+
+namespace {
+
+/** @return  The index found by a linear search over given weights. */
+size_t
+linear_search(const std::vector<uint64_t>& weights, uint64_t value)
+{
+  size_t i = 0;
+  for (; value >= weights[i]; ++i)
+  {
+    value -= weights[i];
+  }
+  return i;
+}
+
+}  // namespace
+
+TEST(fenwick_tree, push_back_prefix_sum)
+{
+  FenwickTree<uint64_t> tree;
+  std::vector<uint64_t> values;
+  ASSERT_TRUE(tree.empty());
+  ASSERT_EQ(tree.sum(), 0u);
+  for (uint64_t i = 0; i < 37; ++i)
+  {
+    values.push_back(i * 7 % 5);
+    tree.push_back(values.back());
+    ASSERT_EQ(tree.size(), values.size());
+    uint64_t sum = 0;
+    for (size_t n = 0; n <= values.size(); ++n)
+    {
+      ASSERT_EQ(tree.prefix_sum(n), sum);
+      if (n < values.size()) sum += values[n];
+    }
+    ASSERT_EQ(tree.sum(), sum);
+  }
+}
+
+TEST(fenwick_tree, add_sub)
+{
+  FenwickTree<uint64_t> tree;
+  std::vector<uint64_t> values(20, 1);
+  for (uint64_t v : values) tree.push_back(v);
+
+  for (size_t i = 0; i < values.size(); i += 3)
+  {
+    tree.add(i, i);
+    values[i] += i;
+  }
+  tree.sub(19, 1);
+  values[19] -= 1;
+  tree.sub(0, 1);
+  values[0] -= 1;
+
+  uint64_t sum = 0;
+  for (size_t n = 0; n <= values.size(); ++n)
+  {
+    ASSERT_EQ(tree.prefix_sum(n), sum);
+    if (n < values.size()) sum += values[n];
+  }
+  /* Values appended after updates must not include earlier updates. */
+  tree.push_back(5);
+  values.push_back(5);
+  ASSERT_EQ(tree.prefix_sum(values.size()) - tree.prefix_sum(20), 5u);
+  ASSERT_EQ(tree.sum(), sum + 5);
+}
+
+TEST(fenwick_tree, pop_back)
+{
+  FenwickTree<uint64_t> tree;
+  for (uint64_t i = 1; i <= 16; ++i) tree.push_back(i);
+  tree.add(3, 10);
+  for (uint64_t i = 16; i > 8; --i) tree.pop_back();
+  ASSERT_EQ(tree.size(), 8u);
+  ASSERT_EQ(tree.sum(), 36u + 10u);
+  /* Re-appending after a pop yields the same sums as a fresh tree. */
+  tree.push_back(100);
+  ASSERT_EQ(tree.sum(), 146u);
+  ASSERT_EQ(tree.prefix_sum(8), 46u);
+  while (!tree.empty()) tree.pop_back();
+  ASSERT_EQ(tree.sum(), 0u);
+  tree.clear();
+  ASSERT_TRUE(tree.empty());
+}
+
+TEST(fenwick_tree, range)
+{
+  ASSERT_EQ(FenwickTree<uint64_t>::range(1), 1u);
+  ASSERT_EQ(FenwickTree<uint64_t>::range(2), 2u);
+  ASSERT_EQ(FenwickTree<uint64_t>::range(3), 1u);
+  ASSERT_EQ(FenwickTree<uint64_t>::range(4), 4u);
+  ASSERT_EQ(FenwickTree<uint64_t>::range(6), 2u);
+  ASSERT_EQ(FenwickTree<uint64_t>::range(8), 8u);
+  ASSERT_EQ(FenwickTree<uint64_t>::range(12), 4u);
+}
+
+TEST(fenwick_tree, search_boundaries)
+{
+  for (size_t n = 1; n <= 33; ++n)
+  {
+    FenwickTree<uint64_t> tree;
+    std::vector<uint64_t> weights;
+    for (size_t i = 0; i < n; ++i)
+    {
+      /* Include zero weights, which must never be found. */
+      weights.push_back(i % 4 == 2 ? 0 : i % 3 + 1);
+      tree.push_back(weights.back());
+    }
+    auto node_weight = [&tree](size_t node) { return tree.node(node); };
+    uint64_t sum     = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (weights[i] == 0) continue;
+      /* First and last value of the bucket of element i. */
+      ASSERT_EQ(FenwickTree<uint64_t>::search(n, sum, node_weight), i);
+      sum += weights[i];
+      ASSERT_EQ(FenwickTree<uint64_t>::search(n, sum - 1, node_weight), i);
+    }
+    ASSERT_EQ(sum, tree.sum());
+  }
+}
+
+TEST(fenwick_tree, search_complement_weights)
+{
+  /* Terms are picked with weight c - refs, where c = sum of all refs + 1,
+   * computed from the nodes of the tree of references (see TermRefs). */
+  FenwickTree<uint64_t> refs;
+  std::vector<uint64_t> values = {0, 3, 1, 0, 7, 2, 2, 0, 5, 1, 0};
+  for (uint64_t v : values) refs.push_back(v);
+  size_t n   = values.size();
+  uint64_t c = refs.sum() + 1;
+
+  std::vector<uint64_t> weights;
+  uint64_t total = 0;
+  for (uint64_t v : values)
+  {
+    weights.push_back(c - v);
+    total += c - v;
+  }
+  ASSERT_EQ(total, c * n - refs.sum());
+
+  auto node_weight = [&refs, c](size_t node) {
+    return c * FenwickTree<uint64_t>::range(node) - refs.node(node);
+  };
+  for (uint64_t value = 0; value < total; ++value)
+  {
+    ASSERT_EQ(FenwickTree<uint64_t>::search(n, value, node_weight),
+              linear_search(weights, value));
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef __MURXLA__TEST_HELPERS_H
+#define __MURXLA__TEST_HELPERS_H
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace murxla {
+namespace test {
+
+/**
+ * Get the name of a temporary file for the current test. The name includes
+ * the name of the test suite to avoid clashes between test executables.
+ * @param name  The suffix of the file name.
+ * @return  The name of the temporary file.
+ */
+inline std::string
+tmp_file(const std::string& name)
+{
+  const ::testing::TestInfo* info =
+      ::testing::UnitTest::GetInstance()->current_test_info();
+  return ::testing::TempDir() + "murxla-test-" + info->test_suite_name() + "-"
+         + name;
+}
+
+/** @return  The contents of given file. */
+inline std::string
+read_file(const std::string& file_name)
+{
+  std::ifstream in(file_name, std::ios::binary);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+/** Write given contents to given file. */
+inline void
+write_file(const std::string& file_name, const std::string& contents)
+{
+  std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+  out << contents;
+}
+
+}  // namespace test
+}  // namespace murxla
+
+#endif
@@ -0,0 +1,207 @@
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "indexed_set.hpp"
+
+using namespace murxla;
+
+namespace {
+
+/** Check that all elements of given set are found at their position. */
+template <class T>
+void
+check_index(const IndexedSet<T>& set)
+{
+  for (size_t i = 0; i < set.size(); ++i)
+  {
+    ASSERT_EQ(set.find(set[i]), set.begin() + i);
+    ASSERT_EQ(set.count(set[i]), 1u);
+  }
+}
+
+/** Check that all entries of given map are found at their position. */
+template <class K, class V>
+void
+check_index(IndexedMap<K, V>& map)
+{
+  for (auto it = map.begin(); it != map.end(); ++it)
+  {
+    ASSERT_EQ(map.find(it->first), it);
+    ASSERT_EQ(&map.at(it->first), &it->second);
+  }
+}
+
+}  // namespace
+
+TEST(indexed_set, insert)
+{
+  IndexedSet<int32_t> set;
+  ASSERT_TRUE(set.empty());
+  for (int32_t i = 0; i < 10; ++i)
+  {
+    auto [it, inserted] = set.insert(i);
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(*it, i);
+  }
+  /* Inserting an existing element does not modify the set. */
+  auto [it, inserted] = set.insert(3);
+  ASSERT_FALSE(inserted);
+  ASSERT_EQ(it, set.begin() + 3);
+  ASSERT_EQ(set.size(), 10u);
+  ASSERT_EQ(std::vector<int32_t>(set.begin(), set.end()),
+            std::vector<int32_t>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  check_index(set);
+}
+
+TEST(indexed_set, erase_swap)
+{
+  /* Removing an element moves the last element into its place. */
+  std::vector<int32_t> elements = {0, 1, 2, 3, 4};
+  IndexedSet<int32_t> set(elements.begin(), elements.end());
+  ASSERT_EQ(set.erase(1), 1u);
+  ASSERT_EQ(set.erase(1), 0u);
+  ASSERT_EQ(std::vector<int32_t>(set.begin(), set.end()),
+            std::vector<int32_t>({0, 4, 2, 3}));
+  ASSERT_EQ(set.find(1), set.end());
+  ASSERT_EQ(set.count(1), 0u);
+  check_index(set);
+
+  /* Removing the last element does not move any element. */
+  auto it = set.erase(set.begin() + 3);
+  ASSERT_EQ(it, set.end());
+  ASSERT_EQ(std::vector<int32_t>(set.begin(), set.end()),
+            std::vector<int32_t>({0, 4, 2}));
+  check_index(set);
+
+  /* Removed elements can be inserted again. */
+  ASSERT_TRUE(set.insert(1).second);
+  ASSERT_EQ(set[3], 1);
+  check_index(set);
+}
+
+TEST(indexed_set, erase_iterate)
+{
+  /* Remove all even elements while iterating, the element that is moved into
+   * the place of a removed element is visited next. */
+  std::vector<int32_t> elements;
+  for (int32_t i = 0; i < 100; ++i) elements.push_back(i);
+  IndexedSet<int32_t> set(elements.begin(), elements.end());
+  size_t visited = 0;
+  for (auto it = set.begin(); it != set.end(); ++visited)
+  {
+    if (*it % 2 == 0)
+    {
+      it = set.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  ASSERT_EQ(visited, elements.size());
+  ASSERT_EQ(set.size(), 50u);
+  for (int32_t i = 0; i < 100; ++i)
+  {
+    ASSERT_EQ(set.count(i), static_cast<size_t>(i % 2));
+  }
+  check_index(set);
+
+  /* Remove all elements from the front. */
+  for (auto it = set.begin(); it != set.end();) it = set.erase(it);
+  ASSERT_TRUE(set.empty());
+}
+
+TEST(indexed_set, strings)
+{
+  IndexedSet<std::string> set;
+  set.insert("a");
+  set.insert("b");
+  set.insert("c");
+  ASSERT_EQ(set.erase("a"), 1u);
+  ASSERT_EQ(set[0], "c");
+  ASSERT_EQ(*set.find("c"), "c");
+  ASSERT_EQ(*set.find("b"), "b");
+  check_index(set);
+  set.clear();
+  ASSERT_TRUE(set.empty());
+  ASSERT_EQ(set.find("c"), set.end());
+}
+
+TEST(indexed_map, emplace)
+{
+  IndexedMap<std::string, int32_t> map;
+  auto [it, inserted] = map.emplace("a", 1);
+  ASSERT_TRUE(inserted);
+  ASSERT_EQ(it->first, "a");
+  ASSERT_EQ(it->second, 1);
+
+  /* Emplacing an existing key does not modify its value. */
+  std::tie(it, inserted) = map.emplace("a", 2);
+  ASSERT_FALSE(inserted);
+  ASSERT_EQ(it, map.begin());
+  ASSERT_EQ(it->second, 1);
+  ASSERT_EQ(map.size(), 1u);
+
+  /* operator[] inserts a default constructed value for missing keys. */
+  ASSERT_EQ(map["b"], 0);
+  map["b"] = 3;
+  ASSERT_EQ(map.at("b"), 3);
+  ASSERT_EQ(map.size(), 2u);
+  ASSERT_THROW(map.at("c"), std::out_of_range);
+  ASSERT_EQ(map.count("c"), 0u);
+  check_index(map);
+}
+
+TEST(indexed_map, erase_swap)
+{
+  IndexedMap<int32_t, std::string> map;
+  for (int32_t i = 0; i < 5; ++i) map.emplace(i, std::to_string(i));
+  ASSERT_EQ(map.erase(0), 1u);
+  ASSERT_EQ(map.erase(0), 0u);
+
+  /* The last entry was moved to the front and is found via its key. */
+  ASSERT_EQ(map.begin()->first, 4);
+  ASSERT_EQ(map.begin()->second, "4");
+  ASSERT_EQ(map.find(4), map.begin());
+  ASSERT_EQ(map.at(4), "4");
+  ASSERT_EQ(map.find(0), map.end());
+  ASSERT_THROW(map.at(0), std::out_of_range);
+  check_index(map);
+
+  /* Lookups of all other keys are unaffected. */
+  for (int32_t i = 1; i < 5; ++i)
+  {
+    ASSERT_EQ(map.at(i), std::to_string(i));
+  }
+}
+
+TEST(indexed_map, erase_iterate)
+{
+  IndexedMap<int32_t, int32_t> map;
+  for (int32_t i = 0; i < 100; ++i) map.emplace(i, i * i);
+  for (auto it = map.begin(); it != map.end();)
+  {
+    if (it->first % 3 == 0)
+    {
+      it = map.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  ASSERT_EQ(map.size(), 66u);
+  for (int32_t i = 0; i < 100; ++i)
+  {
+    ASSERT_EQ(map.count(i), i % 3 == 0 ? 0u : 1u);
+    if (i % 3)
+    {
+      ASSERT_EQ(map.at(i), i * i);
+    }
+  }
+  check_index(map);
+}
@@ -0,0 +1,42 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "interned_kind.hpp"
+
+using namespace murxla;
+
+namespace {
+
+struct TestTag
+{
+};
+using Kind = InternedKind<TestTag>;
+
+}  // namespace
+
+TEST(interned_kind, intern)
+{
+  Kind a("a");
+  Kind b(std::string("b"));
+  ASSERT_NE(a, b);
+  ASSERT_EQ(Kind("a"), a);
+  ASSERT_EQ(Kind("a").get_id(), a.get_id());
+  ASSERT_EQ(a.str(), "a");
+  ASSERT_EQ(b, "b");
+}
+
+TEST(interned_kind, find)
+{
+  Kind c("c");
+  size_t n = Kind::get_num_kinds();
+  ASSERT_EQ(Kind::find("c"), c.get_id());
+
+  /* Looking up unknown strings does not intern them. */
+  ASSERT_FALSE(Kind::find("unknown"));
+  ASSERT_FALSE(Kind::find("unknown"));
+  ASSERT_EQ(Kind::get_num_kinds(), n);
+
+  Kind unknown("unknown");
+  ASSERT_EQ(Kind::get_num_kinds(), n + 1);
+  ASSERT_EQ(Kind::find("unknown"), unknown.get_id());
+}
@@ -0,0 +1,99 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <ostream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "test_helpers.hpp"
+#include "trace_buffer.hpp"
+
+using namespace murxla;
+using namespace murxla::test;
+
+namespace {
+
+/**
+ * Write given data into a trace buffer in a child process.
+ * @param file_name  The name of the trace file.
+ * @param flushed    The data to write and flush.
+ * @param unflushed  The data to write after the last flush.
+ * @param close      True if the child closes the trace buffer before it
+ *                   exits.
+ */
+void
+write_child(const std::string& file_name,
+            const std::string& flushed,
+            const std::string& unflushed,
+            bool close)
+{
+  TraceBuffer buffer(file_name);
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0)
+  {
+    std::ostream out(&buffer);
+    out << flushed << std::flush << unflushed;
+    if (close) buffer.close();
+    _exit(0);
+  }
+  waitpid(pid, nullptr, 0);
+  buffer.close();
+  TraceBuffer::truncate(file_name);
+}
+
+}  // namespace
+
+TEST(trace_buffer, close)
+{
+  std::string file_name = tmp_file("close");
+  write_child(file_name, "1 new\n", "2 delete\n", true);
+  ASSERT_EQ(read_file(file_name), "1 new\n2 delete\n");
+  std::remove(file_name.c_str());
+}
+
+TEST(trace_buffer, no_close)
+{
+  /* Only the flushed part of the trace is kept. */
+  std::string file_name = tmp_file("no_close");
+  write_child(file_name, "1 new\n", "2 delete\n", false);
+  ASSERT_EQ(read_file(file_name), "1 new\n");
+  std::remove(file_name.c_str());
+}
+
+TEST(trace_buffer, empty)
+{
+  std::string file_name = tmp_file("empty");
+  write_child(file_name, "", "", true);
+  ASSERT_EQ(read_file(file_name), "");
+  std::remove(file_name.c_str());
+}
+
+TEST(trace_buffer, zero_bytes)
+{
+  /* Trailing zero bytes are part of the trace. */
+  std::string file_name = tmp_file("zero_bytes");
+  std::string data("\x01\x00\x02\x00\x00", 5);
+  write_child(file_name, data, "", false);
+  ASSERT_EQ(read_file(file_name), data);
+  std::remove(file_name.c_str());
+}
+
+TEST(trace_buffer, chunks)
+{
+  /* Traces that span several chunks, including a trace that exactly fills
+   * the first chunk. */
+  for (size_t size : {(1u << 20) - 8, (1u << 20) - 7, (3u << 20) + 5})
+  {
+    std::string file_name = tmp_file("chunks");
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; ++i)
+    {
+      data[i] = static_cast<char>(i % 7);
+    }
+    write_child(file_name, data, "x", false);
+    ASSERT_EQ(read_file(file_name), data);
+    std::remove(file_name.c_str());
+  }
+}
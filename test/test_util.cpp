@@ -1,4 +1,8 @@
 #include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "util.hpp"
 
@@ -301,3 +305,40 @@ TEST(util, is_bv_special_value_max_signed_str)
     for (uint32_t j = 1; i > 0 && j < n; ++j) ASSERT_EQ(s[j], '1');
   }
 }
+
+TEST(util, tokenize)
+{
+  auto [seed, action, tokens] =
+      tokenize("123 mk-term OP_AND SORT_BOOL 2 t1 t2");
+  ASSERT_EQ(seed, 123u);
+  ASSERT_EQ(action, "mk-term");
+  ASSERT_EQ(tokens,
+            std::vector<std::string>({"OP_AND", "SORT_BOOL", "2", "t1", "t2"}));
+
+  std::tie(seed, action, tokens) = tokenize("return t3 s1");
+  ASSERT_EQ(seed, 0u);
+  ASSERT_EQ(action, "return");
+  ASSERT_EQ(tokens, std::vector<std::string>({"t3", "s1"}));
+
+  /* Consecutive spaces do not yield empty tokens. */
+  std::tie(seed, action, tokens) = tokenize("1  mk-const  s2 \"x\"");
+  ASSERT_EQ(seed, 1u);
+  ASSERT_EQ(action, "mk-const");
+  ASSERT_EQ(tokens, std::vector<std::string>({"s2", "\"x\""}));
+}
+
+TEST(util, tokenize_strings)
+{
+  auto [seed, action, tokens] =
+      tokenize("7 mk-value s1 \"a b  c\" \"d\" \"e f\" t1");
+  ASSERT_EQ(seed, 7u);
+  ASSERT_EQ(action, "mk-value");
+  /* Strings with spaces are joined, each string is joined separately. */
+  ASSERT_EQ(tokens,
+            std::vector<std::string>(
+                {"s1", "\"a b c\"", "\"d\"", "\"e f\"", "t1"}));
+
+  /* Unterminated strings are dropped. */
+  std::tie(seed, action, tokens) = tokenize("7 mk-value s1 \"a b");
+  ASSERT_EQ(tokens, std::vector<std::string>({"s1"}));
+}